@@ -0,0 +1,298 @@
+/* File: TagStoreBench.c
+ *
+ * Microbenchmark comparing set lookups per second for the old pointer
+ * graph tag store (ways -> block pointer arrays -> malloc'd blocks, LRU
+ * by timestamp) and the flat, set-major tag store used by CacheSim: a
+ * valid/dirty header, the tags, and the bit-packed LRU rank bytes of
+ * Policy.h, in one record per set.
+ *
+ * Usage: ./TagStoreBench [associativity] [lookups]
+ *
+ * Both layouts run an LRU lookup/fill loop over the same random address
+ * stream for 1K to 1M sets, and must report the same hit count.
+ *
+ * gcc -O2 -o TagStoreBench bench/TagStoreBench.c src/Policy.c
+ *
+ */
+
+/********************************
+ *     1. Includes              *
+ *******************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../src/Policy.h"
+#include "../src/TagMatch.h"
+
+/********************************
+ *     2. Structs & Globals     *
+ ********************************/
+
+#define BLOCK_BITS 5
+
+/* Pointer graph layout (before) */
+
+struct Block_ {
+    int valid;
+    unsigned int tag;
+    int dirty;
+    int timestamp;
+};
+
+struct Way_ {
+    int waynum;
+    struct Block_** blocks;
+};
+
+/* Flat layout (after): header, then tags, then policy metadata */
+
+struct Set_ {
+    unsigned int valid;
+    unsigned int dirty;
+};
+
+/********************************
+ *     3. Utility Functions     *
+ ********************************/
+
+/* nowSeconds
+ *
+ * Monotonic wall clock in seconds.
+ */
+
+static double nowSeconds(void) {
+
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* makeAddresses
+ *
+ * Fills 'addrs' with a random stream that mostly re-touches a working
+ * set about twice the size of the cache, so both hits and misses occur.
+ */
+
+static void makeAddresses(unsigned int *addrs, long n, int sets, int ways) {
+
+    long i;
+    unsigned int span = (unsigned int) sets * ways * 2u << BLOCK_BITS;
+    unsigned int x = 2463534242u;
+
+    for(i = 0; i < n; i++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        addrs[i] = x % span;
+    }
+}
+
+/********************************
+ *     4. Benchmarks            *
+ ********************************/
+
+/* benchGraph
+ *
+ * Runs the lookup loop against the pointer graph layout.
+ */
+
+static long benchGraph(const unsigned int *addrs, long n, int sets, int ways, int bitsIndex, double *seconds) {
+
+    struct Way_** w;
+    struct Block_* block;
+    long i, hits = 0;
+    int j, k, LRU, LRU_access_num;
+    unsigned int index, tag;
+    double start;
+
+    w = malloc(sizeof(*w) * ways);
+
+    for(j = 0; j < ways; j++) {
+        w[j] = malloc(sizeof(struct Way_));
+        w[j]->waynum = j;
+        w[j]->blocks = malloc(sizeof(struct Block_*) * sets);
+
+        for(k = 0; k < sets; k++) {
+            w[j]->blocks[k] = calloc(1, sizeof(struct Block_));
+        }
+    }
+
+    start = nowSeconds();
+
+    for(i = 0; i < n; i++) {
+        index = (addrs[i] >> BLOCK_BITS) & (sets - 1);
+        tag = addrs[i] >> (BLOCK_BITS + bitsIndex);
+        LRU = -1;
+
+        for(j = 0; j < ways; j++) {
+            block = w[j]->blocks[index];
+
+            if(block->valid && block->tag == tag) {
+                block->timestamp = (int) i + 1;
+                LRU = j;
+                hits++;
+                break;
+            }
+        }
+
+        if(LRU < 0) {
+            LRU = 0;
+            LRU_access_num = (int) i + 1;
+
+            for(j = 0; j < ways; j++) {
+                if(w[j]->blocks[index]->timestamp < LRU_access_num) {
+                    LRU_access_num = w[j]->blocks[index]->timestamp;
+                    LRU = j;
+                }
+            }
+
+            block = w[LRU]->blocks[index];
+            block->valid = 1;
+            block->tag = tag;
+            block->timestamp = (int) i + 1;
+        }
+    }
+
+    *seconds = nowSeconds() - start;
+
+    for(j = 0; j < ways; j++) {
+        for(k = 0; k < sets; k++) {
+            free(w[j]->blocks[k]);
+        }
+        free(w[j]->blocks);
+        free(w[j]);
+    }
+    free(w);
+
+    return hits;
+}
+
+/* benchFlat
+ *
+ * Runs the lookup loop against the flat set-major layout, with the
+ * record sized and the metadata updated as CacheSim's LRU kernels do.
+ */
+
+static long benchFlat(const unsigned int *addrs, long n, int sets, int ways, int bitsIndex, double *seconds) {
+
+    unsigned char *store;
+    unsigned char *meta;
+    struct Set_ *set;
+    unsigned int *tags;
+    PolicyState state;
+    size_t stride, line, bytes;
+    long i, hits = 0;
+    unsigned int index, tag, match, empty;
+    int k, way;
+    double start;
+
+    stride = sizeof(struct Set_) + ways * sizeof(unsigned int) + policyMetaBytes(POLICY_LRU, ways);
+
+    if(stride <= 64) {
+        for(line = 8; line < stride; line *= 2);
+        stride = line;
+    }
+    else {
+        stride = (stride + 63) & ~((size_t) 63);
+    }
+
+    bytes = (stride * sets + 63) & ~((size_t) 63);
+    store = aligned_alloc(64, bytes);
+    memset(store, 0, bytes);
+
+    initPolicyState(&state, POLICY_LRU, sets, 1);
+
+    for(k = 0; k < sets; k++) {
+        initPolicySet(POLICY_LRU, store + (size_t) k * stride + sizeof(struct Set_) + ways * sizeof(unsigned int), ways);
+    }
+
+    start = nowSeconds();
+
+    for(i = 0; i < n; i++) {
+        index = (addrs[i] >> BLOCK_BITS) & (sets - 1);
+        tag = addrs[i] >> (BLOCK_BITS + bitsIndex);
+        set = (struct Set_ *) (store + (size_t) index * stride);
+        tags = (unsigned int *) (set + 1);
+        meta = (unsigned char *) (tags + ways);
+
+        match = matchTagsInline(tags, ways, tag) & set->valid;
+
+        if(match != 0) {
+            policyHit(POLICY_LRU, meta, ways, __builtin_ctz(match));
+            hits++;
+            continue;
+        }
+
+        /* invalid ways first, as chooseWay does */
+
+        empty = ~set->valid & ((ways == 32) ? ~0u : (1u << ways) - 1);
+        way = (empty != 0) ? __builtin_ctz(empty) : policyVictim(POLICY_LRU, meta, ways, &state);
+
+        set->valid |= 1u << way;
+        tags[way] = tag;
+        policyFill(POLICY_LRU, meta, ways, way, &state, index);
+    }
+
+    *seconds = nowSeconds() - start;
+
+    free(store);
+
+    return hits;
+}
+
+/********************************
+ *        5. Main Function      *
+ ********************************/
+
+int main(int argc, char **argv) {
+
+    int ways = 4;
+    long n = 20000000;
+    int bitsIndex, sets;
+    unsigned int *addrs;
+    long graphHits, flatHits;
+    double graphTime, flatTime;
+
+    if(argc > 1) ways = atoi(argv[1]);
+    if(argc > 2) n = atol(argv[2]);
+
+    if(ways < 1 || ways > 32 || n <= 0) {
+        fprintf(stderr, "Usage: ./TagStoreBench [associativity 1-32] [lookups]\n\n");
+        return -1;
+    }
+
+    addrs = malloc(sizeof(unsigned int) * n);
+
+    if(addrs == NULL) {
+        fprintf(stderr, "ERROR: Could not allocate address stream.\n");
+        return -1;
+    }
+
+    printf("\n%d-way, %ld lookups per point\n\n", ways, n);
+    printf("\t%10s %16s %16s %8s\n", "sets", "graph lookups/s", "flat lookups/s", "speedup");
+
+    for(bitsIndex = 10; bitsIndex <= 20; bitsIndex += 2) {
+
+        sets = 1 << bitsIndex;
+        makeAddresses(addrs, n, sets, ways);
+
+        graphHits = benchGraph(addrs, n, sets, ways, bitsIndex, &graphTime);
+        flatHits = benchFlat(addrs, n, sets, ways, bitsIndex, &flatTime);
+
+        if(graphHits != flatHits) {
+            fprintf(stderr, "ERROR: layouts disagree at %d sets (%ld vs %ld hits).\n", sets, graphHits, flatHits);
+            free(addrs);
+            return -1;
+        }
+
+        printf("\t%10d %16.0f %16.0f %7.2fx\n", sets, n / graphTime, n / flatTime, graphTime / flatTime);
+    }
+
+    printf("\n");
+    free(addrs);
+
+    return 0;
+}
@@ -0,0 +1,508 @@
+/* File: BinTrace.c
+ *
+ * Compact binary trace format. See BinTrace.h for the layout.
+ *
+ * The reader keeps a cursor into the mapped file and the state of the
+ * current chunk (accesses left, end of its payload, previous address).
+ * The writer encodes one chunk at a time into memory and writes it out
+ * when it fills up.
+ *
+ */
+
+/********************************
+ *     1. Includes              *
+ *******************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "BinTrace.h"
+#include "TextTrace.h"
+
+/********************************
+ *     2. Structs               *
+ ********************************/
+
+/* BinaryTrace
+ *
+ * @param   data            start of the mapped file
+ * @param   size            size of the file in bytes
+ * @param   cursor          next byte to decode
+ * @param   chunk_end       end of the current chunk's payload
+ * @param   chunk_left      accesses left in the current chunk
+ * @param   previous        last decoded address in the current chunk
+ * @param   mask            address mask (version 1 addresses wrap at 32 bits)
+ * @param   length          total # of accesses from the header
+ */
+
+struct BinaryTrace_ {
+    const unsigned char* data;
+    size_t size;
+    const unsigned char* cursor;
+    const unsigned char* chunk_end;
+    uint32_t chunk_left;
+    uint64_t previous;
+    uint64_t mask;
+    uint64_t length;
+};
+
+/* BinaryTraceWriter
+ *
+ * @param   file            output file
+ * @param   chunk           encoded payload of the current chunk
+ * @param   used            bytes used in 'chunk'
+ * @param   count           accesses in the current chunk
+ * @param   previous        last encoded address in the current chunk
+ * @param   total           accesses written so far
+ * @param   address_size    address width given at creation
+ * @param   seen            OR of every address written
+ * @param   failed          a write has failed
+ */
+
+struct BinaryTraceWriter_ {
+    FILE* file;
+    unsigned char* chunk;
+    size_t used;
+    uint32_t count;
+    uint64_t previous;
+    uint64_t total;
+    int address_size;
+    uint64_t seen;
+    int failed;
+};
+
+/********************************
+ *     3. Utility Functions     *
+ ********************************/
+
+/* putLE / getLE
+ *
+ * Store and load little endian integers of 'bytes' bytes.
+ */
+
+static void putLE(unsigned char *out, uint64_t value, int bytes) {
+
+    int i;
+
+    for(i = 0; i < bytes; i++) {
+        out[i] = (unsigned char) (value >> (8 * i));
+    }
+}
+
+static uint64_t getLE(const unsigned char *in, int bytes) {
+
+    uint64_t value = 0;
+    int i;
+
+    for(i = 0; i < bytes; i++) {
+        value |= (uint64_t) in[i] << (8 * i);
+    }
+
+    return value;
+}
+
+/* flushChunk
+ *
+ * Writes the current chunk (header and payload) and starts a new one.
+ */
+
+static void flushChunk(BinaryTraceWriter writer) {
+
+    unsigned char header[BINTRACE_CHUNK_HEADER_SIZE];
+
+    if(writer->count == 0) {
+        return;
+    }
+
+    putLE(header, writer->count, 4);
+    putLE(header + 4, writer->used, 4);
+
+    if(fwrite(header, 1, sizeof(header), writer->file) != sizeof(header) ||
+       fwrite(writer->chunk, 1, writer->used, writer->file) != writer->used) {
+        writer->failed = 1;
+    }
+
+    writer->used = 0;
+    writer->count = 0;
+    writer->previous = 0;
+}
+
+/* writeHeader
+ *
+ * Writes the file header at the start of the file.
+ */
+
+static void writeHeader(BinaryTraceWriter writer, int address_size) {
+
+    unsigned char header[BINTRACE_HEADER_SIZE];
+
+    memcpy(header, BINTRACE_MAGIC, 4);
+    putLE(header + 4, BINTRACE_VERSION, 2);
+    putLE(header + 6, (uint64_t) address_size, 2);
+    putLE(header + 8, BINTRACE_CHUNK, 4);
+    putLE(header + 12, 0, 4);
+    putLE(header + 16, writer->total, 8);
+
+    if(fseek(writer->file, 0, SEEK_SET) != 0 || fwrite(header, 1, sizeof(header), writer->file) != sizeof(header)) {
+        writer->failed = 1;
+    }
+}
+
+/********************************
+ *     4. Reader                *
+ ********************************/
+
+int isBinaryTrace(const char *path) {
+
+    struct stat info;
+    char magic[4];
+    FILE *file;
+    int binary = 0;
+
+    /* peeking at a pipe would eat the start of the trace */
+
+    if(stat(path, &info) != 0 || !S_ISREG(info.st_mode)) {
+        return 0;
+    }
+
+    file = fopen(path, "rb");
+
+    if(file != NULL) {
+        binary = fread(magic, 1, 4, file) == 4 && memcmp(magic, BINTRACE_MAGIC, 4) == 0;
+        fclose(file);
+    }
+
+    return binary;
+}
+
+BinaryTrace openBinaryTrace(const char *path) {
+
+    BinaryTrace trace;
+    struct stat info;
+    unsigned int version;
+    void *data;
+    int fd;
+
+    fd = open(path, O_RDONLY);
+
+    if(fd < 0 || fstat(fd, &info) != 0) {
+        fprintf(stderr, "ERROR: Could not open file. Check <file location> argument.\n");
+        if(fd >= 0) close(fd);
+        return NULL;
+    }
+
+    if((size_t) info.st_size < BINTRACE_HEADER_SIZE) {
+        fprintf(stderr, "Error: binary trace is too short to hold a header.\n");
+        close(fd);
+        return NULL;
+    }
+
+    data = mmap(NULL, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if(data == MAP_FAILED) {
+        fprintf(stderr, "Error: could not map binary trace into memory.\n");
+        return NULL;
+    }
+
+    /* one front-to-back pass: let the kernel read ahead aggressively */
+
+    madvise(data, (size_t) info.st_size, MADV_SEQUENTIAL);
+
+    trace = (BinaryTrace) malloc(sizeof(struct BinaryTrace_));
+    assert(trace != NULL);
+
+    trace->data = (const unsigned char*) data;
+    trace->size = (size_t) info.st_size;
+
+    version = (unsigned int) getLE(trace->data + 4, 2);
+
+    if(memcmp(trace->data, BINTRACE_MAGIC, 4) != 0 || version < 1 || version > BINTRACE_VERSION) {
+        fprintf(stderr, "Error: unsupported binary trace version %u.\n", (unsigned int) getLE(trace->data + 4, 2));
+        closeBinaryTrace(trace);
+        return NULL;
+    }
+
+    trace->length = getLE(trace->data + 16, 8);
+    trace->cursor = trace->data + BINTRACE_HEADER_SIZE;
+    trace->chunk_end = trace->cursor;
+    trace->chunk_left = 0;
+    trace->previous = 0;
+    trace->mask = (version == 1) ? 0xffffffffull : ~0ull;
+
+    return trace;
+}
+
+int readBinaryTrace(BinaryTrace trace, uint64_t *addresses, unsigned char *writes, int max) {
+
+    const unsigned char *end = trace->data + trace->size;
+    const unsigned char *p = trace->cursor;
+    const unsigned char *chunk_end = trace->chunk_end;
+    uint32_t left = trace->chunk_left;
+    uint64_t previous = trace->previous;
+    uint64_t mask = trace->mask;
+    uint64_t zigzag;
+    int count = 0;
+    int write, shift;
+
+    while(count < max) {
+
+        /* open the next chunk */
+
+        if(left == 0) {
+
+            if(p != chunk_end) {
+                fprintf(stderr, "Error: binary trace chunk ending at byte offset %zu has trailing bytes.\n", (size_t) (chunk_end - trace->data));
+                return -1;
+            }
+
+            if(p == end) {
+                break;
+            }
+
+            if((size_t) (end - p) < BINTRACE_CHUNK_HEADER_SIZE ||
+               getLE(p + 4, 4) > (uint64_t) (end - p - BINTRACE_CHUNK_HEADER_SIZE)) {
+                fprintf(stderr, "Error: binary trace is truncated at byte offset %zu.\n", (size_t) (p - trace->data));
+                return -1;
+            }
+
+            left = (uint32_t) getLE(p, 4);
+            chunk_end = p + BINTRACE_CHUNK_HEADER_SIZE + getLE(p + 4, 4);
+            p += BINTRACE_CHUNK_HEADER_SIZE;
+            previous = 0;
+            continue;
+        }
+
+        /* LEB128 varint of a 65 bit value; the first byte carries the
+           write bit and 6 bits of the zigzag, most deltas fit in one or
+           two bytes */
+
+        if(p == chunk_end) {
+            fprintf(stderr, "Error: binary trace record at byte offset %zu is malformed.\n", (size_t) (p - trace->data));
+            return -1;
+        }
+
+        write = *p & 1;
+        zigzag = (uint64_t) ((*p & 0x7f) >> 1);
+        shift = 6;
+
+        while(*p++ & 0x80) {
+            if(p == chunk_end || shift > 62) {
+                fprintf(stderr, "Error: binary trace record at byte offset %zu is malformed.\n", (size_t) (p - trace->data));
+                return -1;
+            }
+
+            zigzag |= (uint64_t) (*p & 0x7f) << shift;
+            shift += 7;
+        }
+
+        previous = (previous + ((zigzag >> 1) ^ -(zigzag & 1))) & mask;
+
+        addresses[count] = previous;
+        writes[count] = (unsigned char) write;
+        count++;
+        left--;
+    }
+
+    trace->cursor = p;
+    trace->chunk_end = chunk_end;
+    trace->chunk_left = left;
+    trace->previous = previous;
+
+    return count;
+}
+
+uint64_t binaryTraceLength(BinaryTrace trace) {
+    return trace->length;
+}
+
+void closeBinaryTrace(BinaryTrace trace) {
+
+    if(trace != NULL) {
+        munmap((void *) trace->data, trace->size);
+        free(trace);
+    }
+}
+
+/********************************
+ *     5. Writer                *
+ ********************************/
+
+BinaryTraceWriter createBinaryTraceWriter(const char *path, int address_size) {
+
+    BinaryTraceWriter writer;
+
+    writer = (BinaryTraceWriter) malloc(sizeof(struct BinaryTraceWriter_));
+
+    if(writer == NULL) {
+        fprintf(stderr, "Error: could not allocate memory for trace writer.\n");
+        return NULL;
+    }
+
+    /* worst case is 10 bytes per 64 bit access */
+
+    writer->chunk = (unsigned char*) malloc((size_t) BINTRACE_CHUNK * 10);
+    writer->file = fopen(path, "wb");
+
+    if(writer->chunk == NULL || writer->file == NULL) {
+        fprintf(stderr, "Error: could not create binary trace %s.\n", path);
+        if(writer->file != NULL) fclose(writer->file);
+        free(writer->chunk);
+        free(writer);
+        return NULL;
+    }
+
+    writer->used = 0;
+    writer->count = 0;
+    writer->previous = 0;
+    writer->total = 0;
+    writer->address_size = address_size;
+    writer->seen = 0;
+    writer->failed = 0;
+
+    /* placeholder; the access count is filled in on close */
+    writeHeader(writer, address_size);
+
+    return writer;
+}
+
+int writeBinaryTrace(BinaryTraceWriter writer, uint64_t address, int write) {
+
+    uint64_t delta = address - writer->previous;
+    uint64_t zigzag = (delta << 1) ^ -(delta >> 63);
+    unsigned char first = (unsigned char) ((zigzag & 0x3f) << 1 | (write != 0));
+
+    /* the first byte holds the write bit and 6 bits of the zigzag */
+
+    zigzag >>= 6;
+
+    if(zigzag == 0) {
+        writer->chunk[writer->used++] = first;
+    }
+    else {
+        writer->chunk[writer->used++] = first | 0x80;
+
+        while(zigzag >= 0x80) {
+            writer->chunk[writer->used++] = (unsigned char) (zigzag | 0x80);
+            zigzag >>= 7;
+        }
+
+        writer->chunk[writer->used++] = (unsigned char) zigzag;
+    }
+
+    writer->previous = address;
+    writer->seen |= address;
+    writer->count++;
+    writer->total++;
+
+    if(writer->count == BINTRACE_CHUNK) {
+        flushChunk(writer);
+    }
+
+    return writer->failed ? -1 : 0;
+}
+
+int closeBinaryTraceWriter(BinaryTraceWriter writer) {
+
+    unsigned char header[BINTRACE_HEADER_SIZE];
+    int result;
+
+    if(writer == NULL) {
+        return -1;
+    }
+
+    flushChunk(writer);
+
+    /* rewrite the count, and the width if an address did not fit */
+
+    putLE(header, writer->total, 8);
+
+    if(fseek(writer->file, 16, SEEK_SET) != 0 || fwrite(header, 1, 8, writer->file) != 8) {
+        writer->failed = 1;
+    }
+
+    if(writer->address_size < 64 && (writer->seen >> writer->address_size) != 0) {
+
+        putLE(header, 64, 2);
+
+        if(fseek(writer->file, 6, SEEK_SET) != 0 || fwrite(header, 1, 2, writer->file) != 2) {
+            writer->failed = 1;
+        }
+    }
+
+    if(fclose(writer->file) != 0) {
+        writer->failed = 1;
+    }
+
+    result = writer->failed ? -1 : 0;
+
+    free(writer->chunk);
+    free(writer);
+
+    return result;
+}
+
+/********************************
+ *     6. Converter             *
+ ********************************/
+
+long convertTrace(const char *text_path, const char *binary_path) {
+
+    BinaryTraceWriter writer;
+    TextTrace text;
+    uint64_t *addresses;
+    unsigned char *writes;
+    long count = 0;
+    int n, k;
+
+    text = openTextTrace(text_path);
+
+    if(text == NULL) {
+        return -1;
+    }
+
+    writer = createBinaryTraceWriter(binary_path, 32);
+
+    if(writer == NULL) {
+        closeTextTrace(text);
+        return -1;
+    }
+
+    addresses = (uint64_t*) malloc(sizeof(uint64_t) * BINTRACE_CHUNK);
+    writes = (unsigned char*) malloc(BINTRACE_CHUNK);
+    assert(addresses != NULL && writes != NULL);
+
+    /* a malformed record is reported by the text reader */
+
+    while((n = readTextTrace(text, addresses, writes, BINTRACE_CHUNK)) > 0) {
+
+        for(k = 0; k < n; k++) {
+            writeBinaryTrace(writer, addresses[k], writes[k]);
+        }
+
+        count += n;
+    }
+
+    free(addresses);
+    free(writes);
+    closeTextTrace(text);
+
+    if(closeBinaryTraceWriter(writer) != 0) {
+        fprintf(stderr, "Error: could not write binary trace %s.\n", binary_path);
+        n = -1;
+    }
+
+    /* do not leave a partial binary trace behind */
+
+    if(n < 0) {
+        remove(binary_path);
+        return -1;
+    }
+
+    return count;
+}
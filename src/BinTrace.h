@@ -0,0 +1,165 @@
+/* File: BinTrace.h
+ *
+ * Compact binary trace format.
+ *
+ * A binary trace starts with a 24-byte header, all fields little endian:
+ *
+ *      bytes  0 -  3   magic "CSBT"
+ *      bytes  4 -  5   format version (2)
+ *      bytes  6 -  7   address width in bits
+ *      bytes  8 - 11   accesses per chunk
+ *      bytes 12 - 15   reserved (0)
+ *      bytes 16 - 23   total # of accesses
+ *
+ * followed by chunks. Each chunk is an 8-byte header (# of accesses,
+ * payload bytes) and a payload of one LEB128 varint per access. The
+ * varint holds the 65 bit value (zigzag(address - previous address) << 1)
+ * | write, with the previous address reset to 0 at the start of every
+ * chunk, so each chunk decodes on its own. Sequential and strided traces
+ * take 1 - 2 bytes per access instead of the ~11 of the text format.
+ *
+ * Version 1 used 32 bit addresses and deltas. Its records decode the
+ * same way once the result is cut to 32 bits, so version 1 traces are
+ * still read.
+ *
+ * Binary traces are read through mmap with MADV_SEQUENTIAL and decoded
+ * in batches, so ingest is bound by memory bandwidth, not parsing.
+ *
+ */
+
+#ifndef BINTRACE_H
+#define BINTRACE_H
+
+#include <stdint.h>
+
+/* Format constants */
+#define BINTRACE_MAGIC "CSBT"
+#define BINTRACE_VERSION 2
+#define BINTRACE_HEADER_SIZE 24
+#define BINTRACE_CHUNK_HEADER_SIZE 8
+#define BINTRACE_CHUNK 65536
+
+/* Typedefs */
+typedef struct BinaryTrace_* BinaryTrace;
+typedef struct BinaryTraceWriter_* BinaryTraceWriter;
+
+/* isBinaryTrace
+ *
+ * Checks whether a file starts with the binary trace magic. Only a
+ * regular file is checked, so a pipe loses none of its data; anything
+ * else is never binary.
+ *
+ * @param   path            trace file location
+ *
+ * @return  binary          1
+ * @return  text/unreadable 0
+ */
+
+int isBinaryTrace(const char *path);
+
+/* openBinaryTrace
+ *
+ * Maps a binary trace into memory and validates its header. Returns
+ * NULL on failure.
+ *
+ * @param   path            trace file location
+ *
+ * @return  success         new BinaryTrace
+ * @return  failure         NULL
+ */
+
+BinaryTrace openBinaryTrace(const char *path);
+
+/* readBinaryTrace
+ *
+ * Decodes up to 'max' accesses into the caller's arrays.
+ *
+ * @param   trace           trace opened with openBinaryTrace
+ * @param   addresses       output: decoded addresses
+ * @param   writes          output: 0 = read, 1 = write
+ * @param   max             capacity of both arrays
+ *
+ * @return  success         # of accesses decoded (0 at the end)
+ * @return  failure         -1 if the trace is corrupt
+ */
+
+int readBinaryTrace(BinaryTrace trace, uint64_t *addresses, unsigned char *writes, int max);
+
+/* binaryTraceLength
+ *
+ * Returns the total # of accesses recorded in the header.
+ *
+ * @param   trace           trace opened with openBinaryTrace
+ *
+ * @return  # of accesses
+ */
+
+uint64_t binaryTraceLength(BinaryTrace trace);
+
+/* closeBinaryTrace
+ *
+ * Unmaps the trace and frees it. Passing NULL does nothing.
+ *
+ * @param   trace           trace to close
+ *
+ * @return  void
+ */
+
+void closeBinaryTrace(BinaryTrace trace);
+
+/* createBinaryTraceWriter
+ *
+ * Creates (or truncates) a binary trace file. Returns NULL on failure.
+ *
+ * @param   path            output file location
+ * @param   address_size    width of the addresses in bits; raised to 64
+ *                          on close if a wider address was written
+ *
+ * @return  success         new BinaryTraceWriter
+ * @return  failure         NULL
+ */
+
+BinaryTraceWriter createBinaryTraceWriter(const char *path, int address_size);
+
+/* writeBinaryTrace
+ *
+ * Appends one access to the trace.
+ *
+ * @param   writer          target writer
+ * @param   address         decoded memory address
+ * @param   write           0 = read, 1 = write
+ *
+ * @return  success         0
+ * @return  failure         -1
+ */
+
+int writeBinaryTrace(BinaryTraceWriter writer, uint64_t address, int write);
+
+/* closeBinaryTraceWriter
+ *
+ * Flushes the last chunk, fills in the access count, and closes the
+ * file. The writer is freed even on failure.
+ *
+ * @param   writer          writer to close
+ *
+ * @return  success         0
+ * @return  failure         -1
+ */
+
+int closeBinaryTraceWriter(BinaryTraceWriter writer);
+
+/* convertTrace
+ *
+ * Converts a text trace into a binary trace.
+ *
+ * @param   text_path       text trace to read
+ * @param   binary_path     binary trace to write
+ *
+ * @return  success         # of accesses converted
+ * @return  failure         -1
+ */
+
+long convertTrace(const char *text_path, const char *binary_path);
+
+#endif
+/* BINTRACE_H */
@@ -0,0 +1,149 @@
+/* File: CacheLib.c
+ *
+ * Embeddable C interface to the simulator. See CacheLib.h.
+ *
+ * A cache_t wraps one Cache. The batch call goes straight to
+ * accessCacheBatch, which looks the access kernel up once per batch.
+ *
+ */
+
+/********************************
+ *     1. Includes              *
+ *******************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <assert.h>
+#include "CacheLib.h"
+#include "CacheSim.h"
+#include "TagMatch.h"
+#include "Policy.h"
+
+/********************************
+ *     2. Structs               *
+ ********************************/
+
+/* cache_t
+ *
+ * @param   cache           the simulated cache
+ */
+
+struct cache_ {
+    Cache cache;
+};
+
+/********************************
+ *     3. Interface             *
+ ********************************/
+
+CACHESIM_API int cache_abi_version(void) {
+    return CACHE_ABI_VERSION;
+}
+
+CACHESIM_API void cache_config_init(cache_config *config) {
+
+    memset(config, 0, sizeof(cache_config));
+
+    config->size = sizeof(cache_config);
+    config->sets = DEFAULT_NUMBER_OF_SETS;
+    config->ways = DEFAULT_ASSOCIATIVITY;
+    config->block_size = DEFAULT_BLOCK_SIZE;
+    config->address_size = DEFAULT_ADDRESS_SIZE;
+    config->seed = 1;
+    config->policy = NULL;
+}
+
+CACHESIM_API cache_t *cache_create(const cache_config *config) {
+
+    cache_config defaults;
+    cache_t *handle;
+    Cache cache;
+    int policy = POLICY_LRU;
+
+    cache_config_init(&defaults);
+
+    /* an older, shorter config keeps the defaults for the newer fields */
+
+    if(config != NULL) {
+
+        if(config->size < sizeof(uint32_t) || config->size > sizeof(cache_config)) {
+            fprintf(stderr, "Error: cache_config has an unknown size %u.\n", config->size);
+            return NULL;
+        }
+
+        memcpy(&defaults, config, config->size);
+    }
+
+    if(defaults.sets > INT_MAX || defaults.ways > INT_MAX || defaults.block_size > INT_MAX || defaults.address_size > INT_MAX) {
+        fprintf(stderr, "Error: cache_config field is out of range.\n");
+        return NULL;
+    }
+
+    if(defaults.policy != NULL && (policy = parsePolicy(defaults.policy)) < 0) {
+        fprintf(stderr, "Error: unknown replacement policy %s.\n", defaults.policy);
+        return NULL;
+    }
+
+    initTagMatch();
+
+    cache = createCache((int) defaults.sets, (int) defaults.ways, (int) defaults.block_size, (int) defaults.address_size, policy, defaults.seed);
+
+    if(cache == NULL) {
+        return NULL;
+    }
+
+    handle = (cache_t*) malloc(sizeof(struct cache_));
+    assert(handle != NULL);
+
+    handle->cache = cache;
+
+    return handle;
+}
+
+CACHESIM_API void cache_destroy(cache_t *cache) {
+
+    if(cache != NULL) {
+        destroyCache(cache->cache);
+        free(cache);
+    }
+}
+
+CACHESIM_API uint64_t cache_access_batch(cache_t *cache, const uint64_t *addrs, const uint8_t *ops, size_t n) {
+    return (uint64_t) accessCacheBatch(cache->cache, addrs, ops, n);
+}
+
+CACHESIM_API int cache_get_stats(const cache_t *cache, cache_stats *stats) {
+
+    CacheCounters counters;
+    cache_stats full;
+    uint32_t size = stats->size;
+
+    if(size < sizeof(uint32_t)) {
+        return -1;
+    }
+
+    getCacheCounters(cache->cache, &counters);
+
+    memset(&full, 0, sizeof(full));
+
+    full.size = size;
+    full.accesses = (uint64_t) counters.accesses;
+    full.reads = (uint64_t) counters.reads;
+    full.read_hits = (uint64_t) counters.read_hits;
+    full.read_misses = (uint64_t) counters.read_misses;
+    full.writes = (uint64_t) counters.writes;
+    full.write_hits = (uint64_t) counters.write_hits;
+    full.write_misses = (uint64_t) counters.write_misses;
+    full.evictions = (uint64_t) counters.evictions;
+    full.stream_ins = (uint64_t) counters.stream_ins;
+    full.stream_outs = (uint64_t) counters.stream_outs;
+    full.cycles = (uint64_t) counters.cycles;
+
+    /* a caller built against an older header gets the fields it knows */
+
+    memcpy(stats, &full, (size < sizeof(full)) ? size : sizeof(full));
+
+    return 0;
+}
@@ -0,0 +1,189 @@
+/* File: CacheLib.h
+ *
+ * Embeddable C interface to the simulator.
+ *
+ * Programs that produce their own accesses (binary instrumentation,
+ * other simulators) link the simulator in as a library and drive a
+ * cache directly: no trace file, no strings, no output. Build the
+ * library from every .c file in src with CACHESIM_LIBRARY defined,
+ * which leaves out the command line main, for example with
+ *
+ *      gcc -O2 -fPIC -fvisibility=hidden -DCACHESIM_LIBRARY -shared
+ *          -o libcachesim.so <sources> -lm -lpthread
+ *
+ * Only the functions below are exported. The interface is a stable
+ * ABI: fixed-width types only, an opaque handle, and structs that only
+ * ever grow at the end. Each struct starts with its own size, so a
+ * program built against an older header keeps working with a newer
+ * library. CACHE_ABI_VERSION changes only if that promise is broken.
+ *
+ * A cache_t is not thread safe; give each thread its own cache.
+ *
+ */
+
+#ifndef CACHELIB_H
+#define CACHELIB_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(__GNUC__)
+#define CACHESIM_API __attribute__((visibility("default")))
+#else
+#define CACHESIM_API
+#endif
+
+/* Interface version */
+#define CACHE_ABI_VERSION 1
+
+/* Operations (cache_access_batch) */
+#define CACHE_OP_READ 0
+#define CACHE_OP_WRITE 1
+
+/* Typedefs */
+typedef struct cache_ cache_t;
+
+/* cache_config
+ *
+ * Geometry and policy of a cache. Fill it with cache_config_init and
+ * change only the fields that matter.
+ *
+ * @param   size            sizeof(cache_config), set by cache_config_init
+ * @param   sets            # of sets (power of two, default 1024)
+ * @param   ways            associativity (1 - 32, default 4)
+ * @param   block_size      block size in bytes (power of two, default 32)
+ * @param   address_size    address width in bits (1 - 64, default 32)
+ * @param   seed            seed of the random, brrip, and drrip policies
+ * @param   policy          replacement policy name: "lru" (default),
+ *                          "plru", "fifo", "random", "srrip", "brrip",
+ *                          or "drrip"; NULL means "lru"
+ */
+
+typedef struct cache_config {
+    uint32_t size;
+    uint32_t sets;
+    uint32_t ways;
+    uint32_t block_size;
+    uint32_t address_size;
+    uint32_t seed;
+    const char *policy;
+} cache_config;
+
+/* cache_stats
+ *
+ * Counters of a cache (cache_get_stats). Set 'size' to
+ * sizeof(cache_stats) before the call.
+ *
+ * @param   size            sizeof(cache_stats), set by the caller
+ * @param   accesses        # of accesses so far
+ * @param   reads           # of reads
+ * @param   read_hits       # of reads that hit
+ * @param   read_misses     # of reads that missed
+ * @param   writes          # of writes
+ * @param   write_hits      # of writes that hit
+ * @param   write_misses    # of writes that missed
+ * @param   evictions       # of valid blocks evicted
+ * @param   stream_ins      # of blocks read from memory
+ * @param   stream_outs     # of blocks written to memory
+ * @param   cycles          # of cycles elapsed
+ */
+
+typedef struct cache_stats {
+    uint32_t size;
+    uint32_t reserved;
+    uint64_t accesses;
+    uint64_t reads;
+    uint64_t read_hits;
+    uint64_t read_misses;
+    uint64_t writes;
+    uint64_t write_hits;
+    uint64_t write_misses;
+    uint64_t evictions;
+    uint64_t stream_ins;
+    uint64_t stream_outs;
+    uint64_t cycles;
+} cache_stats;
+
+/* cache_abi_version
+ *
+ * Returns the CACHE_ABI_VERSION the library was built with.
+ *
+ * @return  interface version
+ */
+
+CACHESIM_API int cache_abi_version(void);
+
+/* cache_config_init
+ *
+ * Fills 'config' with the defaults of the command line simulator.
+ *
+ * @param   config          config to fill
+ *
+ * @return  void
+ */
+
+CACHESIM_API void cache_config_init(cache_config *config);
+
+/* cache_create
+ *
+ * Creates a cache. Returns NULL (with a message on stderr) if the
+ * config is invalid.
+ *
+ * @param   config          geometry and policy; NULL for the defaults
+ *
+ * @return  success         new cache
+ * @return  failure         NULL
+ */
+
+CACHESIM_API cache_t *cache_create(const cache_config *config);
+
+/* cache_destroy
+ *
+ * Frees a cache. Passing NULL does nothing.
+ *
+ * @param   cache           cache to destroy
+ *
+ * @return  void
+ */
+
+CACHESIM_API void cache_destroy(cache_t *cache);
+
+/* cache_access_batch
+ *
+ * Runs 'n' accesses through the cache in order. The addresses are
+ * already decoded; ops[i] is CACHE_OP_READ or CACHE_OP_WRITE (any
+ * non-zero value is a write).
+ *
+ * @param   cache           target cache
+ * @param   addrs           memory addresses
+ * @param   ops             operation of each access
+ * @param   n               # of accesses
+ *
+ * @return  # of accesses that hit
+ */
+
+CACHESIM_API uint64_t cache_access_batch(cache_t *cache, const uint64_t *addrs, const uint8_t *ops, size_t n);
+
+/* cache_get_stats
+ *
+ * Copies the counters into 'stats', up to stats->size bytes.
+ *
+ * @param   cache           target cache
+ * @param   stats           output; 'size' must be set
+ *
+ * @return  success         0
+ * @return  failure         -1 if stats->size is too small
+ */
+
+CACHESIM_API int cache_get_stats(const cache_t *cache, cache_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+/* CACHELIB_H */
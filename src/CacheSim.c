@@ -1,1094 +1,4203 @@
-/* File: CacheSim.c
- * 
- * This program simulates a single-level blocking cache using a trace file.
- * The cache is assumed to be fixed size, allocate-on-write, and write-back.
- * 
- * Usage: ./CacheSim <trace file> [-v] [-t] [-d]
- *
- * <trace file> is the file location that contains a memory access trace.
- *
- * [-v] will include program version information in the output.
- * [-t] will include information about the trace accesses in the output (r/w, tag, offset, etc.)
- * [-d] will dump the final cache contents in the output (valid, dirty, tag, etc.)
- *
- * Trace file must be specified immediately after program executable.
- * Debug commands can be in any order. For example:
- *
- * ./CacheSim "C:\folder\trace.txt"
- * ./CacheSim "C:\folder\trace.txt" -t -v
- * ./CacheSim "C:\folder\trace.txt" -v -d -t
- *
- */
- 
-/********************************
- *     1. Includes              *
- *******************************/
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <stdbool.h>
-#include <math.h>
-#include <assert.h>
-#include <string.h>
-#include <ctype.h>
-#include "CacheSim.h"
-
-/********************************
- *     2. Structs & Globals     *
- ********************************/
-
-/* Block
- *
- * Holds an integer that states the validity of the bit (0 = invalid,
- * 1 = valid), the tag being held, and another integer that states if
- * the bit is dirty or not (0 = clean, 1 = dirty). Also holds the
- * timestamp for when the block was most recently updated (0 = oldest)
- */
-
-struct Block_ {
-    int valid;
-    char* tag;
-    int dirty;
-    int timestamp;
-};
-
-/* Way
- *
- * Holds an integer about which way number it is (1 - 4),
- * and an array of blocks.
- */
-
-struct Way_ {
-	int waynum;
-    Block* blocks;
-};
-
-/* Cache
- *
- * Cache object that holds all the data about cache access as well as 
- * the sizes and an array of ways.
- *
- * @param   reads           # of attempted reads by the trace input
- * @param 	read_hits 		# of reads that hit successfully in the cache
- * @param   read_misses 	# of reads that missed in the cache
- * @param   writes          # of attempted writes by the trace input
- * @param 	write_hits 		# of writes that hit successfully in the cache
- * @param 	write_misses 	# of writes that missed in the cache
- * @param 	cycles 			# of cycle currently elapsed in simulation
- * @param 	stream_ins 		# of stream-in operations from memory to cache
- * @param 	stream_outs 	# of stream_out operations from cache to memory
- * @param 	evictions 		# of valid blocks evicted from cache by LRU policy
- * @param   cache_size      total size of the cache in bytes
- * @param   block_size      how big each block of data is in bytes
- * @param 	associativity	# of ways
- * @param   ways          	pointer to the actual array of ways
- */
-
-
-struct Cache_ {
-    int reads;
-    int read_hits;
-    int read_misses;
-    int writes;
-    int write_hits;
-    int write_misses;
-    int cycles;
-    int stream_ins;
-    int stream_outs;
-    int evictions;
-    int cache_size;
-    int block_size;
-    int associativity;
-    Way* ways;
-};
-
-// global variables for binary address bits
-
-int bitsTag = 0;
-int bitsIndex = 0;
-int bitsOffset = 0;
-
-// global variable for counting memory accesses
-
-int mem_accesses = 0;
-
-// global variables for debug flags
-
-bool VERSION_DEBUG = false;
-bool TRACE_DEBUG = false;
-bool DUMP_DEBUG = false;
-
-/********************************
- *     3. Utility Functions     *
- ********************************/
- 
-/* htoi
- *
- * Converts hexidecimal memory locations to unsigned integers.
- * No real error checking is performed. This function will skip
- * over any non-recognized characters.
- */
- 
-unsigned int htoi(const char str[]) {
-
-    /* Local Variables */
-    unsigned int result;
-    int i;
-
-    i = 0;
-    result = 0;
-    
-    if(str[i] == '0' && str[i+1] == 'x') {
-        i = i + 2;
-    }
-
-    while(str[i] != '\0') {
-
-        result = result * 16;
-
-        if(str[i] >= '0' && str[i] <= '9') {
-            result = result + (str[i] - '0');
-        }
-
-        else if(tolower(str[i]) >= 'a' && tolower(str[i]) <= 'f') {
-            result = result + (tolower(str[i]) - 'a') + 10;
-        }
-
-        i++;
-    }
-
-    return result;
-}
-
-/* getBinary
- *
- * Converts an unsigned integer into a string containing its
- * 32 bit long binary representation.
- *
- *
- * @param   num         number to be converted
- *
- * @result  char*       binary string
- */
- 
-char *getBinary(unsigned int num) {
-
-    char* bstring;
-    int i;
-    
-    /* Calculate the Binary String */
-    
-    bstring = (char*) malloc(sizeof(char) * 33);
-    assert(bstring != NULL);
-    
-    bstring[32] = '\0';
-    
-    for( i = 0; i < 32; i++ ) {
-        bstring[32 - 1 - i] = (num == ((1 << i) | num)) ? '1' : '0';
-    }
-    
-    return bstring;
-}
-
-/* formatBinary
- *
- * Converts a binary string to a formatted version for easier parsing.
- * The format is determined by the bitsTag, bitsIndex, and bitsOffset variables.
- *
- * Ex. Format:
- *  -----------------------------------------------------
- * | Tag: 18 bits | Index: 10 bits | Byte Select: 5 bits |
- *  -----------------------------------------------------
- *
- * Ex. Result:
- * 101010101010101010 1010101010 10101
- *
- * @param   bstring     binary string to be converted
- *
- * @result  char*       formated binary string
- */
-
-char *formatBinary(char *bstring) {
-
-    char *formatted;
-    int i;
-    
-    /* Format for Output */
-    
-    formatted = (char *) malloc(sizeof(char) * 35);
-    assert(formatted != NULL);
-    
-    formatted[ADDRESS_SIZE+2] = '\0';
-    
-    for(i = 0; i < bitsTag; i++) {
-        formatted[i] = bstring[i];
-    }
-    
-    formatted[bitsTag] = ' ';
-    
-    for(i = bitsTag + 1; i < bitsIndex + bitsTag + 1; i++) {
-        formatted[i] = bstring[i - 1];
-    }
-    
-    formatted[bitsIndex + bitsTag + 1] = ' ';
-    
-    for(i = bitsIndex + bitsTag + 2; i < bitsOffset + bitsIndex + bitsTag + 2; i++) {
-        formatted[i] = bstring[i - 2];
-    }
-
-    return formatted;
-}
-
-/* btoi
- *
- * Converts a binary string to an integer. Returns 0 on error.
- *
- * source: http://www.daniweb.com/software-development/c/code/216372
- *
- * @param   bin     binary string to convert
- *
- * @result  int     decimal representation of binary string
- */
-
-int btoi(char *bin) {
-
-    int  b, k, m, n;
-    int  len, sum;
-
-    sum = 0;
-    len = strlen(bin) - 1;
-
-    for(k = 0; k <= len; k++) {
-        n = (bin[k] - '0');
-
-        if ((n > 1) || (n < 0)) {
-            return 0;
-        }
-
-        for(b = 1, m = len; m > k; m--) {
-            b *= 2;
-        }
-
-        sum = sum + n * b;
-    }
-    return(sum);
-}
-
-/* parseMemoryAddress
- *
- * Helper function that takes in a hexadecimal address in
- * the format of "0x00000000" and spits out the decimal, 
- * binary, and formatted binary equivalents. Also, it
- * calculates the corresponding tag, index, and offset.
- *
- * @param       address         Hexadecimal memory address
- *
- * @return      void
- */
-
-void parseMemoryAddress(char *address) {
-
-    unsigned int dec;
-    char *bstring, *bformatted, *tag, *index, *offset;
-    int i;
-    
-    dec = htoi(address);
-    bstring = getBinary(dec);
-    bformatted = formatBinary(bstring);
-    
-    if(TRACE_DEBUG) {
-        printf("Hex: %s\n", address);
-        printf("Decimal: %u\n", dec);
-        printf("Binary: %s\n", bstring);
-        printf("Formatted: %s\n", bformatted);
-    }
-    
-    i = 0;
-    
-    tag = (char *) malloc( sizeof(char) * (bitsTag + 1) );
-    assert(tag != NULL);
-    tag[bitsTag] = '\0';
-    
-    for(i = 0; i < bitsTag; i++) {
-        tag[i] = bformatted[i];
-    }
-    
-    index = (char *) malloc( sizeof(char) * (bitsIndex + 1) );
-    assert(index != NULL);
-    index[bitsIndex] = '\0';
-    
-    for(i = bitsTag + 1; i < bitsIndex + bitsTag + 1; i++) {
-        index[i - bitsTag - 1] = bformatted[i];
-    }
-    
-    offset = (char *) malloc( sizeof(char) * (bitsOffset + 1) );
-    assert(offset != NULL);
-    offset[bitsOffset] = '\0';
-    
-    for(i = bitsIndex + bitsTag + 2; i < bitsOffset + bitsIndex + bitsTag + 2; i++) {
-        offset[i - bitsIndex - bitsTag - 2] = bformatted[i];
-    }
-    
-    printf("Tag: %s (%i)\n", tag, btoi(tag));
-    printf("Index: %s (%i)\n", index, btoi(index));
-    printf("Offset: %s (%i)\n", offset, btoi(offset));
-}
-
-/********************************
- *        4. Main Function      *
- ********************************/
- 
-/*
- * Algorithm:
- *
- *  1. Validate input arguments
- *  2. Open the trace file for reading
- *  3. Create a new Cache object
- *  4. Read a line from the file
- *  5. Parse the line and read or write accordingly
- *  6. If the line is "#eof" continue, otherwise go back to step 4 
- *  7. Print the results
- *  8. Destroy the Cache object
- *  9. Close the file
- */
-
-int main(int argc, char **argv) {
-
-	int counter, i, j;
-    Cache cache;
-    FILE *file;
-    char mode, address[100];
-    
-    /* Technically a line shouldn't be longer than 104 characters, but
-       allocate extra space in the buffer just in case */
-
-    char buffer[LINELENGTH];
-
-    /* Help Menu
-     *
-     * If the help flag is present or there is not the correct # of args,
-     * print the usage menu and return.
-     *
-     * There must be at least 2 args (./CacheSim and <file location>),
-     * and no more than 3 extra debug args (-v, -t, -d).
-     */
-     
-    if(argc < 2 || argc > 5 || strcmp(argv[1], "-h") == 0) {
-        fprintf(stderr, "Usage: ./CacheSim <trace file> [-v] [-t] [-d] \n\n");
-        return -1;
-    }
-    
-    /* Check if there's more than two arguments
-     * If so, use if-else statements to set the appropriate flags
-     * Unrecognized args will terminate the program with an error message
-     */
-
-    if (argc >= 3) {
-
-    		for (i = 3; i <= argc; i++) {
-
-    			if (strcmp(argv[i - 1], "-v") == 0) {
-    				VERSION_DEBUG = true;
-    			}
-    			else if (strcmp(argv[i-1], "-t") == 0) {
-    				TRACE_DEBUG = true;
-    			}
-    			else if (strcmp(argv[i-1], "-d") == 0) {
-    				DUMP_DEBUG = true;
-    			}
-    			else {
-    		        fprintf(stderr, "\nIncorrect arguments: ./CacheSim <trace file> [-v] [-t] [-d]\n\n");
-    		        return -1;
-    			}
-    		}
-    }
-
-    /* calculate other cache parameters */
-
-    bitsOffset = floor(log2(BLOCK_SIZE));
-    bitsIndex = floor(log2(NUMBER_OF_SETS));
-    bitsTag = ADDRESS_SIZE - (bitsOffset + bitsIndex);
-
-    /* Open the file for reading. */
-    file = fopen( argv[1], "r" );
-
-    if( file == NULL ) {
-        fprintf(stderr, "ERROR: Could not open file. Check <file location> argument.\n");
-        return -1;
-    }
-
-    /* If [-v] arg was specified, print version header information */
-
-    if (VERSION_DEBUG) {
-    	printf("\n\n************************ CacheSim v1.0 ************************\n");
-    	printf("************************* Rehan Iqbal *************************\n");
-    	printf("************************* PSU ECE 586 *************************\n");
-    }
-
-    /* Call createCache function, which allocates memory & returns pointer to Cache object */
-    cache = createCache(CACHE_SIZE, BLOCK_SIZE, ASSOCIATIVITY);
-
-    counter = 0;
-    
-    while( fgets(buffer, LINELENGTH, file) != NULL ) {
-
-    	/* Check for #eof statement - skip text processing once encountered */
-        if(buffer[0] != '#') {
-
-        	i = 0;
-
-            /* keep processing line until you hit newline character */
-            while(buffer[i] != '\n') {
-
-            	/* capture the r/w character into mode variable*/
-            	mode = buffer[i];
-
-            	/* push index forward to hex address */
-            	i += 2;
-            	j = 0;
-
-            	/* keep storing hex address in buffer
-            	 * until space or newline is encountered */
-
-            	while(buffer[i] != ' ' && buffer[i] != '\n') {
-            		address[j] = buffer[i];
-            		i++;
-            		j++;
-            	}
-
-            	/* terminate address buffer with NULL for helper function */
-            	address[j] = '\0';
-
-            	/* if last character is NULL, leave index where it is
-            	 * otherwise, move index forward to next memory access*/
-            	if(buffer[i] != '\n'){
-            		i++;
-            	}
-            
-            	/* print address if debug flag is set */
-            	if(TRACE_DEBUG) printf("\nAccess %i: Mode %c -- Address %s\n\n", counter+1, mode, address);
-
-            	mem_accesses++;
-            
-            	/* call read function with address buffer */
-            	if(mode == 'r') {
-            		readFromCache(cache, address);
-            	}
-
-            	/* call write function with address buffer */
-            	else if(mode == 'w') {
-            		writeToCache(cache, address);
-            	}
-
-            	/* if no valid mode detected, terminate program
-            	 * after freeing cache memory & closing file safely */
-
-            	else {
-            		printf("Error on memory access %i! Check trace file input.\n", counter);
-            		fclose(file);
-            		destroyCache(cache);
-            		cache = NULL;
-                
-            		return -1;
-            	}
-
-            	counter++;
-            }
-        }
-    }
-
-    /* Call printCache function to print cache statistics and dump information */
-    printCache(cache);
-    
-    /* Close the file, destroy the cache. */
-    
-    fclose(file);
-    destroyCache(cache);
-    cache = NULL;
-    
-    return 0;
-}
-
-/********************************
- *     5. Cache Functions       *
- ********************************/
- 
-/* Function List:
- *
- * 1) createCache
- * 2) destroyCache
- * 3) readFromCache
- * 4) writeToCache
- * 5) printCache
- */
-
-
-/* createCache
- *
- * Function to create a new cache struct.  Returns the new struct on success
- * and NULL on failure.
- *
- * @param   cache_size      size of cache in bytes
- * @param   block_size      size of each block in bytes
- * @param 	associativity 	# of ways
- *
- * @return  success         new Cache
- * @return  failure         NULL
- */
-
-Cache createCache(int cache_size, int block_size, int associativity) {
-
-	Cache cache;
-    int i = 0;
-    int j = 0;
-    
-    /* Validate Inputs */
-    if(cache_size <= 0) {
-        fprintf(stderr, "Error: Cache size must be greater than 0 bytes!\n");
-        return NULL;
-    }
-    
-    if(block_size <= 0) {
-        fprintf(stderr, "Error: Block size must be greater than 0 bytes!\n");
-        return NULL;
-    }
-    
-    
-    /* Lets make a cache!
-     * allocate all the memory needed for a cache structure */
-
-    cache = (Cache) malloc( sizeof( struct Cache_ ) );
-
-    if(cache == NULL) {
-        fprintf(stderr, "Error: could not allocate memory for cache.\n");
-        return NULL;
-    }
-    
-    /* Initialize the cache parameters */
-
-    cache->reads = 0;
-    cache->read_hits = 0;
-    cache->read_misses = 0;
-
-    cache->writes = 0;
-    cache->write_hits = 0;
-    cache->write_misses = 0;
-
-    cache->cycles = 0;
-
-    cache->stream_ins = 0;
-    cache->stream_outs = 0;
-    cache->evictions = 0;
-
-    cache->cache_size = cache_size;
-    cache->block_size = block_size;
-    cache->associativity = associativity;
-
-    /* Allocate all the memory for ALL ways */
-
-	cache->ways = (Way*) malloc( sizeof(Way) * associativity );
-	assert(cache->ways != NULL);
-
-    for(j = 0; j < associativity; j++) {
-
-    	/* Allocate memory for this INDIVIDUAL way */
-
-		cache->ways[j] = (Way) malloc( sizeof( struct Way_ ) );
-		assert(cache->ways[j] != NULL);
-
-    	cache->ways[j]->waynum = j;
-
-		/* Allocate space for ALL Blocks */
-
-		cache->ways[j]->blocks = (Block*) malloc( sizeof(Block) * NUMBER_OF_SETS );
-		assert(cache->ways[j]->blocks != NULL);
-
-		/* By default insert blocks where valid = 0 */
-		for(i = 0; i < NUMBER_OF_SETS; i++) {
-
-			/* Allocate memory for this INDIVIDUAL block */
-
-			cache->ways[j]->blocks[i] = (Block) malloc( sizeof( struct Block_ ) );
-			assert(cache->ways[j]->blocks[i] != NULL);
-
-			/* Initialize parameters for this block */
-
-			cache->ways[j]->blocks[i]->valid = 0;
-			cache->ways[j]->blocks[i]->dirty = 0;
-			cache->ways[j]->blocks[i]->tag = NULL;
-			cache->ways[j]->blocks[i]->timestamp = 0;
-
-		}
-    }
-    
-    return cache;
-}
-
-/* destroyCache
- * 
- * Function that destroys a created cache. Frees all allocated memory. If 
- * you pass in NULL, nothing happens. So make sure to set your cache = NULL
- * after you destroy it to prevent a double free.
- *
- * @param   cache           cache object to be destroyed
- *
- * @return  void
- */
-
-void destroyCache(Cache cache) {
-
-    int i;
-    int j;
-    
-    if(cache != NULL) {
-
-    	/* Deallocate ALL ways in this cache */
-    	for (j = 0; j < ASSOCIATIVITY; j++) {
-
-    		/* Deallocate ALL blocks in this way */
-			for( i = 0; i < NUMBER_OF_SETS; i++ ) {
-
-				/* Check if the block entry is NULL */
-
-				if(cache->ways[j]->blocks[i]->tag != NULL) {
-					free(cache->ways[j]->blocks[i]->tag);
-				}
-
-				/* Deallocate this INDIVIDUAL block */
-				free(cache->ways[j]->blocks[i]);
-			}
-
-			/* Deallocate this INDIVIDUAL way */
-
-			free(cache->ways[j]->blocks);
-			free(cache->ways[j]);
-    	}
-
-        free(cache->ways);
-        free(cache);
-    }
-
-    return;
-}
-
-/* readFromCache
- *
- * Function that reads data from a cache. Returns 0 on failure
- * or 1 on success. 
- *
- * @param       cache       target cache struct
- * @param       address     hexidecimal address
- *
- * @return      success     0
- * @return      failure     -1
- */
-
-int readFromCache(Cache cache, char* address) {
-
-    unsigned int dec;
-    char *bstring, *bformatted, *tag, *index, *offset;
-    int i;
-    int j;
-    int LRU;
-    int LRU_access_num;
-    bool noHit = true;
-
-    Block block;
-    
-    
-    /* Validate inputs */
-    if(cache == NULL) {
-        fprintf(stderr, "Error: Must supply a valid cache to write to!\n");
-        return -1;
-    }
-    
-    if(address == NULL) {
-        fprintf(stderr, "Error: Must supply a valid memory address!\n");
-        return -1;
-    }
-    
-    /* Convert and parse necessary values */
-    
-    dec = htoi(address);
-    bstring = getBinary(dec);
-    bformatted = formatBinary(bstring);
-    
-    /* Print cache address bits for debugging if [-t] arg was specified */
-
-    if(TRACE_DEBUG) {
-        printf("\tHex: %s\n", address);
-        printf("\tDecimal: %u\n", dec);
-        printf("\tBinary: %s\n", bstring);
-        printf("\tFormatted: %s\n\n", bformatted);
-    }
-        
-    i = 0;
-    
-    tag = (char *) malloc( sizeof(char) * (bitsTag + 1) );
-    assert(tag != NULL);
-    tag[bitsTag] = '\0';
-    
-    for(i = 0; i < bitsTag; i++) {
-        tag[i] = bformatted[i];
-    }
-    
-    index = (char *) malloc( sizeof(char) * (bitsIndex + 1) );
-    assert(index != NULL);
-    index[bitsIndex] = '\0';
-    
-    for(i = bitsTag + 1; i < bitsIndex + bitsTag + 1; i++) {
-        index[i - bitsTag - 1] = bformatted[i];
-    }
-    
-    offset = (char *) malloc( sizeof(char) * (bitsOffset + 1) );
-    assert(offset != NULL);
-    offset[bitsOffset] = '\0';
-    
-    for(i = bitsIndex + bitsTag + 2; i < bitsOffset + bitsIndex + bitsTag + 2; i++) {
-        offset[i - bitsIndex - bitsTag - 2] = bformatted[i];
-    }
-    
-    /* Print tag + index + offset for debugging if [-t] arg was specified */
-
-    if(TRACE_DEBUG) {
-        printf("\tTag: %s (%i)\n", tag, btoi(tag));
-        printf("\tIndex: %s (%i)\n", index, btoi(index));
-        printf("\tOffset: %s (%i)\n\n", offset, btoi(offset));
-    }
-    
-    /* Get the block */
-	if(TRACE_DEBUG) printf("\tAttempting to read data from cache slot %i.\n", btoi(index));
-
-	/* Increment an attempted read access */
-	cache->reads++;
-
-	/* Check through ALL 4 ways of the cache for that particular block */
-    for(j = 0; j < ASSOCIATIVITY; j++) {
-
-		block = cache->ways[j]->blocks[btoi(index)];
-
-		/* if there's a cache hit (valid && tags match) */
-
-		if(block->valid == 1 && strcmp(block->tag, tag) == 0) {
-
-			cache->read_hits++;
-			cache->cycles += 1;
-			noHit = false;
-			block->timestamp = mem_accesses;
-			if (TRACE_DEBUG) printf("\tCache hit on Way %d. Block timestamp updated to %d.\n", j, mem_accesses);
-			free(tag);
-		}
-
-    }
-
-	/* Otherwise, cache miss - implement LRU here */
-
-	if (noHit == true) {
-
-		cache->read_misses++;
-		cache->stream_ins++;
-		cache->cycles +=51;
-
-        LRU_access_num = mem_accesses;
-
-        /* Search through blocks in all 4 ways to find LRU */
-
-        for (j = 0; j < ASSOCIATIVITY; j++) {
-
-            block = cache->ways[j]->blocks[btoi(index)];
-
-            if(block->timestamp < LRU_access_num) {
-            	LRU_access_num = block->timestamp;
-            	LRU = j;
-            }
-        }
-
-        /* evict LRU and update cache statistics */
-
-		if (TRACE_DEBUG) printf("\tCache miss - eviction on Way %d. Block timestamp updated to %d.\n", LRU, mem_accesses);
-        block = cache->ways[LRU]->blocks[btoi(index)];
-
-        /* if data was dirty, need to stream-out and reset dirty bit */
-
-		if(block->dirty == 1) {
-			cache->stream_outs++;
-			cache->cycles += 50;
-			block->dirty = 0;
-		}
-
-		block->valid = 1;
-        block->timestamp = mem_accesses;
-
-        /* if non-null data got evicted, log an eviction */
-
-		if(block->tag != NULL) {
-			cache->evictions++;
-			free(block->tag);
-		}
-
-		/* replace victim tag with incoming block's tag */
-		block->tag = tag;
-
-	}
-    
-    free(bstring);
-    free(bformatted);
-    free(offset);
-    free(index);
-    return 0;
-}
-
-/* writeToCache
- *
- * Function that writes data to the cache. Returns 0 on failure or
- * 1 on success. Frees any old tags that already existed in the
- * target slot.
- *
- * @param       cache       target cache struct
- * @param       address     hexidecimal address
- *
- * @return      success     0
- * @return      error       -1
- */
-
-int writeToCache(Cache cache, char* address) {
-
-    unsigned int dec;
-    char *bstring, *bformatted, *tag, *index, *offset;
-    int i = 0;
-    int j = 0;
-    int LRU;
-    int LRU_access_num;
-    bool noHit = true;
-    
-    Block block;
-
-    /* Validate inputs */
-    if(cache == NULL) {
-        fprintf(stderr, "Error: Must supply a valid cache to write to!\n");
-        return -1;
-    }
-    
-    if(address == NULL) {
-        fprintf(stderr, "Error: Must supply a valid memory address!\n");
-        return -1;
-    }
-    
-    /* Convert and parse necessary values */
-    
-    dec = htoi(address);
-    bstring = getBinary(dec);
-    bformatted = formatBinary(bstring);
-    
-    if(TRACE_DEBUG) {
-        printf("\tHex: %s\n", address);
-        printf("\tDecimal: %u\n", dec);
-        printf("\tBinary: %s\n", bstring);
-        printf("\tFormatted: %s\n\n", bformatted);
-    }
-        
-    i = 0;
-    
-    tag = (char *) malloc( sizeof(char) * (bitsTag + 1) );
-    assert(tag != NULL);
-    tag[bitsTag] = '\0';
-    
-    for(i = 0; i < bitsTag; i++) {
-        tag[i] = bformatted[i];
-    }
-    
-    index = (char *) malloc( sizeof(char) * (bitsIndex + 1) );
-    assert(index != NULL);
-    index[bitsIndex] = '\0';
-    
-    for(i = bitsTag + 1; i < bitsIndex + bitsTag + 1; i++) {
-        index[i - bitsTag - 1] = bformatted[i];
-    }
-    
-    offset = (char *) malloc( sizeof(char) * (bitsOffset + 1) );
-    assert(offset != NULL);
-    offset[bitsOffset] = '\0';
-    
-    for(i = bitsIndex + bitsTag + 2; i < bitsOffset + bitsIndex + bitsTag + 2; i++) {
-        offset[i - bitsIndex - bitsTag - 2] = bformatted[i];
-    }
-    
-    if(TRACE_DEBUG) {
-        printf("\tTag: %s (%i)\n", tag, btoi(tag));
-        printf("\tIndex: %s (%i)\n", index, btoi(index));
-        printf("\tOffset: %s (%i)\n\n", offset, btoi(offset));
-    }
-    
-    /* Get the block */
-    
-    if(TRACE_DEBUG) printf("\tAttempting to write data to cache slot %i.\n", btoi(index));
-
-    /* Log another attempted write access */
-
-    cache->writes++;
-
-    /* Check through ALL 4 ways for that particular block */
-
-    for (j = 0; j < ASSOCIATIVITY; j++) {
-
-        block = cache->ways[j]->blocks[btoi(index)];
-
-        /* if there was a write hit (valid bit set && tags match) */
-
-        if(block->valid == 1 && strcmp(block->tag, tag) == 0) {
-
-            noHit = false;
-            block->dirty = 1;
-            block->timestamp = mem_accesses;
-            cache->write_hits++;
-            cache->cycles += 1;
-			if (TRACE_DEBUG) printf("\tCache hit on Way %d. Block timestamp updated to %d.\n", j, mem_accesses);
-            free(tag);
-        }
-    }
-
-
-    /* cache miss - implement LRU here */
-
-    if (noHit == true) {
-
-        cache->write_misses++;
-        cache->stream_ins++;
-        cache->cycles +=51;
-        
-        LRU_access_num = mem_accesses;
-
-        /* search through all 4 ways looking for LRU block */
-
-        for (j = 0; j < ASSOCIATIVITY; j++) {
-
-            block = cache->ways[j]->blocks[btoi(index)];
-
-            if(block->timestamp < LRU_access_num) {
-            	LRU_access_num = block->timestamp;
-            	LRU = j;
-            }
-        }
-
-        /* evict the LRU block & update cache statistics */
-
-		if (TRACE_DEBUG) printf("\tCache miss - eviction on Way %d. Block timestamp updated to %d.\n", LRU, mem_accesses);
-		block = cache->ways[LRU]->blocks[btoi(index)];
-
-		/* if eviction target was dirty, must stream-out */
-
-        if(block->dirty == 1) {
-            cache->stream_outs++;
-            cache->cycles += 50;
-        }        
-        
-        /* allocate-on-write policy -> overwritten data is in cache
-         * must set the dirty & valid bits */
-
-        block->dirty = 1;
-        block->valid = 1;
-        block->timestamp = mem_accesses;
-        
-        /* if evicted data was non-null, log an eviction */
-
-        if(block->tag != NULL) {
-        	cache->evictions++;
-            free(block->tag);
-        }
-        
-        /* replace victim tag with new block's tag */
-        block->tag = tag;
-    }
-    
-    free(bstring);
-    free(bformatted);
-    free(offset);
-    free(index);
-    return 0;
-}
-
-/* printCache
- *
- * Prints out the values of each slot in the cache
- * as well as the hit, miss, read, write, and size
- * data.
- *
- * @param       cache       Cache struct
- *
- * @return      void
- */
-
-void printCache(Cache cache) {
-
-    int i;
-    int j;
-
-    Block block;
-
-    /* define some local integers to hold count totals */
-
-    int cache_total = (int) (cache->reads) + (cache->writes);
-    int cache_hits = (int) (cache->read_hits) + (cache->write_hits);
-    int cache_misses = (int) (cache->read_misses) + (cache->write_misses);
-
-    char* tag;
-    
-    if(cache != NULL) {
-
-    	/* Printing cache contents at the end of simulation
-    	 * if the debug flag was set */
-
-    	if (DUMP_DEBUG) {
-    		for (j = 0; j < ASSOCIATIVITY; j++) {
-    			printf("\n\n******** Way # %d ********\n\n", cache->ways[j]->waynum);
-
-				for(i = 0; i < NUMBER_OF_SETS; i++) {
-
-					block = cache->ways[j]->blocks[i];
-					tag = "NULL";
-
-					if(block->tag != NULL) {
-						tag = block->tag;
-					}
-
-					printf("\t[%i]: { valid: %i, dirty: %i, timestamp: %d, tag: %s }\n", i, block->valid, block->dirty, block->timestamp, tag);
-				}
-    		}
-    	}
-
-    	/* Printing cache statistics to the console */
-
-        printf("\nCache parameters:\n\n");
-
-        printf("\tCache size: %d\n", cache->cache_size);
-        printf("\tCache block size: %d\n", cache->block_size);
-        printf("\tCache number of lines: %d\n", NUMBER_OF_SETS);
-        printf("\tCache associativity: %d\n", ASSOCIATIVITY);
-
-        printf("\nCache performance:\n\n");
-
-        printf("\tAttempted reads: %d\n", cache->reads);
-        printf("\tCache read hits: %d\n", cache->read_hits);
-        printf("\tCache read misses: %d\n\n", cache->read_misses);
-
-        printf("\tAttempted writes: %d\n", cache->writes);
-        printf("\tCache write hits: %d\n", cache->write_hits);
-        printf("\tCache write misses: %d\n\n", cache->write_misses);
-
-        printf("\tCache hits: %d\n", cache_hits);
-        printf("\tCache misses: %d\n", cache_misses);
-        printf("\tTotal accesses: %d\n\n", cache_total);
-
-        printf("\tCache hit ratio: %2.2f%%\n", ((float) (cache_hits) / (float) (cache_total) ) * 100);
-        printf("\tCache miss ratio: %2.2f%%\n\n", ((float) (cache_misses) / (float) (cache_total) ) * 100);
-
-        printf("\tStream-in operations: %d\n", cache->stream_ins);
-        printf("\tCache evictions: %d\n", cache->evictions);
-        printf("\tStream-out operations: %d\n\n", cache->stream_outs);
-
-        printf("\tCycles with cache: %d\n", cache->cycles);
-        printf("\tCycles without cache: %d\n\n", 50*cache_total);
-
-    }
-
-}
\ No newline at end of file
+/* File: CacheSim.c
+ * 
+ * This program simulates a single-level blocking cache using a trace file.
+ * The cache is fixed size and, by default, allocate-on-write and write-back.
+ * 
+ * Usage: ./CacheSim <trace file> [-v] [-t] [-d] [-sets N] [-ways N] [-block N] [-addr N]
+ *                   [-config SETS:WAYS:BLOCK[:POLICY]]... [-threads N] [-shards N] [-mrc K]
+ *                   [-policy NAME] [-seed N] [-level SETS:WAYS:BLOCK:LATENCY[:INCLUSION][:POLICY]]...
+ *                   [-memory N] [-core <trace file>]... [-protocol NAME] [-quantum N]
+ *                   [-write-through] [-no-write-allocate] [-write-buffer N] [-mshrs N]
+ *                   [-prefetch NAME] [-prefetch-degree N] [-victim-cache N] [-miss-cache N] [-3c]
+ *                   [-log FILE] [-log-sets FIRST[:LAST]] [-log-tag T] [-log-accesses FIRST[:LAST]]
+ *                   [-interval N] [-interval-cycles N] [-interval-file FILE] [-heatmap K]
+ *                   [-checkpoint FILE] [-checkpoint-at N] [-warm FILE] [-resume FILE]
+ *                   [-sample-sets N]
+ *        ./CacheSim convert <text trace> <binary trace>
+ *        ./CacheSim decode <event log>
+ *
+ * <trace file> is the file location that contains a memory access trace,
+ * either text or binary (as written by the convert subcommand). A text
+ * trace may also come from a named pipe, or from stdin when <trace file>
+ * is -.
+ *
+ * [-v] will include program version information in the output.
+ * [-t] will include information about the trace accesses in the output (r/w, tag, offset, etc.)
+ * [-d] will dump the final cache contents in the output (valid, dirty, tag, etc.)
+ * [-sets N] sets the number of sets (power of two, default 1024)
+ * [-ways N] sets the associativity (1 - 32, default 4)
+ * [-block N] sets the block size in bytes (power of two, default 32)
+ * [-addr N] sets the address width in bits (1 - 64, default 32)
+ * [-config SETS:WAYS:BLOCK[:POLICY]] adds a configuration to a single-pass sweep (repeatable)
+ * [-threads N] sets the # of sweep worker threads (default: # of CPUs)
+ * [-shards N] simulates the single cache on N threads, each owning a range of sets
+ * [-mrc K] prints LRU miss ratio curves for 1 - K ways and 1 - N sets instead of simulating
+ * [-policy NAME] sets the replacement policy: lru (default), plru, fifo, random, srrip, brrip, drrip
+ * [-seed N] seeds the random choices of the random, brrip, and drrip policies (default 1)
+ * [-level SETS:WAYS:BLOCK:LATENCY[:INCLUSION][:POLICY]] adds the next level of a cache hierarchy,
+ *     L1 first (repeatable); INCLUSION is inclusive, exclusive, or nine (default)
+ * [-memory N] sets the memory latency of a hierarchy in cycles (default 50)
+ * [-core <trace file>] adds another core with its own trace and private cache (repeatable);
+ *     the first trace file is core 0
+ * [-protocol NAME] sets the coherence protocol of the cores: mesi (default) or moesi
+ * [-quantum N] sets the # of accesses each core runs before the next core's turn (default 1)
+ * [-write-through] writes every write hit on to memory instead of writing dirty blocks back
+ * [-no-write-allocate] sends write misses to memory without filling the block
+ * [-write-buffer N] buffers writes to memory in an N-entry coalescing write buffer (1 - 64)
+ * [-mshrs N] also times the cache as non-blocking with N miss status holding registers (1 - 64)
+ * [-prefetch NAME] adds a hardware prefetcher: next-line, stride, or stream
+ * [-prefetch-degree N] sets how many blocks the prefetcher runs ahead (1 - 16, default 2)
+ * [-victim-cache N] adds an N-block fully-associative victim cache (1 - 64)
+ * [-miss-cache N] adds an N-block fully-associative miss cache (1 - 64)
+ * [-3c] classifies every miss as compulsory, capacity, or conflict
+ * [-log FILE] records every access in a binary event log instead of printing it (see decode)
+ * [-log-sets FIRST[:LAST]] only logs accesses to sets FIRST - LAST
+ * [-log-tag T] only logs accesses with the hexadecimal tag T
+ * [-log-accesses FIRST[:LAST]] only logs accesses FIRST - LAST (1-based)
+ * [-interval N] writes a CSV row of statistics for every N accesses
+ * [-interval-cycles N] writes a CSV row of statistics for every N cycles
+ * [-interval-file FILE] writes the interval rows to FILE instead of stdout
+ * [-heatmap K] counts accesses, misses, and evictions per set and lists the K hottest and
+ *     most conflicted sets
+ * [-checkpoint FILE] saves the cache's state to FILE at the end of the trace
+ * [-checkpoint-at N] saves the checkpoint once N accesses have run instead
+ * [-warm FILE] starts from the cache contents saved in FILE, with the counters at zero
+ * [-resume FILE] continues the run saved in FILE from where it was taken
+ * [-sample-sets N] simulates 1 in N sets and estimates the full run's miss ratio
+ *     with a 95% confidence interval
+ *
+ * Trace file must be specified immediately after program executable.
+ * Debug commands can be in any order. For example:
+ *
+ * ./CacheSim "C:\folder\trace.txt"
+ * ./CacheSim "C:\folder\trace.txt" -t -v
+ * ./CacheSim "C:\folder\trace.txt" -v -d -t
+ * ./CacheSim "C:\folder\trace.txt" -ways 16 -block 64
+ * ./CacheSim "C:\folder\trace.txt" -config 1024:4:32 -config 2048:8:64
+ * ./CacheSim "C:\folder\trace.txt" -config 1024:8:64:lru -config 1024:8:64:drrip
+ * ./CacheSim "C:\folder\trace.txt" -shards 4 -sets 65536
+ * ./CacheSim "C:\folder\trace.txt" -mrc 16 -sets 4096
+ * ./CacheSim "C:\folder\trace.txt" -level 64:8:64:4 -level 1024:8:64:12:inclusive -memory 200
+ * ./CacheSim "C:\folder\core0.txt" -core "C:\folder\core1.txt" -protocol moesi
+ * ./CacheSim "C:\folder\trace.txt" -write-through -no-write-allocate -write-buffer 8
+ * ./CacheSim "C:\folder\trace.txt" -mshrs 8
+ * ./CacheSim "C:\folder\trace.txt" -prefetch stride -prefetch-degree 4
+ * ./CacheSim "C:\folder\trace.txt" -victim-cache 8
+ * ./CacheSim "C:\folder\trace.txt" -3c -config 1024:1:32 -config 256:4:32
+ * ./CacheSim "C:\folder\trace.txt" -log "C:\folder\trace.log" -log-sets 128:131
+ * ./CacheSim decode "C:\folder\trace.log"
+ * ./CacheSim "C:\folder\trace.txt" -interval 100000 -interval-file "C:\folder\phases.csv"
+ * ./CacheSim "C:\folder\trace.txt" -heatmap 8
+ * ./CacheSim "C:\folder\trace.txt" -checkpoint "C:\folder\warm.ckpt" -checkpoint-at 1000000
+ * ./CacheSim "C:\folder\trace.txt" -resume "C:\folder\warm.ckpt"
+ * ./CacheSim "C:\folder\trace.bin" -sets 65536 -sample-sets 32
+ * tracer | ./CacheSim - -ways 8
+ *
+ */
+ 
+/********************************
+ *     1. Includes              *
+ *******************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+#include <assert.h>
+#include <string.h>
+#include <ctype.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include "CacheSim.h"
+#include "TagMatch.h"
+#include "Policy.h"
+#include "Sweep.h"
+#include "Shard.h"
+#include "Hierarchy.h"
+#include "Coherence.h"
+#include "Mshr.h"
+#include "Prefetch.h"
+#include "VictimCache.h"
+#include "MissClass.h"
+#include "StackDist.h"
+#include "BinTrace.h"
+#include "TextTrace.h"
+#include "TraceReader.h"
+#include "EventLog.h"
+#include "Interval.h"
+#include "Heatmap.h"
+#include "Checkpoint.h"
+#include "Sample.h"
+
+/********************************
+ *     2. Structs & Globals     *
+ ********************************/
+
+/* AccessKernel
+ *
+ * Looks up an address in its set and fills a way chosen by the
+ * replacement policy on a miss,
+ * updating the hit/miss, stream, eviction, and cycle counters. Returns
+ * 1 on a hit and 0 on a miss. createCache picks a kernel specialized
+ * for the cache geometry and policy (see section 6).
+ */
+
+typedef int (*AccessKernel)(Cache cache, uint64_t address, int write);
+
+/* Set
+ *
+ * Header of one set's record in the flat tag store. Bit j of the valid
+ * mask states whether way j holds a block (0 = invalid, 1 = valid) and
+ * bit j of the dirty mask states whether it must be streamed out on
+ * eviction (0 = clean, 1 = dirty).
+ *
+ * The header is followed in memory by the integer tags of all ways and
+ * then by the replacement policy's bit-packed metadata for the set (see
+ * Policy.h), so every way of a set sits in the same one or two cache
+ * lines. Tags are 32 bits wide, or 64 bits in a 'wide' cache whose tags
+ * do not fit in 32. Use getSet, setTags (setWideTags), and setMeta to
+ * reach them.
+ */
+
+struct Set_ {
+    unsigned int valid;
+    unsigned int dirty;
+};
+
+/* Cache
+ *
+ * Cache object that holds all the data about cache access as well as 
+ * the sizes and the tag store.
+ *
+ * @param   reads           # of attempted reads by the trace input
+ * @param 	read_hits 		# of reads that hit successfully in the cache
+ * @param   read_misses 	# of reads that missed in the cache
+ * @param   writes          # of attempted writes by the trace input
+ * @param 	write_hits 		# of writes that hit successfully in the cache
+ * @param 	write_misses 	# of writes that missed in the cache
+ * @param 	cycles 			# of cycle currently elapsed in simulation
+ * @param 	stream_ins 		# of stream-in operations from memory to cache
+ * @param 	stream_outs 	# of stream_out operations from cache to memory
+ * @param 	evictions 		# of valid blocks evicted from cache by LRU policy
+ * @param   mem_accesses    # of accesses so far
+ * @param   cache_size      total size of the cache in bytes
+ * @param   block_size      how big each block of data is in bytes
+ * @param 	associativity	# of ways
+ * @param   number_of_sets  # of sets (lines per way)
+ * @param   address_size    width of a memory address in bits
+ * @param   bitsTag         # of tag bits in an address
+ * @param   bitsIndex       # of index bits in an address
+ * @param   bitsOffset      # of byte select bits in an address
+ * @param   tag_mask        mask for the tag field after shifting
+ * @param   index_mask      mask for the index field after shifting
+ * @param   wide            tags are stored in 64 bits (bitsTag > 32)
+ * @param   sets            flat, set-major tag store (one record per set)
+ * @param   set_stride      size of one set record in bytes
+ * @param   mapped          bytes of 'sets' mapped from a checkpoint (0 = allocated)
+ * @param   access          set lookup/fill kernel chosen for this geometry
+ * @param   policy          replacement policy (see Policy.h)
+ * @param   policy_state    cache-wide replacement state
+ * @param   shared          per set, bit j: way j is shared with another
+ *                          cache (NULL until setBlockState first sets one)
+ * @param   write_policy    WRITE_BACK, or WRITE_THROUGH / WRITE_NO_ALLOCATE
+ * @param   buffer          write buffer: ring of block addresses (or NULL)
+ * @param   buffer_entries  # of write buffer entries (0 = no buffer)
+ * @param   buffer_head     slot of the oldest entry
+ * @param   buffer_count    # of entries waiting
+ * @param   buffer_done     cycle at which the oldest entry reaches memory
+ * @param   buffer_merges   # of writes merged into a waiting entry
+ * @param   buffer_stalls   # of cycles spent waiting for the write buffer
+ * @param   mshr            non-blocking timing model (NULL = blocking only)
+ * @param   prefetcher      hardware prefetcher (NULL = demand fills only)
+ * @param   prefetched      per set, bit j: way j was prefetched and not yet used
+ * @param   arrival         cycle at which each way's prefetched block arrives
+ * @param   prefetch_free   cycle at which memory is done with the queued prefetches
+ * @param   prefetches      # of prefetches sent to memory
+ * @param   prefetch_dropped    # of prefetches dropped because memory was busy
+ * @param   prefetch_useful     # of prefetched blocks used by a demand access
+ * @param   prefetch_late       # of those used before they arrived
+ * @param   prefetch_late_cycles    # of cycles spent waiting for late prefetches
+ * @param   prefetch_useless    # of prefetched blocks evicted or dropped unused
+ * @param   prefetch_polluting  # of demand misses on blocks a prefetch evicted
+ * @param   prefetch_contention # of cycles demand misses waited behind prefetches
+ * @param   side            victim or miss cache beside the sets (or NULL)
+ * @param   side_hits       # of misses in the sets that hit in 'side'
+ * @param   classes         3C miss classifier (or NULL)
+ * @param   log             binary event log of every access (or NULL; not owned)
+ * @param   interval        interval statistics (or NULL)
+ * @param   interval_next   access # or cycle at which the next interval ends
+ * @param   set_counters    per set access, miss, and eviction counters (or NULL)
+ * @param   heatmap_top     # of sets in each list of the heatmap report (0 = no report)
+ * @param   sample          sets simulated under set sampling (or NULL for all)
+ * @param   sample_skipped  # of accesses to sets that are not sampled
+ */
+
+
+struct Cache_ {
+    long long reads;
+    long long read_hits;
+    long long read_misses;
+    long long writes;
+    long long write_hits;
+    long long write_misses;
+    long long cycles;
+    long long stream_ins;
+    long long stream_outs;
+    long long evictions;
+    long long mem_accesses;
+    long long cache_size;
+    int block_size;
+    int associativity;
+    int number_of_sets;
+    int address_size;
+    int bitsTag;
+    int bitsIndex;
+    int bitsOffset;
+    uint64_t tag_mask;
+    unsigned int index_mask;
+    int wide;
+    unsigned char* sets;
+    size_t set_stride;
+    size_t mapped;
+    AccessKernel access;
+    int policy;
+    PolicyState policy_state;
+    unsigned int* shared;
+    int write_policy;
+    uint64_t* buffer;
+    int buffer_entries;
+    int buffer_head;
+    int buffer_count;
+    long long buffer_done;
+    long long buffer_merges;
+    long long buffer_stalls;
+    Mshr mshr;
+    Prefetcher prefetcher;
+    unsigned int* prefetched;
+    long long* arrival;
+    long long prefetch_free;
+    long long prefetches;
+    long long prefetch_dropped;
+    long long prefetch_useful;
+    long long prefetch_late;
+    long long prefetch_late_cycles;
+    long long prefetch_useless;
+    long long prefetch_polluting;
+    long long prefetch_contention;
+    VictimCache side;
+    long long side_hits;
+    MissClass classes;
+    EventLog log;
+    Interval interval;
+    long long interval_next;
+    SetCounters* set_counters;
+    int heatmap_top;
+    SetSample* sample;
+    long long sample_skipped;
+};
+
+// access kernel for a given geometry (section 6)
+
+static AccessKernel selectKernel(int associativity, int bitsOffset, int policy, int general, int wide);
+static int needsGeneralKernel(Cache cache);
+
+// command line summary for the help and error messages
+
+#define USAGE "./CacheSim <trace file> [-v] [-t] [-d] [-sets N] [-ways N] [-block N] [-addr N] [-config SETS:WAYS:BLOCK[:POLICY]]... [-threads N] [-shards N] [-mrc K] [-policy NAME] [-seed N] [-level SETS:WAYS:BLOCK:LATENCY[:INCLUSION][:POLICY]]... [-memory N] [-core <trace file>]... [-protocol NAME] [-quantum N] [-write-through] [-no-write-allocate] [-write-buffer N] [-mshrs N] [-prefetch NAME] [-prefetch-degree N] [-victim-cache N] [-miss-cache N] [-3c] [-log FILE] [-log-sets FIRST[:LAST]] [-log-tag T] [-log-accesses FIRST[:LAST]] [-interval N] [-interval-cycles N] [-interval-file FILE] [-heatmap K] [-checkpoint FILE] [-checkpoint-at N] [-warm FILE] [-resume FILE] [-sample-sets N]"
+#define CONVERT_USAGE "./CacheSim convert <text trace> <binary trace>"
+#define DECODE_USAGE "./CacheSim decode <event log>"
+
+// cycles to write one block to memory
+
+#define MEMORY_WRITE_CYCLES 50
+
+// cycles to fetch one block from memory (a blocking miss costs one more)
+
+#define MEMORY_READ_CYCLES 50
+
+// cycles for a miss in the sets that hits in the victim or miss cache
+
+#define SIDE_HIT_CYCLES 2
+
+// accesses ahead of the current one whose 3C hash slot is prefetched
+
+#define MISSCLASS_AHEAD 16
+
+// global variables for debug flags
+
+bool VERSION_DEBUG = false;
+bool TRACE_DEBUG = false;
+bool DUMP_DEBUG = false;
+
+/********************************
+ *     3. Utility Functions     *
+ ********************************/
+ 
+/* htoi
+ *
+ * Converts hexidecimal memory locations to 64-bit unsigned integers.
+ * No real error checking is performed. This function will skip
+ * over any non-recognized characters.
+ */
+ 
+uint64_t htoi(const char str[]) {
+
+    /* Local Variables */
+    uint64_t result;
+    int i;
+
+    i = 0;
+    result = 0;
+    
+    if(str[i] == '0' && str[i+1] == 'x') {
+        i = i + 2;
+    }
+
+    while(str[i] != '\0') {
+
+        result = result * 16;
+
+        if(str[i] >= '0' && str[i] <= '9') {
+            result = result + (str[i] - '0');
+        }
+
+        else if(tolower(str[i]) >= 'a' && tolower(str[i]) <= 'f') {
+            result = result + (tolower(str[i]) - 'a') + 10;
+        }
+
+        i++;
+    }
+
+    return result;
+}
+
+/* getSet
+ *
+ * Returns the record of set 'index' in the flat tag store.
+ */
+
+static inline Set getSet(Cache cache, unsigned int index) {
+    return (Set) (cache->sets + (size_t) index * cache->set_stride);
+}
+
+/* setTags
+ *
+ * Returns the array of 'associativity' tags that follows a set header.
+ */
+
+static inline unsigned int *setTags(Set set) {
+    return (unsigned int *) (set + 1);
+}
+
+static inline uint64_t *setWideTags(Set set) {
+    return (uint64_t *) (set + 1);
+}
+
+/* setMeta
+ *
+ * Returns the replacement policy metadata that follows the tags.
+ */
+
+static inline unsigned char *setMeta(Cache cache, Set set) {
+    return (unsigned char *) (set + 1) + (size_t) cache->associativity * (cache->wide ? sizeof(uint64_t) : sizeof(unsigned int));
+}
+
+/* findTag / getTag / putTag
+ *
+ * Tag store access for the paths outside the access kernels, which
+ * handle either tag width at runtime. findTag returns the ways whose
+ * tag matches, valid or not.
+ */
+
+static inline unsigned int findTag(Cache cache, Set set, uint64_t tag) {
+
+    if(cache->wide) {
+        return matchTagsWide(setWideTags(set), cache->associativity, tag);
+    }
+
+    return matchTags(setTags(set), cache->associativity, (unsigned int) tag);
+}
+
+static inline uint64_t getTag(Cache cache, Set set, int j) {
+    return cache->wide ? setWideTags(set)[j] : setTags(set)[j];
+}
+
+static inline void putTag(Cache cache, Set set, int j, uint64_t tag) {
+
+    if(cache->wide) {
+        setWideTags(set)[j] = tag;
+    }
+    else {
+        setTags(set)[j] = (unsigned int) tag;
+    }
+}
+
+/* chooseWay
+ *
+ * Returns the way a miss fills: the lowest invalid way or, if every
+ * way is valid, the replacement policy's victim. Inlined so that a
+ * constant 'policy' leaves only that policy's code.
+ */
+
+static inline __attribute__((always_inline))
+int chooseWay(Cache cache, Set set, unsigned char *meta, const int ways, const int policy) {
+
+    unsigned int empty = ~set->valid & ((ways == 32) ? ~0u : (1u << ways) - 1);
+
+    if(empty != 0) {
+        return __builtin_ctz(empty);
+    }
+
+    return policyVictim(policy, meta, ways, &cache->policy_state);
+}
+
+/* getBinary
+ *
+ * Converts the low 'bits' bits of an unsigned integer into a binary
+ * string, most significant bit first. Used for whole addresses as well
+ * as the tag, index, and offset fields. The caller supplies the buffer,
+ * which must hold at least bits + 1 characters.
+ *
+ *
+ * @param   num         number to be converted
+ * @param   bits        # of bits to print
+ * @param   bstring     output buffer for the binary string
+ *
+ * @result  void
+ */
+ 
+void getBinary(uint64_t num, int bits, char *bstring) {
+
+    int i;
+    
+    /* Calculate the Binary String */
+    
+    bstring[bits] = '\0';
+    
+    for( i = 0; i < bits; i++ ) {
+        bstring[bits - 1 - i] = ((num >> i) & 1) ? '1' : '0';
+    }
+}
+
+/* formatBinary
+ *
+ * Converts a binary string to a formatted version for easier parsing.
+ * The format is determined by the bitsTag, bitsIndex, and bitsOffset
+ * of the cache. The caller supplies the buffer, which must hold at
+ * least address_size + 3 characters.
+ *
+ * Ex. Format:
+ *  -----------------------------------------------------
+ * | Tag: 18 bits | Index: 10 bits | Byte Select: 5 bits |
+ *  -----------------------------------------------------
+ *
+ * Ex. Result:
+ * 101010101010101010 1010101010 10101
+ *
+ * @param   cache       cache whose geometry sets the field widths
+ * @param   bstring     binary string to be converted
+ * @param   formatted   output buffer for the formatted string
+ *
+ * @result  void
+ */
+
+void formatBinary(Cache cache, const char *bstring, char *formatted) {
+
+    int bitsTag = cache->bitsTag;
+    int bitsIndex = cache->bitsIndex;
+    int bitsOffset = cache->bitsOffset;
+    int i;
+    
+    /* Format for Output */
+    
+    formatted[cache->address_size + 2] = '\0';
+    
+    for(i = 0; i < bitsTag; i++) {
+        formatted[i] = bstring[i];
+    }
+    
+    formatted[bitsTag] = ' ';
+    
+    for(i = bitsTag + 1; i < bitsIndex + bitsTag + 1; i++) {
+        formatted[i] = bstring[i - 1];
+    }
+    
+    formatted[bitsIndex + bitsTag + 1] = ' ';
+    
+    for(i = bitsIndex + bitsTag + 2; i < bitsOffset + bitsIndex + bitsTag + 2; i++) {
+        formatted[i] = bstring[i - 2];
+    }
+}
+
+/* parseMemoryAddress
+ *
+ * Helper function that splits a decoded memory address into
+ * its tag, index, and offset fields using the bitsTag, bitsIndex,
+ * and bitsOffset widths of the cache. Only shifts and masks are
+ * used, so there is no allocation or string handling on the access
+ * path. Address bits above address_size are ignored.
+ *
+ * @param       cache           Cache whose geometry sets the field widths
+ * @param       address         Decoded memory address
+ * @param       tag             Output: upper bitsTag bits
+ * @param       index           Output: middle bitsIndex bits (set number)
+ * @param       offset          Output: lower bitsOffset bits (byte select)
+ *
+ * @return      void
+ */
+
+void parseMemoryAddress(Cache cache, uint64_t address, uint64_t *tag, unsigned int *index, unsigned int *offset) {
+
+    *offset = (unsigned int) address & ((1u << cache->bitsOffset) - 1);
+    *index = (unsigned int) (address >> cache->bitsOffset) & cache->index_mask;
+    *tag = (address >> (cache->bitsOffset + cache->bitsIndex)) & cache->tag_mask;
+}
+
+/* printAddressTrace
+ *
+ * Prints the hex, decimal, binary, and formatted binary forms of
+ * an address along with its tag, index, and offset fields. The
+ * string forms are built on the stack here and only when the [-t]
+ * arg was specified.
+ *
+ * @param       cache           Cache whose geometry sets the field widths
+ * @param       address         Hexadecimal memory address as read from the trace
+ * @param       dec             Decoded memory address
+ *
+ * @return      void
+ */
+
+void printAddressTrace(Cache cache, const char *address, uint64_t dec) {
+
+    char bstring[MAX_ADDRESS_SIZE + 1];
+    char bformatted[MAX_ADDRESS_SIZE + 3];
+    char field[MAX_ADDRESS_SIZE + 1];
+    uint64_t tag;
+    unsigned int index, offset;
+
+    parseMemoryAddress(cache, dec, &tag, &index, &offset);
+
+    getBinary(dec, cache->address_size, bstring);
+    formatBinary(cache, bstring, bformatted);
+
+    printf("\tHex: %s\n", address);
+    printf("\tDecimal: %" PRIu64 "\n", dec);
+    printf("\tBinary: %s\n", bstring);
+    printf("\tFormatted: %s\n\n", bformatted);
+
+    getBinary(tag, cache->bitsTag, field);
+    printf("\tTag: %s (%" PRIu64 ")\n", field, tag);
+    getBinary(index, cache->bitsIndex, field);
+    printf("\tIndex: %s (%u)\n", field, index);
+    getBinary(offset, cache->bitsOffset, field);
+    printf("\tOffset: %s (%u)\n\n", field, offset);
+}
+
+/* parseCount
+ *
+ * Parses a positive decimal command line value. Returns -1 if the
+ * string is not a whole number greater than 0.
+ *
+ * @param       str             Command line argument
+ *
+ * @return      success         parsed value
+ * @return      failure         -1
+ */
+
+int parseCount(const char *str) {
+
+    char *end;
+    long value;
+
+    value = strtol(str, &end, 10);
+
+    if(end == str || *end != '\0' || value <= 0 || value > 0x7fffffff) {
+        return -1;
+    }
+
+    return (int) value;
+}
+
+/* parseRange
+ *
+ * Parses a command line range, FIRST:LAST or a single N (= N:N), of
+ * unsigned decimal values. Returns -1 if the string is malformed or
+ * FIRST > LAST.
+ *
+ * @param       str             Command line argument
+ * @param       first           Output: first value
+ * @param       last            Output: last value
+ *
+ * @return      success         0
+ * @return      failure         -1
+ */
+
+int parseRange(const char *str, uint64_t *first, uint64_t *last) {
+
+    char *end;
+
+    if(!isdigit((unsigned char) *str)) {
+        return -1;
+    }
+
+    *first = strtoull(str, &end, 10);
+    *last = *first;
+
+    if(*end == ':') {
+
+        str = end + 1;
+
+        if(!isdigit((unsigned char) *str)) {
+            return -1;
+        }
+
+        *last = strtoull(str, &end, 10);
+    }
+
+    return (*end == '\0' && *first <= *last) ? 0 : -1;
+}
+
+#ifndef CACHESIM_LIBRARY
+
+/* printVersion
+ *
+ * Prints the version header for the [-v] arg.
+ */
+
+static void printVersion(void) {
+
+	printf("\n\n************************ CacheSim v1.0 ************************\n");
+	printf("************************* Rehan Iqbal *************************\n");
+	printf("************************* PSU ECE 586 *************************\n");
+}
+
+#endif
+
+/* parseLevel
+ *
+ * Parses a -level argument, SETS:WAYS:BLOCK:LATENCY followed by an
+ * optional inclusion policy and replacement policy in either order.
+ * The replacement policy is left at -1 when none is given. Returns -1
+ * if the argument is malformed.
+ *
+ * @param       str             Command line argument
+ * @param       level           Output: parsed level
+ *
+ * @return      success         0
+ * @return      failure         -1
+ */
+
+int parseLevel(const char *str, LevelConfig *level) {
+
+    char name[32];
+    int used = 0;
+
+    if(sscanf(str, "%d:%d:%d:%d%n", &level->number_of_sets, &level->associativity, &level->block_size, &level->latency, &used) != 4) {
+        return -1;
+    }
+
+    level->inclusion = INCLUSION_NINE;
+    level->policy = -1;
+    str += used;
+
+    while(*str == ':') {
+
+        str++;
+        used = (int) strcspn(str, ":");
+
+        if(used == 0 || used >= (int) sizeof(name)) {
+            return -1;
+        }
+
+        memcpy(name, str, used);
+        name[used] = '\0';
+        str += used;
+
+        if(parseInclusion(name) >= 0) {
+            level->inclusion = parseInclusion(name);
+        }
+        else if(parsePolicy(name) >= 0) {
+            level->policy = parsePolicy(name);
+        }
+        else {
+            return -1;
+        }
+    }
+
+    return (*str == '\0') ? 0 : -1;
+}
+
+/* The command line program: everything from here to section 5 is left
+ * out when the simulator is built as a library (see CacheLib.h) */
+
+#ifndef CACHESIM_LIBRARY
+
+/* simulateAccess
+ *
+ * Hands one decoded access to whichever mode is running: the sweep,
+ * the shard workers, the stack distance analysis, the hierarchy, or
+ * the single cache.
+ * The hex string is only needed for [-t] output and may be NULL.
+ *
+ * @param       cache           single cache (when no other mode runs)
+ * @param       sweep           sweep, or NULL
+ * @param       shard           shard, or NULL
+ * @param       sd              stack distance analysis, or NULL
+ * @param       hierarchy       cache hierarchy, or NULL
+ * @param       address         hexadecimal address as read, or NULL
+ * @param       dec             decoded memory address
+ * @param       write           0 = read, 1 = write
+ * @param       counter         # of accesses before this one
+ *
+ * @return      void
+ */
+
+static void simulateAccess(Cache cache, Sweep sweep, Shard shard, StackDist sd, Hierarchy hierarchy, char *address, uint64_t dec, int write, long long counter) {
+
+	/* sweep mode: decode once, every configuration replays it */
+	if(sweep != NULL) {
+		sweepAccess(sweep, dec, write);
+	}
+
+	/* sharded mode: the worker that owns the set simulates it */
+	else if(shard != NULL) {
+		shardAccess(shard, dec, write, counter + 1);
+	}
+
+	/* miss ratio curve mode: only the stack distance matters */
+	else if(sd != NULL) {
+		stackDistAccess(sd, dec);
+	}
+
+	/* hierarchy mode: L1 first, then down to memory */
+	else if(hierarchy != NULL) {
+		hierarchyAccess(hierarchy, dec, write);
+	}
+
+	/* [-t] output needs the address as it appeared in the trace */
+	else if(address != NULL) {
+		if(write) {
+			writeToCache(cache, address);
+		}
+		else {
+			readFromCache(cache, address);
+		}
+	}
+
+	else {
+		accessCache(cache, dec, write);
+	}
+}
+
+/* printEvent
+ *
+ * Renders one event of an event log as the [-t] arg prints an access,
+ * followed by the victim and the cycles the access took.
+ *
+ * @param       cache           Cache with the log's geometry
+ * @param       event           event to print
+ *
+ * @return      void
+ */
+
+static void printEvent(Cache cache, const EventRecord *event) {
+
+    char address[TEXTTRACE_TOKEN];
+    char field[MAX_ADDRESS_SIZE + 1];
+    uint64_t dec, block;
+    int write = (event->flags & EVENT_WRITE) != 0;
+
+    block = (event->tag << (cache->bitsOffset + cache->bitsIndex)) | ((uint64_t) event->set << cache->bitsOffset);
+    dec = block | event->offset;
+    sprintf(address, "0x%08" PRIx64, dec);
+
+    printf("\nAccess %" PRIu64 ": Mode %c -- Address %s\n\n", event->access, write ? 'w' : 'r', address);
+    printAddressTrace(cache, address, dec);
+    printf("\tAttempting to %s data %s cache slot %u.\n", write ? "write" : "read", write ? "to" : "from", event->set);
+
+    if(event->flags & EVENT_HIT) {
+
+        if(event->flags & EVENT_THROUGH) {
+            printf("\tWrite-through of block 0x%08" PRIx64 " to memory.\n", block);
+        }
+
+        printf("\tCache hit on Way %d. Block timestamp updated to %" PRIu64 ".\n", event->way, event->access);
+    }
+    else if(event->flags & EVENT_BYPASS) {
+        printf("\tCache miss - write of block 0x%08" PRIx64 " sent to memory without allocating.\n", block);
+    }
+    else {
+
+        if(event->flags & EVENT_SIDE) {
+            printf("\tCache miss - block 0x%08" PRIx64 " found in the victim or miss cache.\n", block);
+        }
+        else if(event->flags & EVENT_STREAM) {
+            printf("\tCache miss - block 0x%08" PRIx64 " taken from the stream buffer.\n", block);
+        }
+
+        printf("\tCache miss - eviction on Way %d. Block timestamp updated to %" PRIu64 ".\n", event->way, event->access);
+
+        if(event->flags & EVENT_EVICT) {
+            getBinary(event->victim, cache->bitsTag, field);
+            printf("\tEvicted tag: %s (%" PRIu64 ")%s\n", field, event->victim, (event->flags & EVENT_WRITEBACK) ? ", dirty" : "");
+        }
+    }
+
+    printf("\tCycles: %u\n", event->cycles);
+}
+
+/* decodeEventLog
+ *
+ * Prints every event of an event log, for the decode subcommand.
+ *
+ * @param       path            event log location
+ *
+ * @return      success         0
+ * @return      failure         -1
+ */
+
+static int decodeEventLog(const char *path) {
+
+    EventLogReader reader;
+    EventLogInfo info;
+    EventRecord event;
+    Cache cache;
+    int n;
+
+    reader = openEventLog(path, &info);
+
+    if(reader == NULL) {
+        return -1;
+    }
+
+    /* only the geometry matters, for the address fields */
+
+    cache = createCache(info.number_of_sets, info.associativity, info.block_size, info.address_size, POLICY_LRU, 1);
+
+    if(cache == NULL) {
+        closeEventLogReader(reader);
+        return -1;
+    }
+
+    while((n = readEventLog(reader, &event)) > 0) {
+        printEvent(cache, &event);
+    }
+
+    destroyCache(cache);
+    closeEventLogReader(reader);
+
+    return (n < 0) ? -1 : 0;
+}
+
+/* Options that take part in the compatibility rules below, in the
+ * order of optionNames */
+
+enum {
+    OPT_T, OPT_D, OPT_CONFIG, OPT_MRC, OPT_SHARDS, OPT_LEVEL, OPT_CORE, OPT_PROTOCOL,
+    OPT_WRITE_THROUGH, OPT_NO_WRITE_ALLOCATE, OPT_WRITE_BUFFER, OPT_MSHRS, OPT_PREFETCH,
+    OPT_VICTIM_CACHE, OPT_MISS_CACHE, OPT_3C, OPT_LOG, OPT_LOG_SETS, OPT_LOG_TAG, OPT_LOG_ACCESSES,
+    OPT_INTERVAL, OPT_INTERVAL_CYCLES, OPT_INTERVAL_FILE, OPT_HEATMAP, OPT_CHECKPOINT,
+    OPT_CHECKPOINT_AT, OPT_WARM, OPT_RESUME, OPT_SAMPLE_SETS, OPTION_COUNT
+};
+
+static const char *const optionNames[OPTION_COUNT] = {
+    "-t", "-d", "-config", "-mrc", "-shards", "-level", "-core", "-protocol", "-write-through",
+    "-no-write-allocate", "-write-buffer", "-mshrs", "-prefetch", "-victim-cache", "-miss-cache",
+    "-3c", "-log", "-log-sets", "-log-tag", "-log-accesses", "-interval", "-interval-cycles",
+    "-interval-file", "-heatmap", "-checkpoint", "-checkpoint-at", "-warm", "-resume",
+    "-sample-sets",
+};
+
+#define OPT(x) (1ull << OPT_##x)
+
+// the modes that replace the single cache on one thread
+
+#define OTHER_THREADS (OPT(SHARDS) | OPT(MRC) | OPT(LEVEL) | OPT(CORE) | OPT(PROTOCOL))
+#define OTHER_CACHES (OPT(CONFIG) | OTHER_THREADS)
+
+// the state a cache keeps beside its sets
+
+#define SIDE_STATE (OPT(WRITE_BUFFER) | OPT(MSHRS) | OPT(PREFETCH) | OPT(VICTIM_CACHE) | OPT(MISS_CACHE) | OPT(3C))
+
+/* optionRules
+ *
+ * For each option, the options it cannot be combined with and the
+ * options of which it needs at least one (0 for none).
+ */
+
+static const struct {
+    int option;
+    unsigned long long excludes;
+    unsigned long long needs;
+} optionRules[] = {
+
+    /* per-access trace output is only meaningful for a single cache */
+    { OPT_T, OPT(CONFIG), 0 },
+
+    /* the stack distance analysis replaces every cache */
+    { OPT_MRC, OPT(CONFIG) | OPT(T) | OPT(D), 0 },
+
+    /* the shards split one cache */
+    { OPT_SHARDS, OPT(CONFIG) | OPT(MRC) | OPT(T), 0 },
+
+    /* a hierarchy, or one cache per core, takes the place of the single cache */
+    { OPT_LEVEL, OPT(CONFIG) | OPT(SHARDS) | OPT(MRC) | OPT(T), 0 },
+
+    { OPT_CORE, OPT(CONFIG) | OPT(SHARDS) | OPT(MRC) | OPT(LEVEL) | OPT(T), 0 },
+    { OPT_PROTOCOL, OPT(CONFIG) | OPT(SHARDS) | OPT(MRC) | OPT(LEVEL) | OPT(T), 0 },
+
+    /* write policies apply to the single cache and the sweep; the shards
+     * of a cache cannot share one write buffer */
+    { OPT_WRITE_THROUGH, OPT(MRC) | OPT(LEVEL) | OPT(CORE) | OPT(PROTOCOL), 0 },
+    { OPT_NO_WRITE_ALLOCATE, OPT(MRC) | OPT(LEVEL) | OPT(CORE) | OPT(PROTOCOL), 0 },
+    { OPT_WRITE_BUFFER, OTHER_THREADS, 0 },
+
+    /* the non-blocking model times one cache's accesses in order */
+    { OPT_MSHRS, OTHER_THREADS, 0 },
+
+    /* prefetches fill other sets than the access, so they need the
+     * whole cache on one thread */
+    { OPT_PREFETCH, OTHER_THREADS, 0 },
+
+    /* the victim or miss cache is shared by every set */
+    { OPT_VICTIM_CACHE, OPT(MISS_CACHE) | OTHER_THREADS, 0 },
+    { OPT_MISS_CACHE, OTHER_THREADS, 0 },
+
+    /* the classifier follows the whole cache */
+    { OPT_3C, OTHER_THREADS, 0 },
+
+    /* the event log follows one cache through the trace */
+    { OPT_LOG, OTHER_CACHES, 0 },
+    { OPT_LOG_SETS, 0, OPT(LOG) },
+    { OPT_LOG_TAG, 0, OPT(LOG) },
+    { OPT_LOG_ACCESSES, 0, OPT(LOG) },
+
+    /* interval statistics follow one cache's counters through the trace */
+    { OPT_INTERVAL, OPT(INTERVAL_CYCLES) | OTHER_CACHES, 0 },
+    { OPT_INTERVAL_CYCLES, OTHER_CACHES, 0 },
+    { OPT_INTERVAL_FILE, 0, OPT(INTERVAL) | OPT(INTERVAL_CYCLES) },
+
+    /* shards share their parent's set counters, since they own disjoint sets */
+    { OPT_HEATMAP, OPT(MRC) | OPT(LEVEL) | OPT(CORE) | OPT(PROTOCOL), 0 },
+
+    /* a checkpoint holds one cache's sets, replacement state, and
+     * counters, and nothing that lives beside them */
+    { OPT_CHECKPOINT, OTHER_CACHES | SIDE_STATE, 0 },
+    { OPT_CHECKPOINT_AT, 0, OPT(CHECKPOINT) },
+    { OPT_WARM, OPT(RESUME) | OTHER_CACHES | SIDE_STATE, 0 },
+    { OPT_RESUME, OTHER_CACHES | SIDE_STATE, 0 },
+
+    /* set sampling estimates one cache from its sampled sets alone, so
+     * nothing may carry state from one set to another */
+    { OPT_SAMPLE_SETS, OTHER_CACHES | SIDE_STATE | OPT(CHECKPOINT) | OPT(WARM) | OPT(RESUME), 0 },
+};
+
+/* optionBit
+ *
+ * Returns the rule bit of a command line option, or 0 for an option
+ * no rule mentions.
+ *
+ * @param       name            option as given, e.g. "-shards"
+ *
+ * @return      bit             OPT(...) of the option, or 0
+ */
+
+static unsigned long long optionBit(const char *name) {
+
+    int i;
+
+    for(i = 0; i < OPTION_COUNT; i++) {
+        if(strcmp(name, optionNames[i]) == 0) {
+            return 1ull << i;
+        }
+    }
+
+    return 0;
+}
+
+/* checkOptions
+ *
+ * Checks the options given against optionRules, and the replacement
+ * policy against the modes that cannot run it. Prints the first
+ * conflict found.
+ *
+ * @param       given           OPT(...) bits of the options given
+ * @param       policy          replacement policy (POLICY_*)
+ *
+ * @return      success         0
+ * @return      failure         -1
+ */
+
+static int checkOptions(unsigned long long given, int policy) {
+
+    unsigned long long conflict;
+    const char *separator;
+    size_t r;
+    int i;
+
+    for(r = 0; r < sizeof(optionRules) / sizeof(optionRules[0]); r++) {
+
+        if(!(given & (1ull << optionRules[r].option))) {
+            continue;
+        }
+
+        conflict = given & optionRules[r].excludes;
+
+        if(conflict != 0) {
+            fprintf(stderr, "\nIncorrect arguments: %s cannot be combined with %s\n\n", optionNames[optionRules[r].option], optionNames[__builtin_ctzll(conflict)]);
+            return -1;
+        }
+
+        if(optionRules[r].needs != 0 && !(given & optionRules[r].needs)) {
+
+            fprintf(stderr, "\nIncorrect arguments: %s needs ", optionNames[optionRules[r].option]);
+            separator = "";
+
+            for(i = 0; i < OPTION_COUNT; i++) {
+                if(optionRules[r].needs & (1ull << i)) {
+                    fprintf(stderr, "%s%s", separator, optionNames[i]);
+                    separator = " or ";
+                }
+            }
+
+            fprintf(stderr, "\n\n");
+            return -1;
+        }
+    }
+
+    /* Sets can only be split across threads if nothing is shared
+     * between them, such as a random stream or DRRIP's selector */
+
+    if((given & OPT(SHARDS)) && !policyIsSetLocal(policy)) {
+        fprintf(stderr, "\nIncorrect arguments: -shards needs a policy without cache-wide state (lru, plru, fifo, srrip)\n\n");
+        return -1;
+    }
+
+    if((given & OPT(MRC)) && policy != POLICY_LRU) {
+        fprintf(stderr, "\nIncorrect arguments: -mrc computes LRU curves only\n\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+/********************************
+ *        4. Main Function      *
+ ********************************/
+ 
+/*
+ * Algorithm:
+ *
+ *  1. Validate input arguments
+ *  2. Open the trace file for reading
+ *  3. Create a new Cache object (one per -config in sweep mode)
+ *  4. Decode a batch of accesses from the file
+ *  5. Read or write each access accordingly
+ *  6. If the file is not done, go back to step 4
+ *  7. Print the results
+ *  8. Destroy the Cache object(s)
+ *  9. Close the file
+ *
+ * In sweep mode (one or more -config args) each access is decoded once
+ * and handed to worker threads that replay it into every configuration.
+ * In miss ratio curve mode (-mrc) no cache is simulated; every access
+ * feeds the stack distance analysis instead. In sharded mode (-shards)
+ * the single cache's sets are split across worker threads, and each
+ * access is routed to the worker that owns its set. In hierarchy mode
+ * (one or more -level args) each access runs through L1, L2, ... and
+ * memory, and the output is per level.
+ *
+ * A binary trace (see BinTrace.h) is recognized by its header and is
+ * decoded in batches from a memory mapping instead of line by line.
+ * "./CacheSim convert <text trace> <binary trace>" writes one. Either
+ * kind is decoded ahead on a reader thread (see TraceReader.h), which
+ * also lets a text trace stream in from stdin or a pipe.
+ *
+ * With -log every access of the single cache is recorded in a binary
+ * event log (see EventLog.h) by a writer thread;
+ * "./CacheSim decode <event log>" prints it as -t would.
+ */
+
+int main(int argc, char **argv) {
+
+	long long counter;
+	int i, j;
+    int number_of_sets = DEFAULT_NUMBER_OF_SETS;
+    int associativity = DEFAULT_ASSOCIATIVITY;
+    int block_size = DEFAULT_BLOCK_SIZE;
+    int address_size = DEFAULT_ADDRESS_SIZE;
+    int threads = 0;
+    int shards = 0;
+    int mrc_ways = 0;
+    int policy = POLICY_LRU;
+    int seed = 1;
+    int write_policy = WRITE_BACK;
+    int buffer_entries = 0;
+    int mshrs = 0;
+    int prefetcher = -1;
+    int prefetch_degree = DEFAULT_PREFETCH_DEGREE;
+    int victim_entries = 0;
+    int miss_entries = 0;
+    bool classify = false;
+    const char *log_path = NULL;
+    EventFilter filter;
+    EventLogInfo log_info;
+    EventLog log = NULL;
+    uint64_t first, last;
+    int interval = 0;
+    int interval_cycles = 0;
+    const char *interval_path = NULL;
+    int heatmap = 0;
+    const char *checkpoint_path = NULL;
+    int checkpoint_at = 0;
+    bool checkpointed = false;
+    const char *restore_path = NULL;
+    bool resume = false;
+    unsigned long long trace_offset = 0;
+    int sample_ratio = 0;
+    unsigned long long given = 0;
+    int *option;
+    int (*configs)[4] = NULL;
+    int used;
+    int config_count = 0;
+    LevelConfig *levels = NULL;
+    int level_count = 0;
+    int memory_latency = DEFAULT_MEMORY_LATENCY;
+    const char **cores = NULL;
+    int core_count = 1;
+    int protocol = -1;
+    int quantum = DEFAULT_QUANTUM;
+    Coherence coherence = NULL;
+    int cache_count = 0;
+    Cache *caches = NULL;
+    Cache cache;
+    Sweep sweep = NULL;
+    Shard shard = NULL;
+    StackDist sd = NULL;
+    Hierarchy hierarchy = NULL;
+    TraceReader reader = NULL;
+    uint64_t *decoded = NULL;
+    unsigned char *decoded_writes = NULL;
+    const char *token;
+    long converted;
+    int n;
+    int status = -1;
+    char mode, address[TEXTTRACE_TOKEN];
+
+    /* Help Menu
+     *
+     * If the help flag is present or there is not the correct # of args,
+     * print the usage menu and return.
+     *
+     * There must be at least 2 args (./CacheSim and <file location>).
+     */
+     
+    if(argc < 2 || strcmp(argv[1], "-h") == 0) {
+        fprintf(stderr, "Usage: %s\n       %s\n       %s\n\n", USAGE, CONVERT_USAGE, DECODE_USAGE);
+        return -1;
+    }
+
+    /* Convert subcommand: text trace in, binary trace out */
+
+    if(strcmp(argv[1], "convert") == 0) {
+
+    	if(argc != 4) {
+    		fprintf(stderr, "\nIncorrect arguments: %s\n\n", CONVERT_USAGE);
+    		return -1;
+    	}
+
+    	converted = convertTrace(argv[2], argv[3]);
+
+    	if(converted < 0) {
+    		return -1;
+    	}
+
+    	printf("Converted %ld accesses from %s to %s.\n", converted, argv[2], argv[3]);
+    	return 0;
+    }
+
+    /* Decode subcommand: event log in, [-t] text out */
+
+    if(strcmp(argv[1], "decode") == 0) {
+
+    	if(argc != 3) {
+    		fprintf(stderr, "\nIncorrect arguments: %s\n\n", DECODE_USAGE);
+    		return -1;
+    	}
+
+    	return decodeEventLog(argv[2]);
+    }
+    
+    /* Check if there's more than two arguments
+     * If so, use if-else statements to set the appropriate flags
+     * and geometry options. Unrecognized args will terminate the
+     * program with an error message
+     */
+
+    initEventFilter(&filter);
+
+    for (i = 2; i < argc; i++) {
+
+    	option = NULL;
+    	given |= optionBit(argv[i]);
+
+    	if (strcmp(argv[i], "-v") == 0) {
+    		VERSION_DEBUG = true;
+    	}
+    	else if (strcmp(argv[i], "-t") == 0) {
+    		TRACE_DEBUG = true;
+    	}
+    	else if (strcmp(argv[i], "-d") == 0) {
+    		DUMP_DEBUG = true;
+    	}
+    	else if (strcmp(argv[i], "-3c") == 0) {
+    		classify = true;
+    	}
+    	else if (strcmp(argv[i], "-sets") == 0) {
+    		option = &number_of_sets;
+    	}
+    	else if (strcmp(argv[i], "-ways") == 0) {
+    		option = &associativity;
+    	}
+    	else if (strcmp(argv[i], "-block") == 0) {
+    		option = &block_size;
+    	}
+    	else if (strcmp(argv[i], "-addr") == 0) {
+    		option = &address_size;
+    	}
+    	else if (strcmp(argv[i], "-threads") == 0) {
+    		option = &threads;
+    	}
+    	else if (strcmp(argv[i], "-shards") == 0) {
+    		option = &shards;
+    	}
+    	else if (strcmp(argv[i], "-mrc") == 0) {
+    		option = &mrc_ways;
+    	}
+    	else if (strcmp(argv[i], "-seed") == 0) {
+    		option = &seed;
+    	}
+    	else if (strcmp(argv[i], "-memory") == 0) {
+    		option = &memory_latency;
+    	}
+    	else if (strcmp(argv[i], "-quantum") == 0) {
+    		option = &quantum;
+    	}
+    	else if (strcmp(argv[i], "-write-buffer") == 0) {
+    		option = &buffer_entries;
+    	}
+    	else if (strcmp(argv[i], "-mshrs") == 0) {
+    		option = &mshrs;
+    	}
+    	else if (strcmp(argv[i], "-prefetch-degree") == 0) {
+    		option = &prefetch_degree;
+    	}
+    	else if (strcmp(argv[i], "-victim-cache") == 0) {
+    		option = &victim_entries;
+    	}
+    	else if (strcmp(argv[i], "-miss-cache") == 0) {
+    		option = &miss_entries;
+    	}
+    	else if (strcmp(argv[i], "-interval") == 0) {
+    		option = &interval;
+    	}
+    	else if (strcmp(argv[i], "-interval-cycles") == 0) {
+    		option = &interval_cycles;
+    	}
+    	else if (strcmp(argv[i], "-heatmap") == 0) {
+    		option = &heatmap;
+    	}
+    	else if (strcmp(argv[i], "-sample-sets") == 0) {
+    		option = &sample_ratio;
+    	}
+    	else if (strcmp(argv[i], "-checkpoint-at") == 0) {
+    		option = &checkpoint_at;
+    	}
+    	else if (strcmp(argv[i], "-checkpoint") == 0 || strcmp(argv[i], "-warm") == 0 || strcmp(argv[i], "-resume") == 0) {
+
+    		if (i + 1 >= argc) {
+    			fprintf(stderr, "\nIncorrect arguments: %s needs a checkpoint file\n\n", argv[i]);
+    			goto cleanup;
+    		}
+
+    		if (argv[i][1] == 'c') {
+    			checkpoint_path = argv[++i];
+    		}
+    		else {
+    			resume = argv[i][1] == 'r';
+    			restore_path = argv[++i];
+    		}
+    	}
+    	else if (strcmp(argv[i], "-interval-file") == 0) {
+
+    		if (i + 1 >= argc) {
+    			fprintf(stderr, "\nIncorrect arguments: -interval-file needs an output file\n\n");
+    			goto cleanup;
+    		}
+
+    		interval_path = argv[++i];
+    	}
+    	else if (strcmp(argv[i], "-prefetch") == 0) {
+
+    		if (i + 1 >= argc || (prefetcher = parsePrefetcher(argv[i + 1])) < 0) {
+    			fprintf(stderr, "\nIncorrect arguments: -prefetch needs one of next-line, stride, stream\n\n");
+    			goto cleanup;
+    		}
+
+    		i++;
+    	}
+    	else if (strcmp(argv[i], "-log") == 0) {
+
+    		if (i + 1 >= argc) {
+    			fprintf(stderr, "\nIncorrect arguments: -log needs an output file\n\n");
+    			goto cleanup;
+    		}
+
+    		log_path = argv[++i];
+    	}
+    	else if (strcmp(argv[i], "-log-sets") == 0 || strcmp(argv[i], "-log-accesses") == 0) {
+
+    		if (i + 1 >= argc || parseRange(argv[i + 1], &first, &last) != 0 || (argv[i][5] == 's' && last > UINT32_MAX)) {
+    			fprintf(stderr, "\nIncorrect arguments: %s needs FIRST[:LAST]\n\n", argv[i]);
+    			goto cleanup;
+    		}
+
+    		if (argv[i][5] == 's') {
+    			filter.first_set = (uint32_t) first;
+    			filter.last_set = (uint32_t) last;
+    		}
+    		else {
+    			filter.first_access = first;
+    			filter.last_access = last;
+    		}
+
+    		i++;
+    	}
+    	else if (strcmp(argv[i], "-log-tag") == 0) {
+
+    		if (i + 1 >= argc || !isxdigit((unsigned char) argv[i + 1][0])) {
+    			fprintf(stderr, "\nIncorrect arguments: -log-tag needs a tag\n\n");
+    			goto cleanup;
+    		}
+
+    		filter.match_tag = 1;
+    		filter.tag = htoi(argv[++i]);
+    	}
+    	else if (strcmp(argv[i], "-write-through") == 0) {
+    		write_policy |= WRITE_THROUGH;
+    	}
+    	else if (strcmp(argv[i], "-no-write-allocate") == 0) {
+    		write_policy |= WRITE_NO_ALLOCATE;
+    	}
+    	else if (strcmp(argv[i], "-core") == 0) {
+
+    		/* the trace file is core 0; each -core adds the next core */
+
+    		if (i + 1 >= argc) {
+    			fprintf(stderr, "\nIncorrect arguments: -core needs a trace file\n\n");
+    			goto cleanup;
+    		}
+
+    		cores = realloc(cores, sizeof(*cores) * (core_count + 1));
+    		assert(cores != NULL);
+
+    		cores[0] = argv[1];
+    		cores[core_count++] = argv[++i];
+
+    		if (protocol < 0) {
+    			protocol = PROTOCOL_MESI;
+    		}
+    	}
+    	else if (strcmp(argv[i], "-protocol") == 0) {
+
+    		if (i + 1 >= argc || (protocol = parseProtocol(argv[i + 1])) < 0) {
+    			fprintf(stderr, "\nIncorrect arguments: -protocol needs mesi or moesi\n\n");
+    			goto cleanup;
+    		}
+
+    		i++;
+    	}
+    	else if (strcmp(argv[i], "-level") == 0) {
+
+    		/* each -level adds the next level down, L1 first */
+
+    		levels = realloc(levels, sizeof(*levels) * (level_count + 1));
+    		assert(levels != NULL);
+
+    		if (i + 1 >= argc || parseLevel(argv[i + 1], &levels[level_count]) != 0) {
+    			fprintf(stderr, "\nIncorrect arguments: -level needs SETS:WAYS:BLOCK:LATENCY[:INCLUSION][:POLICY]\n\n");
+    			goto cleanup;
+    		}
+
+    		level_count++;
+    		i++;
+    	}
+    	else if (strcmp(argv[i], "-policy") == 0) {
+
+    		if (i + 1 >= argc || (policy = parsePolicy(argv[i + 1])) < 0) {
+    			fprintf(stderr, "\nIncorrect arguments: -policy needs one of lru, plru, fifo, random, srrip, brrip, drrip\n\n");
+    			goto cleanup;
+    		}
+
+    		i++;
+    	}
+    	else if (strcmp(argv[i], "-config") == 0) {
+
+    		/* each -config adds one SETS:WAYS:BLOCK[:POLICY] configuration;
+    		 * without a policy it uses -policy (LRU by default) */
+
+    		configs = realloc(configs, sizeof(*configs) * (config_count + 1));
+    		assert(configs != NULL);
+
+    		used = 0;
+    		j = (i + 1 < argc) ? sscanf(argv[i + 1], "%d:%d:%d%n", &configs[config_count][0], &configs[config_count][1], &configs[config_count][2], &used) : 0;
+    		configs[config_count][3] = -1;
+
+    		if (j == 3 && argv[i + 1][used] == ':') {
+    			configs[config_count][3] = parsePolicy(argv[i + 1] + used + 1);
+    		}
+
+    		if (j != 3 || (argv[i + 1][used] != '\0' && configs[config_count][3] < 0)) {
+    			fprintf(stderr, "\nIncorrect arguments: -config needs SETS:WAYS:BLOCK[:POLICY]\n\n");
+    			goto cleanup;
+    		}
+
+    		config_count++;
+    		i++;
+    	}
+    	else {
+    		fprintf(stderr, "\nIncorrect arguments: %s\n\n", USAGE);
+    		goto cleanup;
+    	}
+
+    	/* numeric options take a positive number as the next arg */
+
+    	if (option != NULL) {
+
+    		if (i + 1 >= argc || (*option = parseCount(argv[i + 1])) < 0) {
+    			fprintf(stderr, "\nIncorrect arguments: %s needs a positive number\n\n", argv[i]);
+    			goto cleanup;
+    		}
+
+    		i++;
+    	}
+    }
+
+    /* Options that cannot run together, or need another one */
+
+    if (checkOptions(given, policy) != 0) {
+    	goto cleanup;
+    }
+
+    /* pick the tag match kernels for this CPU */
+
+    initTagMatch();
+
+    /* Every core reads its own trace on its own thread; the bus runs
+     * here, so there is nothing more to set up */
+
+    if (protocol >= 0) {
+
+    	coherence = createCoherence((cores != NULL) ? cores : (const char **) &argv[1], core_count, number_of_sets, associativity,
+    	                            block_size, address_size, policy, (unsigned int) seed, protocol, quantum);
+
+    	if (coherence == NULL) {
+    		goto cleanup;
+    	}
+
+    	if (VERSION_DEBUG) {
+    		printVersion();
+    	}
+
+    	if (runCoherence(coherence) != 0) {
+    		goto cleanup;
+    	}
+
+    	printCoherence(coherence, DUMP_DEBUG);
+    	status = 0;
+    	goto cleanup;
+    }
+
+    /* Call createCache function, which validates the geometry,
+     * allocates memory & returns pointer to Cache object.
+     * Without -config there is a single cache from -sets/-ways/-block,
+     * and with -mrc there is none: sets 1 .. -sets are analyzed at once.
+     * A hierarchy creates its own caches, one per -level */
+
+    cache_count = (config_count > 0) ? config_count : (mrc_ways > 0 || level_count > 0) ? 0 : 1;
+    caches = (Cache*) calloc(cache_count + 1, sizeof(Cache));
+    assert(caches != NULL);
+
+    for (i = 0; i < cache_count; i++) {
+
+    	if (config_count > 0) {
+    		caches[i] = createCache(configs[i][0], configs[i][1], configs[i][2], address_size, (configs[i][3] >= 0) ? configs[i][3] : policy, (unsigned int) seed);
+    	}
+    	else {
+    		caches[i] = createCache(number_of_sets, associativity, block_size, address_size, policy, (unsigned int) seed);
+    	}
+
+    	if (caches[i] != NULL && (setWritePolicy(caches[i], write_policy, buffer_entries) != 0 ||
+    	                          (restore_path != NULL && restoreCache(caches[i], restore_path, resume, &trace_offset) != 0) ||
+    	                          (mshrs > 0 && setMshrs(caches[i], mshrs) != 0) ||
+    	                          (prefetcher >= 0 && setPrefetcher(caches[i], prefetcher, prefetch_degree) != 0) ||
+    	                          (victim_entries > 0 && setVictimCache(caches[i], VICTIM_CACHE, victim_entries) != 0) ||
+    	                          (miss_entries > 0 && setVictimCache(caches[i], MISS_CACHE, miss_entries) != 0) ||
+    	                          (classify && setMissClass(caches[i]) != 0) ||
+    	                          (interval > 0 && setInterval(caches[i], interval_path, interval, 0) != 0) ||
+    	                          (interval_cycles > 0 && setInterval(caches[i], interval_path, interval_cycles, 1) != 0) ||
+    	                          (heatmap > 0 && setHeatmap(caches[i], heatmap) != 0) ||
+    	                          (sample_ratio > 0 && setSampling(caches[i], sample_ratio) != 0))) {
+    		destroyCache(caches[i]);
+    		caches[i] = NULL;
+    	}
+
+    	if (caches[i] == NULL) {
+    		goto cleanup;
+    	}
+    }
+
+    cache = caches[0];
+
+    /* The event log is written on its own thread while the cache runs */
+
+    if (log_path != NULL) {
+
+    	log_info.address_size = address_size;
+    	log_info.number_of_sets = number_of_sets;
+    	log_info.associativity = associativity;
+    	log_info.block_size = block_size;
+    	log_info.events = 0;
+
+    	log = createEventLog(log_path, &log_info, &filter);
+
+    	if (log == NULL) {
+    		goto cleanup;
+    	}
+
+    	setEventLog(cache, log);
+    }
+
+    if (mrc_ways > 0) {
+
+    	sd = createStackDist(number_of_sets, mrc_ways, block_size, address_size);
+
+    	if (sd == NULL) {
+    		goto cleanup;
+    	}
+    }
+
+    if (level_count > 0) {
+
+    	/* levels without a policy of their own use -policy */
+
+    	for (i = 0; i < level_count; i++) {
+    		if (levels[i].policy < 0) {
+    			levels[i].policy = policy;
+    		}
+    	}
+
+    	hierarchy = createHierarchy(levels, level_count, memory_latency, address_size, (unsigned int) seed);
+
+    	if (hierarchy == NULL) {
+    		goto cleanup;
+    	}
+    }
+
+    /* Open the file (or "-" for stdin) for reading: binary traces are
+     * mapped, text traces are streamed through a large buffer. Without
+     * [-t] a reader thread decodes ahead while the accesses run */
+
+    reader = openTraceReader(argv[1], !TRACE_DEBUG);
+
+    if( reader == NULL ) {
+        goto cleanup;
+    }
+
+    /* Start the sweep workers */
+
+    if (config_count > 0) {
+
+    	if (threads == 0) {
+    		threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    	}
+
+    	sweep = createSweep(caches, cache_count, threads);
+
+    	if (sweep == NULL) {
+    		goto cleanup;
+    	}
+    }
+
+    /* Start the set-sharded workers for the single cache */
+
+    if (shards > 0) {
+
+    	shard = createShard(cache, shards);
+
+    	if (shard == NULL) {
+    		goto cleanup;
+    	}
+    }
+
+    /* If [-v] arg was specified, print version header information */
+
+    if (VERSION_DEBUG) {
+    	printVersion();
+    }
+
+    /* A resumed run picks the trace up after the checkpoint's last access */
+
+    counter = 0;
+
+    if (resume) {
+
+    	counter = cache->mem_accesses;
+
+    	if (traceReaderResume(reader, trace_offset, counter) != 0) {
+    		goto cleanup;
+    	}
+    }
+
+    /* Take a batch of decoded accesses at a time. With [-t] the text
+     * reader goes one record at a time so each address can be echoed
+     * as it appears in the file */
+
+    do {
+
+    	/* -checkpoint-at snapshots the cache at the end of the batch
+    	 * that reaches the access, so it knows where the trace stands */
+
+    	if (checkpoint_at > 0 && !checkpointed && counter >= checkpoint_at) {
+
+    		if (saveCache(cache, checkpoint_path, traceReaderOffset(reader)) != 0) {
+    			n = -1;
+    			break;
+    		}
+
+    		printf("Checkpoint of access %lld written to %s.\n", counter, checkpoint_path);
+    		checkpointed = true;
+    	}
+
+    	n = traceReaderNext(reader, &decoded, &decoded_writes);
+
+    	/* a lone cache without [-t] takes the whole batch at once */
+
+    	if (cache != NULL && sweep == NULL && shard == NULL && sd == NULL && hierarchy == NULL && !TRACE_DEBUG && n > 0) {
+    		accessCacheBatch(cache, decoded, decoded_writes, (size_t) n);
+    		counter += n;
+    		continue;
+    	}
+
+    	for (i = 0; i < n; i++) {
+
+    		/* print address if debug flag is set */
+
+    		if (TRACE_DEBUG) {
+
+    			if ((token = traceReaderToken(reader)) != NULL) {
+    				strcpy(address, token);
+    			}
+    			else {
+    				sprintf(address, "0x%08" PRIx64, decoded[i]);
+    			}
+
+    			mode = decoded_writes[i] ? 'w' : 'r';
+    			printf("\nAccess %lld: Mode %c -- Address %s\n\n", counter+1, mode, address);
+    		}
+
+    		/* call read or write function with address buffer */
+    		simulateAccess(cache, sweep, shard, sd, hierarchy, TRACE_DEBUG ? address : NULL, decoded[i], decoded_writes[i], counter);
+    		counter++;
+    	}
+
+    } while (n > 0);
+
+    /* a malformed record is reported by the reader (with its offset);
+     * terminate program after freeing cache memory & closing file safely */
+
+    if (n < 0) {
+    	goto cleanup;
+    }
+
+    /* Wait for the sweep or shard workers to drain every batch */
+    finishSweep(sweep);
+    finishShard(shard);
+
+    /* writes still in a write buffer reach memory before the totals */
+
+    for (i = 0; i < cache_count; i++) {
+    	flushWriteBuffer(caches[i]);
+    	flushInterval(caches[i]);
+    }
+
+    /* without -checkpoint-at (or past the end) the checkpoint holds the
+     * cache at the end of the trace */
+
+    if (checkpoint_path != NULL && !checkpointed) {
+
+    	if (saveCache(cache, checkpoint_path, traceReaderOffset(reader)) != 0) {
+    		goto cleanup;
+    	}
+
+    	printf("Checkpoint of access %lld written to %s.\n", counter, checkpoint_path);
+    }
+
+    /* the writer thread finishes the event log before the totals */
+
+    n = (closeEventLog(log) < 0) ? -1 : 0;
+    log = NULL;
+
+    if (n < 0) {
+    	goto cleanup;
+    }
+
+    /* Call printCache function to print cache statistics and dump information */
+
+    if (sd != NULL) {
+    	printStackDist(sd);
+    }
+    else if (hierarchy != NULL) {
+    	printHierarchy(hierarchy, DUMP_DEBUG);
+    }
+    else if (sweep == NULL) {
+    	printCache(cache);
+    }
+    else {
+    	for (i = 0; i < cache_count; i++) {
+    		printf("\n\n******** Configuration %d: %d sets, %d ways, %d byte blocks, %s ********\n", i + 1, configs[i][0], configs[i][1], configs[i][2], policyName((configs[i][3] >= 0) ? configs[i][3] : policy));
+    		printCache(caches[i]);
+    	}
+
+    	printSummary(caches, cache_count);
+    }
+
+    status = 0;
+
+    /* Every exit after the arguments are read comes here: close the
+     * file, stop the threads, destroy the cache(s). Whatever was never
+     * created is still NULL */
+
+cleanup:
+
+    closeTraceReader(reader);
+    closeEventLog(log);
+    destroySweep(sweep);
+    destroyShard(shard);
+    destroyStackDist(sd);
+    destroyHierarchy(hierarchy);
+    destroyCoherence(coherence);
+
+    for (i = 0; caches != NULL && i < cache_count; i++) {
+    	destroyCache(caches[i]);
+    }
+
+    free(caches);
+    free(configs);
+    free(levels);
+    free(cores);
+
+    return status;
+}
+
+#endif
+/* CACHESIM_LIBRARY */
+
+/********************************
+ *     5. Cache Functions       *
+ ********************************/
+ 
+/* Function List:
+ *
+ * 1) createCache
+ * 2) destroyCache
+ * 3) setWritePolicy
+ * 4) flushWriteBuffer
+ * 5) setMshrs
+ * 6) setPrefetcher
+ * 7) setVictimCache
+ * 8) setMissClass
+ * 9) setEventLog
+ * 10) setInterval
+ * 11) flushInterval
+ * 12) setHeatmap
+ * 13) setSampling
+ * 14) saveCache
+ * 15) restoreCache
+ * 16) readFromCache
+ * 17) writeToCache
+ * 18) accessCache
+ * 19) accessCacheAt
+ * 20) getSetIndex
+ * 21) getNumberOfSets
+ * 22) accessBlock
+ * 23) invalidateBlock
+ * 24) probeBlock
+ * 25) setBlockState
+ * 26) createCacheShard
+ * 27) mergeCacheShard
+ * 28) printCache
+ * 29) dumpCache
+ * 30) printSummary
+ */
+
+
+/* createCache
+ *
+ * Function to create a new cache struct.  Returns the new struct on success
+ * and NULL on failure. The number of sets and the block size must be powers
+ * of two, and the address must leave at least one tag bit.
+ *
+ * @param   number_of_sets  # of sets (lines per way)
+ * @param 	associativity 	# of ways (1 - MAX_ASSOCIATIVITY)
+ * @param   block_size      size of each block in bytes
+ * @param   address_size    width of a memory address in bits (1 - MAX_ADDRESS_SIZE)
+ * @param   policy          replacement policy (POLICY_LRU, ...; see Policy.h)
+ * @param   seed            seed for the policies that make random choices
+ *
+ * @return  success         new Cache
+ * @return  failure         NULL
+ */
+
+Cache createCache(int number_of_sets, int associativity, int block_size, int address_size, int policy, unsigned int seed) {
+
+	Cache cache;
+    size_t stride, line, bytes;
+    int bitsIndex, bitsOffset, i;
+    
+    /* Validate Inputs */
+    if(number_of_sets <= 0 || (number_of_sets & (number_of_sets - 1)) != 0) {
+        fprintf(stderr, "Error: Number of sets must be a power of two!\n");
+        return NULL;
+    }
+    
+    if(block_size <= 0 || (block_size & (block_size - 1)) != 0) {
+        fprintf(stderr, "Error: Block size must be a power of two bytes!\n");
+        return NULL;
+    }
+
+    if(associativity <= 0 || associativity > MAX_ASSOCIATIVITY) {
+        fprintf(stderr, "Error: Associativity must be between 1 and %d ways!\n", MAX_ASSOCIATIVITY);
+        return NULL;
+    }
+
+    if(address_size <= 0 || address_size > MAX_ADDRESS_SIZE) {
+        fprintf(stderr, "Error: Address size must be between 1 and %d bits!\n", MAX_ADDRESS_SIZE);
+        return NULL;
+    }
+
+    bitsOffset = __builtin_ctz(block_size);
+    bitsIndex = __builtin_ctz(number_of_sets);
+
+    if(bitsOffset + bitsIndex >= address_size) {
+        fprintf(stderr, "Error: %d sets of %d bytes leave no tag bits in a %d bit address!\n", number_of_sets, block_size, address_size);
+        return NULL;
+    }
+
+    if(policyCheck(policy, associativity) != 0) {
+        return NULL;
+    }
+    
+    
+    /* Lets make a cache!
+     * allocate all the memory needed for a cache structure */
+
+    cache = (Cache) malloc( sizeof( struct Cache_ ) );
+
+    if(cache == NULL) {
+        fprintf(stderr, "Error: could not allocate memory for cache.\n");
+        return NULL;
+    }
+    
+    /* Initialize the cache parameters */
+
+    cache->reads = 0;
+    cache->read_hits = 0;
+    cache->read_misses = 0;
+
+    cache->writes = 0;
+    cache->write_hits = 0;
+    cache->write_misses = 0;
+
+    cache->cycles = 0;
+
+    cache->stream_ins = 0;
+    cache->stream_outs = 0;
+    cache->evictions = 0;
+    cache->mem_accesses = 0;
+
+    cache->cache_size = (long long) number_of_sets * associativity * block_size;
+    cache->block_size = block_size;
+    cache->associativity = associativity;
+    cache->number_of_sets = number_of_sets;
+    cache->address_size = address_size;
+
+    /* calculate the address fields */
+
+    cache->bitsOffset = bitsOffset;
+    cache->bitsIndex = bitsIndex;
+    cache->bitsTag = address_size - (bitsOffset + bitsIndex);
+    cache->index_mask = (unsigned int) number_of_sets - 1;
+    cache->tag_mask = (cache->bitsTag == 64) ? ~0ull : (1ull << cache->bitsTag) - 1;
+
+    /* only a cache with more than 32 tag bits pays for 64-bit tags */
+
+    cache->wide = cache->bitsTag > 32;
+    cache->access = selectKernel(associativity, bitsOffset, policy, 0, cache->wide);
+    cache->policy = policy;
+    cache->shared = NULL;
+    cache->write_policy = WRITE_BACK;
+    cache->buffer = NULL;
+    cache->buffer_entries = 0;
+    cache->buffer_head = 0;
+    cache->buffer_count = 0;
+    cache->buffer_done = 0;
+    cache->buffer_merges = 0;
+    cache->buffer_stalls = 0;
+    cache->mshr = NULL;
+    cache->prefetcher = NULL;
+    cache->prefetched = NULL;
+    cache->arrival = NULL;
+    cache->prefetch_free = 0;
+    cache->prefetches = 0;
+    cache->prefetch_dropped = 0;
+    cache->prefetch_useful = 0;
+    cache->prefetch_late = 0;
+    cache->prefetch_late_cycles = 0;
+    cache->prefetch_useless = 0;
+    cache->prefetch_polluting = 0;
+    cache->prefetch_contention = 0;
+    cache->side = NULL;
+    cache->side_hits = 0;
+    cache->classes = NULL;
+    cache->log = NULL;
+    cache->interval = NULL;
+    cache->interval_next = 0;
+    cache->set_counters = NULL;
+    cache->heatmap_top = 0;
+    cache->sample = NULL;
+    cache->sample_skipped = 0;
+    initPolicyState(&cache->policy_state, policy, number_of_sets, seed);
+
+    /* Size each set record so that it never straddles a cache line:
+     * small records are padded to a power of two, larger ones to a
+     * whole number of 64-byte lines */
+
+    stride = sizeof(struct Set_) + associativity * (cache->wide ? sizeof(uint64_t) : sizeof(unsigned int)) + policyMetaBytes(policy, associativity);
+
+    if(stride <= 64) {
+        for(line = 8; line < stride; line *= 2);
+        stride = line;
+    }
+    else {
+        stride = (stride + 63) & ~((size_t) 63);
+    }
+
+    cache->set_stride = stride;
+    cache->mapped = 0;
+
+    /* Allocate ALL sets in one zeroed, line-aligned block, so that every
+     * block starts out invalid and clean */
+
+    bytes = (stride * number_of_sets + 63) & ~((size_t) 63);
+
+    cache->sets = (unsigned char*) aligned_alloc(64, bytes);
+
+    if(cache->sets == NULL) {
+        fprintf(stderr, "Error: could not allocate memory for cache.\n");
+        free(cache);
+        return NULL;
+    }
+
+    memset(cache->sets, 0, bytes);
+
+    for(i = 0; i < number_of_sets; i++) {
+        initPolicySet(policy, setMeta(cache, getSet(cache, i)), associativity);
+    }
+    
+    return cache;
+}
+
+/* destroyCache
+ * 
+ * Function that destroys a created cache. Frees all allocated memory. If 
+ * you pass in NULL, nothing happens. So make sure to set your cache = NULL
+ * after you destroy it to prevent a double free.
+ *
+ * @param   cache           cache object to be destroyed
+ *
+ * @return  void
+ */
+
+void destroyCache(Cache cache) {
+
+    if(cache != NULL) {
+
+    	/* The whole tag store is a single allocation or mapping */
+        if(cache->mapped > 0) {
+            unmapCheckpoint(cache->sets, cache->mapped);
+        }
+        else {
+            free(cache->sets);
+        }
+
+        free(cache->shared);
+        free(cache->buffer);
+        destroyMshr(cache->mshr);
+        destroyPrefetcher(cache->prefetcher);
+        free(cache->prefetched);
+        free(cache->arrival);
+        destroyVictimCache(cache->side);
+        destroyMissClass(cache->classes);
+        destroyInterval(cache->interval);
+        free(cache->set_counters);
+        free(cache->sample);
+        free(cache);
+    }
+
+    return;
+}
+
+/* setWritePolicy
+ *
+ * Sets how the cache handles writes. By default it is write-back and
+ * allocates on a write miss; WRITE_THROUGH sends every write on to
+ * memory (and leaves the block clean), WRITE_NO_ALLOCATE sends a write
+ * miss to memory without filling the block. With 'buffer_entries' > 0,
+ * writes to memory (write-throughs and dirty evictions) go through a
+ * coalescing write buffer of that many blocks instead of stalling the
+ * cache. Must be called before the first access.
+ *
+ * @param       cache           target cache struct
+ * @param       write_policy    WRITE_BACK, or WRITE_THROUGH | WRITE_NO_ALLOCATE
+ * @param       buffer_entries  # of write buffer entries (0 - MAX_WRITE_BUFFER)
+ *
+ * @return      success         0
+ * @return      failure         -1
+ */
+
+int setWritePolicy(Cache cache, int write_policy, int buffer_entries) {
+
+    if(cache == NULL) {
+        fprintf(stderr, "Error: Must supply a valid cache!\n");
+        return -1;
+    }
+
+    if(write_policy & ~(WRITE_THROUGH | WRITE_NO_ALLOCATE)) {
+        fprintf(stderr, "Error: unknown write policy %d.\n", write_policy);
+        return -1;
+    }
+
+    if(buffer_entries < 0 || buffer_entries > MAX_WRITE_BUFFER) {
+        fprintf(stderr, "Error: the write buffer must have 0 - %d entries.\n", MAX_WRITE_BUFFER);
+        return -1;
+    }
+
+    free(cache->buffer);
+    cache->buffer = NULL;
+
+    if(buffer_entries > 0) {
+        cache->buffer = (uint64_t*) malloc(buffer_entries * sizeof(uint64_t));
+        assert(cache->buffer != NULL);
+    }
+
+    cache->write_policy = write_policy;
+    cache->buffer_entries = buffer_entries;
+    cache->buffer_head = 0;
+    cache->buffer_count = 0;
+
+    cache->access = selectKernel(cache->associativity, cache->bitsOffset, cache->policy, needsGeneralKernel(cache), cache->wide);
+
+    return 0;
+}
+
+/* flushWriteBuffer
+ *
+ * Waits for every write still in the write buffer to reach memory, at
+ * the end of a simulation. Does nothing if the buffer is empty.
+ *
+ * @param       cache       target cache struct
+ *
+ * @return      void
+ */
+
+void flushWriteBuffer(Cache cache) {
+
+    long long done;
+
+    if(cache == NULL || cache->buffer_count == 0) {
+        return;
+    }
+
+    /* the head finishes at buffer_done, every later entry one write after */
+
+    done = cache->buffer_done + (cache->buffer_count - 1) * MEMORY_WRITE_CYCLES;
+
+    if(done > cache->cycles) {
+        cache->cycles = done;
+    }
+
+    cache->stream_outs += cache->buffer_count;
+    cache->buffer_count = 0;
+}
+
+/* setMshrs
+ *
+ * Adds a non-blocking timing model with 'entries' MSHRs (see Mshr.h)
+ * next to the cache's blocking cycle count. printCache reports both.
+ * Must be called before the first access.
+ *
+ * @param       cache       target cache struct
+ * @param       entries     # of MSHRs (1 - MAX_MSHRS)
+ *
+ * @return      success     0
+ * @return      failure     -1
+ */
+
+int setMshrs(Cache cache, int entries) {
+
+    Mshr mshr;
+
+    if(cache == NULL) {
+        fprintf(stderr, "Error: Must supply a valid cache!\n");
+        return -1;
+    }
+
+    mshr = createMshr(entries, MEMORY_READ_CYCLES);
+
+    if(mshr == NULL) {
+        return -1;
+    }
+
+    destroyMshr(cache->mshr);
+    cache->mshr = mshr;
+
+    return 0;
+}
+
+/* setPrefetcher
+ *
+ * Adds a hardware prefetcher (see Prefetch.h) to the cache. Prefetches
+ * cost a stream-in each and share memory with the demand misses: a
+ * prefetch waits for the ones before it, a demand miss waits for all of
+ * them, and a prefetch is dropped when 'degree' of them are already
+ * queued. A demand access to a prefetched block that has not arrived
+ * yet waits for it. Must be called before the first access.
+ *
+ * @param       cache       target cache struct
+ * @param       kind        PREFETCH_NEXT_LINE, PREFETCH_STRIDE, or PREFETCH_STREAM
+ * @param       degree      blocks prefetched ahead (1 - MAX_PREFETCH_DEGREE)
+ *
+ * @return      success     0
+ * @return      failure     -1
+ */
+
+int setPrefetcher(Cache cache, int kind, int degree) {
+
+    Prefetcher prefetcher;
+
+    if(cache == NULL) {
+        fprintf(stderr, "Error: Must supply a valid cache!\n");
+        return -1;
+    }
+
+    prefetcher = createPrefetcher(kind, degree);
+
+    if(prefetcher == NULL) {
+        return -1;
+    }
+
+    destroyPrefetcher(cache->prefetcher);
+    free(cache->prefetched);
+    free(cache->arrival);
+
+    cache->prefetcher = prefetcher;
+    cache->prefetched = (unsigned int*) calloc(cache->number_of_sets, sizeof(unsigned int));
+    cache->arrival = (long long*) calloc((size_t) cache->number_of_sets * cache->associativity, sizeof(long long));
+    assert(cache->prefetched != NULL && cache->arrival != NULL);
+
+    cache->access = selectKernel(cache->associativity, cache->bitsOffset, cache->policy, needsGeneralKernel(cache), cache->wide);
+
+    return 0;
+}
+
+/* setVictimCache
+ *
+ * Adds a small fully-associative victim cache or miss cache beside the
+ * sets (see VictimCache.h). A miss in the sets that hits in it costs
+ * SIDE_HIT_CYCLES instead of a fetch from memory. Must be called before
+ * the first access.
+ *
+ * @param       cache       target cache struct
+ * @param       kind        VICTIM_CACHE or MISS_CACHE
+ * @param       entries     # of blocks (1 - MAX_VICTIM_ENTRIES)
+ *
+ * @return      success     0
+ * @return      failure     -1
+ */
+
+int setVictimCache(Cache cache, int kind, int entries) {
+
+    VictimCache side;
+
+    if(cache == NULL) {
+        fprintf(stderr, "Error: Must supply a valid cache!\n");
+        return -1;
+    }
+
+    side = createVictimCache(kind, entries);
+
+    if(side == NULL) {
+        return -1;
+    }
+
+    destroyVictimCache(cache->side);
+    cache->side = side;
+
+    cache->access = selectKernel(cache->associativity, cache->bitsOffset, cache->policy, needsGeneralKernel(cache), cache->wide);
+
+    return 0;
+}
+
+/* setMissClass
+ *
+ * Classifies every miss of the cache as compulsory, capacity, or
+ * conflict (see MissClass.h); printCache reports the counts. Must be
+ * called before the first access.
+ *
+ * @param       cache       target cache struct
+ *
+ * @return      success     0
+ * @return      failure     -1
+ */
+
+int setMissClass(Cache cache) {
+
+    MissClass classes;
+
+    if(cache == NULL) {
+        fprintf(stderr, "Error: Must supply a valid cache!\n");
+        return -1;
+    }
+
+    classes = createMissClass(cache->number_of_sets * cache->associativity);
+
+    if(classes == NULL) {
+        return -1;
+    }
+
+    destroyMissClass(cache->classes);
+    cache->classes = classes;
+
+    return 0;
+}
+
+/* setEventLog
+ *
+ * Records every access of the cache in 'log' (see EventLog.h) instead
+ * of printing it, for [-log]. The log stays owned by the caller and
+ * must outlive the accesses. Must be called before the first access.
+ *
+ * @param       cache       target cache struct
+ * @param       log         event log, or NULL to stop logging
+ *
+ * @return      success     0
+ * @return      failure     -1
+ */
+
+int setEventLog(Cache cache, EventLog log) {
+
+    if(cache == NULL) {
+        fprintf(stderr, "Error: Must supply a valid cache!\n");
+        return -1;
+    }
+
+    cache->log = log;
+    cache->access = selectKernel(cache->associativity, cache->bitsOffset, cache->policy, needsGeneralKernel(cache), cache->wide);
+
+    return 0;
+}
+
+/* setInterval
+ *
+ * Writes a row of interval statistics (see Interval.h) every 'period'
+ * accesses, or every 'period' cycles with 'by_cycles' set, and sums
+ * them up in printCache. Must be called before the first access.
+ *
+ * @param       cache       target cache struct
+ * @param       path        CSV output file, or NULL for stdout
+ * @param       period      accesses or cycles per interval
+ * @param       by_cycles   'period' counts cycles instead of accesses
+ *
+ * @return      success     0
+ * @return      failure     -1
+ */
+
+int setInterval(Cache cache, const char *path, long long period, int by_cycles) {
+
+    Interval interval;
+    CacheCounters now;
+    long long position;
+
+    if(cache == NULL) {
+        fprintf(stderr, "Error: Must supply a valid cache!\n");
+        return -1;
+    }
+
+    interval = createInterval(path, period, by_cycles);
+
+    if(interval == NULL) {
+        return -1;
+    }
+
+    /* a restored cache starts counting from its checkpoint */
+
+    getCacheCounters(cache, &now);
+    intervalStart(interval, &now);
+    position = by_cycles ? cache->cycles : cache->mem_accesses;
+
+    destroyInterval(cache->interval);
+    cache->interval = interval;
+    cache->interval_next = (position / period + 1) * period;
+
+    return 0;
+}
+
+/* flushInterval
+ *
+ * Writes the row of the last, partial interval at the end of a
+ * simulation. Does nothing without interval statistics.
+ *
+ * @param       cache       target cache struct
+ *
+ * @return      void
+ */
+
+void flushInterval(Cache cache) {
+
+    CacheCounters now;
+
+    if(cache == NULL || cache->interval == NULL) {
+        return;
+    }
+
+    getCacheCounters(cache, &now);
+    intervalSample(cache->interval, &now);
+}
+
+/* setHeatmap
+ *
+ * Counts the accesses, misses, evictions, and dirty evictions of every
+ * set (see Heatmap.h); printCache lists the 'top' hottest and most
+ * conflicted sets and a histogram of accesses per set. Must be called
+ * before the first access.
+ *
+ * @param       cache       target cache struct
+ * @param       top         # of sets in each list (1 - MAX_HEATMAP_TOP)
+ *
+ * @return      success     0
+ * @return      failure     -1
+ */
+
+int setHeatmap(Cache cache, int top) {
+
+    SetCounters *counters;
+
+    if(cache == NULL) {
+        fprintf(stderr, "Error: Must supply a valid cache!\n");
+        return -1;
+    }
+
+    if(top <= 0 || top > MAX_HEATMAP_TOP) {
+        fprintf(stderr, "Error: the heatmap lists 1 - %d sets.\n", MAX_HEATMAP_TOP);
+        return -1;
+    }
+
+    counters = createSetCounters(cache->number_of_sets);
+
+    if(counters == NULL) {
+        return -1;
+    }
+
+    free(cache->set_counters);
+    cache->set_counters = counters;
+    cache->heatmap_top = top;
+
+    return 0;
+}
+
+/* setSampling
+ *
+ * Simulates only 1 in 'ratio' sets, chosen by a hash of the index (see
+ * Sample.h), and drops every access to the others as soon as its set
+ * is known. The counters then cover the sampled sets, and printCache
+ * adds the estimates for the full run with their confidence interval.
+ * Must be called before the first access.
+ *
+ * @param       cache       target cache struct
+ * @param       ratio       sample 1 in 'ratio' sets (2 - number_of_sets / 2)
+ *
+ * @return      success     0
+ * @return      failure     -1
+ */
+
+int setSampling(Cache cache, int ratio) {
+
+    SetSample *sample;
+
+    if(cache == NULL) {
+        fprintf(stderr, "Error: Must supply a valid cache!\n");
+        return -1;
+    }
+
+    sample = (SetSample*) malloc(sizeof(SetSample));
+    assert(sample != NULL);
+
+    if(initSetSample(sample, cache->number_of_sets, ratio) != 0) {
+        free(sample);
+        return -1;
+    }
+
+    /* the estimate needs the accesses and misses of every sampled set */
+
+    if(cache->set_counters == NULL) {
+
+        cache->set_counters = createSetCounters(cache->number_of_sets);
+
+        if(cache->set_counters == NULL) {
+            free(sample);
+            return -1;
+        }
+    }
+
+    free(cache->sample);
+    cache->sample = sample;
+
+    return 0;
+}
+
+/* saveCache
+ *
+ * Writes a checkpoint of the cache (see Checkpoint.h): its tag store,
+ * replacement state, and counters, and 'trace_offset', where a resumed
+ * run picks the trace up again. Only the sets and the state above are
+ * saved, so it is meant for a cache without a write buffer, MSHRs, a
+ * prefetcher, a victim or miss cache, or miss classification.
+ *
+ * @param       cache           target cache struct
+ * @param       path            checkpoint file
+ * @param       trace_offset    text trace byte offset after the last access
+ *
+ * @return      success         0
+ * @return      failure         -1
+ */
+
+int saveCache(Cache cache, const char *path, unsigned long long trace_offset) {
+
+    CheckpointInfo info;
+
+    if(cache == NULL) {
+        fprintf(stderr, "Error: Must supply a valid cache!\n");
+        return -1;
+    }
+
+    info.address_size = cache->address_size;
+    info.number_of_sets = cache->number_of_sets;
+    info.associativity = cache->associativity;
+    info.block_size = cache->block_size;
+    info.policy = cache->policy;
+    info.set_stride = cache->set_stride;
+    info.bytes = (cache->set_stride * cache->number_of_sets + 63) & ~((size_t) 63);
+    getCacheCounters(cache, &info.counters);
+    info.rng = cache->policy_state.rng;
+    info.psel = cache->policy_state.psel;
+    info.trace_offset = trace_offset;
+
+    return writeCheckpoint(path, &info, cache->sets);
+}
+
+/* restoreCache
+ *
+ * Loads a checkpoint written by saveCache into a cache of the same
+ * geometry and policy. The tag store is mapped from the file rather
+ * than read. With 'counters' set the counters and access clock are
+ * restored too, to resume the run; otherwise they stay at zero for a
+ * warm start. Must be called before the first access and before
+ * setInterval.
+ *
+ * @param       cache           target cache struct
+ * @param       path            checkpoint file
+ * @param       counters        restore the counters as well
+ * @param       trace_offset    output: text trace byte offset saved with it
+ *
+ * @return      success         0
+ * @return      failure         -1
+ */
+
+int restoreCache(Cache cache, const char *path, int counters, unsigned long long *trace_offset) {
+
+    CheckpointInfo info;
+    unsigned char *sets;
+    const CacheCounters *c = &info.counters;
+
+    if(cache == NULL) {
+        fprintf(stderr, "Error: Must supply a valid cache!\n");
+        return -1;
+    }
+
+    sets = (unsigned char*) mapCheckpoint(path, &info);
+
+    if(sets == NULL) {
+        return -1;
+    }
+
+    if(info.address_size != cache->address_size || info.number_of_sets != cache->number_of_sets ||
+       info.associativity != cache->associativity || info.block_size != cache->block_size || info.policy != cache->policy) {
+        fprintf(stderr, "Error: checkpoint %s is of a %d set, %d way cache of %d byte blocks with %d bit addresses and %s replacement, not of this cache.\n",
+                path, info.number_of_sets, info.associativity, info.block_size, info.address_size,
+                (info.policy >= 0 && info.policy < POLICY_COUNT) ? policyName(info.policy) : "unknown");
+        unmapCheckpoint(sets, info.bytes);
+        return -1;
+    }
+
+    if(info.set_stride != cache->set_stride || info.bytes != ((cache->set_stride * cache->number_of_sets + 63) & ~((size_t) 63))) {
+        fprintf(stderr, "Error: checkpoint %s has a different set layout; it was written by another build.\n", path);
+        unmapCheckpoint(sets, info.bytes);
+        return -1;
+    }
+
+    /* swap in the mapped tag store */
+
+    if(cache->mapped > 0) {
+        unmapCheckpoint(cache->sets, cache->mapped);
+    }
+    else {
+        free(cache->sets);
+    }
+
+    cache->sets = sets;
+    cache->mapped = (size_t) info.bytes;
+    cache->policy_state.rng = info.rng;
+    cache->policy_state.psel = info.psel;
+
+    if(counters) {
+        cache->mem_accesses = c->accesses;
+        cache->reads = c->reads;
+        cache->read_hits = c->read_hits;
+        cache->read_misses = c->read_misses;
+        cache->writes = c->writes;
+        cache->write_hits = c->write_hits;
+        cache->write_misses = c->write_misses;
+        cache->evictions = c->evictions;
+        cache->stream_ins = c->stream_ins;
+        cache->stream_outs = c->stream_outs;
+        cache->cycles = c->cycles;
+    }
+
+    *trace_offset = info.trace_offset;
+
+    return 0;
+}
+
+/* sampleInterval
+ *
+ * Ends the current interval once the access clock or the cycle count
+ * reaches 'interval_next'. An access that spans several cycle
+ * intervals ends only one.
+ */
+
+static inline void sampleInterval(Cache cache) {
+
+    CacheCounters now;
+    long long period = intervalPeriod(cache->interval);
+    long long position = intervalByCycles(cache->interval) ? cache->cycles : cache->mem_accesses;
+
+    if(position < cache->interval_next) {
+        return;
+    }
+
+    getCacheCounters(cache, &now);
+    intervalSample(cache->interval, &now);
+    cache->interval_next = (position / period + 1) * period;
+}
+
+/* readFromCache
+ *
+ * Function that reads data from a cache. Returns 0 on failure
+ * or 1 on success. 
+ *
+ * @param       cache       target cache struct
+ * @param       address     hexidecimal address
+ *
+ * @return      success     0
+ * @return      failure     -1
+ */
+
+int readFromCache(Cache cache, char* address) {
+
+    uint64_t dec;
+    
+    
+    /* Validate inputs */
+    if(cache == NULL) {
+        fprintf(stderr, "Error: Must supply a valid cache to write to!\n");
+        return -1;
+    }
+    
+    if(address == NULL) {
+        fprintf(stderr, "Error: Must supply a valid memory address!\n");
+        return -1;
+    }
+    
+    /* Convert and parse necessary values */
+    
+    dec = htoi(address);
+    
+    /* Print cache address bits for debugging if [-t] arg was specified */
+
+    if(TRACE_DEBUG) {
+        printAddressTrace(cache, address, dec);
+        printf("\tAttempting to read data from cache slot %u.\n", getSetIndex(cache, dec));
+
+        if(cache->sample != NULL && !setSampled(cache->sample, getSetIndex(cache, dec))) {
+            printf("\tSet %u is not sampled; the access is skipped.\n", getSetIndex(cache, dec));
+        }
+    }
+
+	/* Look up the block and fill it on a miss */
+	accessCache(cache, dec, 0);
+    
+    return 0;
+}
+
+/* writeToCache
+ *
+ * Function that writes data to the cache. Returns 0 on failure or
+ * 1 on success. Overwrites any old tag that already existed in the
+ * target slot.
+ *
+ * @param       cache       target cache struct
+ * @param       address     hexidecimal address
+ *
+ * @return      success     0
+ * @return      error       -1
+ */
+
+int writeToCache(Cache cache, char* address) {
+
+    uint64_t dec;
+
+    /* Validate inputs */
+    if(cache == NULL) {
+        fprintf(stderr, "Error: Must supply a valid cache to write to!\n");
+        return -1;
+    }
+    
+    if(address == NULL) {
+        fprintf(stderr, "Error: Must supply a valid memory address!\n");
+        return -1;
+    }
+    
+    /* Convert and parse necessary values */
+    
+    dec = htoi(address);
+    
+    if(TRACE_DEBUG) {
+        printAddressTrace(cache, address, dec);
+        printf("\tAttempting to write data to cache slot %u.\n", getSetIndex(cache, dec));
+
+        if(cache->sample != NULL && !setSampled(cache->sample, getSetIndex(cache, dec))) {
+            printf("\tSet %u is not sampled; the access is skipped.\n", getSetIndex(cache, dec));
+        }
+    }
+
+    /* Look up the block and fill it on a miss */
+    accessCache(cache, dec, 1);
+    
+    return 0;
+}
+
+/* accessCache
+ *
+ * Reads or writes an already decoded address. This is the path used
+ * when the trace has been parsed elsewhere: no strings and no [-t]
+ * output, just the counters and the tag store update.
+ *
+ * @param       cache       target cache struct
+ * @param       address     decoded memory address
+ * @param       write       0 = read, 1 = write
+ *
+ * @return      hit         1
+ * @return      miss        0
+ */
+
+int accessCache(Cache cache, uint64_t address, int write) {
+
+    /* Log another attempted access and advance the access clock */
+
+    return accessCacheAt(cache, address, write, cache->mem_accesses + 1);
+}
+
+/* accessCacheAt
+ *
+ * Same as accessCache, but the access clock is set to 'clock' (the
+ * access number in the whole trace) instead of being advanced by one,
+ * so a shard that only sees some of the accesses keeps the same clock
+ * as the sequential run would. Under set sampling an access to a set
+ * that is not sampled only moves the clock and returns 0.
+ *
+ * @param       cache       target cache struct
+ * @param       address     decoded memory address
+ * @param       write       0 = read, 1 = write
+ * @param       clock       1-based position of this access in the trace
+ *
+ * @return      hit         1
+ * @return      miss        0
+ */
+
+int accessCacheAt(Cache cache, uint64_t address, int write, long long clock) {
+
+    long long fills;
+    int hit;
+
+    cache->mem_accesses = clock;
+
+    /* under set sampling only the sampled sets are simulated */
+
+    if(cache->sample != NULL && !setSampled(cache->sample, (unsigned int) (address >> cache->bitsOffset) & cache->index_mask)) {
+        cache->sample_skipped++;
+        if(cache->interval != NULL) {
+            sampleInterval(cache);
+        }
+        return 0;
+    }
+
+    if(write) {
+        cache->writes++;
+    }
+    else {
+        cache->reads++;
+    }
+
+    if(cache->mshr == NULL && cache->classes == NULL && cache->interval == NULL) {
+        return cache->access(cache, address, write);
+    }
+
+    /* a demand stream-in means the access had to fetch its block;
+     * prefetches it set off are queued to memory on their own and do
+     * not hold an MSHR */
+
+    fills = cache->stream_ins - cache->prefetches;
+    hit = cache->access(cache, address, write);
+
+    if(cache->mshr != NULL) {
+        mshrAccess(cache->mshr, address >> cache->bitsOffset, cache->stream_ins - cache->prefetches != fills);
+    }
+
+    if(cache->classes != NULL) {
+        missClassAccess(cache->classes, address >> cache->bitsOffset, hit);
+    }
+
+    if(cache->interval != NULL) {
+        sampleInterval(cache);
+    }
+
+    return hit;
+}
+
+/* runBatch
+ *
+ * The loop of accessCacheBatch. The 3C classifier is fed from here; the
+ * other models that watch each access take the accessCache path.
+ */
+
+static long long runBatch(Cache cache, const uint64_t *addresses, const unsigned char *writes, size_t count) {
+
+    AccessKernel access = cache->access;
+    const SetSample *sample = cache->sample;
+    MissClass classes = cache->classes;
+    long long hits = 0;
+    size_t i;
+    int hit;
+
+    for(i = 0; i < count; i++) {
+
+        cache->mem_accesses++;
+
+        if(sample != NULL && !setSampled(sample, (unsigned int) (addresses[i] >> cache->bitsOffset) & cache->index_mask)) {
+            cache->sample_skipped++;
+            continue;
+        }
+
+        if(writes[i]) {
+            cache->writes++;
+        }
+        else {
+            cache->reads++;
+        }
+
+        hit = access(cache, addresses[i], writes[i] != 0);
+
+        if(classes != NULL) {
+            if(i + MISSCLASS_AHEAD < count) {
+                missClassPrefetch(classes, addresses[i + MISSCLASS_AHEAD] >> cache->bitsOffset);
+            }
+
+            missClassAccess(classes, addresses[i] >> cache->bitsOffset, hit);
+        }
+
+        hits += hit;
+    }
+
+    return hits;
+}
+
+/* accessCacheBatch
+ *
+ * Runs 'count' decoded accesses through the cache, as accessCache would
+ * one at a time, with the kernel looked up once for the whole batch.
+ * Intervals of N accesses split the batch where they end.
+ *
+ * @param       cache       target cache struct
+ * @param       addresses   decoded memory addresses
+ * @param       writes      0 = read, anything else = write, per access
+ * @param       count       # of accesses
+ *
+ * @return      # of accesses that hit
+ */
+
+long long accessCacheBatch(Cache cache, const uint64_t *addresses, const unsigned char *writes, size_t count) {
+
+    long long hits = 0;
+    size_t i, n;
+
+    /* the MSHR model and cycle intervals watch every access */
+
+    if(cache->mshr != NULL || (cache->interval != NULL && intervalByCycles(cache->interval))) {
+
+        for(i = 0; i < count; i++) {
+            hits += accessCache(cache, addresses[i], writes[i] != 0);
+        }
+
+        return hits;
+    }
+
+    if(cache->interval == NULL) {
+        return runBatch(cache, addresses, writes, count);
+    }
+
+    /* an interval of accesses ends between two chunks */
+
+    for(i = 0; i < count; i += n) {
+
+        n = count - i;
+
+        if((long long) n > cache->interval_next - cache->mem_accesses) {
+            n = (size_t) (cache->interval_next - cache->mem_accesses);
+        }
+
+        hits += runBatch(cache, addresses + i, writes + i, n);
+        sampleInterval(cache);
+    }
+
+    return hits;
+}
+
+/* getCacheCounters
+ *
+ * Copies the access counters of a cache into 'counters'.
+ *
+ * @param       cache       target cache struct
+ * @param       counters    output: the counters
+ *
+ * @return      void
+ */
+
+void getCacheCounters(Cache cache, CacheCounters *counters) {
+
+    counters->accesses = cache->mem_accesses;
+    counters->reads = cache->reads;
+    counters->read_hits = cache->read_hits;
+    counters->read_misses = cache->read_misses;
+    counters->writes = cache->writes;
+    counters->write_hits = cache->write_hits;
+    counters->write_misses = cache->write_misses;
+    counters->evictions = cache->evictions;
+    counters->stream_ins = cache->stream_ins;
+    counters->stream_outs = cache->stream_outs;
+    counters->cycles = cache->cycles;
+}
+
+/* getSetIndex
+ *
+ * Returns the set an address maps to.
+ *
+ * @param       cache       target cache struct
+ * @param       address     decoded memory address
+ *
+ * @return      set index (0 - number_of_sets - 1)
+ */
+
+unsigned int getSetIndex(Cache cache, uint64_t address) {
+    return (unsigned int) (address >> cache->bitsOffset) & cache->index_mask;
+}
+
+/* getNumberOfSets
+ *
+ * Returns the # of sets in the cache.
+ *
+ * @param       cache       target cache struct
+ *
+ * @return      # of sets
+ */
+
+int getNumberOfSets(Cache cache) {
+    return cache->number_of_sets;
+}
+
+/* accessBlock
+ *
+ * Block-level access used when the cache is one level of a hierarchy.
+ * Unlike accessCache it leaves the counters alone, and the caller
+ * decides whether a miss allocates. On a hit the block is marked dirty
+ * if 'dirty' is set and the replacement state is updated. On a miss
+ * with 'fill' set the block is brought in (dirty if 'dirty' is set)
+ * and the block it replaced, if any, is returned in 'victim'.
+ *
+ * @param       cache       target cache struct
+ * @param       address     decoded memory address
+ * @param       dirty       mark the block dirty
+ * @param       fill        allocate the block on a miss
+ * @param       victim      output: evicted block (may be NULL)
+ *
+ * @return      hit         1
+ * @return      miss        0
+ */
+
+int accessBlock(Cache cache, uint64_t address, int dirty, int fill, BlockVictim *victim) {
+
+    uint64_t tag;
+    unsigned int index, hits, bit;
+    unsigned char *meta;
+    int ways = cache->associativity;
+    int j;
+    Set set;
+
+    index = getSetIndex(cache, address);
+    tag = (address >> (cache->bitsOffset + cache->bitsIndex)) & cache->tag_mask;
+
+    set = getSet(cache, index);
+    meta = setMeta(cache, set);
+
+    if(victim != NULL) {
+        victim->valid = 0;
+        victim->dirty = 0;
+    }
+
+    hits = findTag(cache, set, tag) & set->valid;
+
+    if(hits != 0) {
+
+        j = __builtin_ctz(hits);
+
+        if(dirty) {
+            set->dirty |= 1u << j;
+        }
+
+        policyHit(cache->policy, meta, ways, j);
+
+        return 1;
+    }
+
+    if(!fill) {
+        return 0;
+    }
+
+    j = chooseWay(cache, set, meta, ways, cache->policy);
+    bit = 1u << j;
+
+    /* rebuild the victim's address from its tag and the set index */
+
+    if(victim != NULL && (set->valid & bit) != 0) {
+        victim->valid = 1;
+        victim->dirty = (set->dirty & bit) != 0;
+        victim->address = (getTag(cache, set, j) << (cache->bitsOffset + cache->bitsIndex)) | ((uint64_t) index << cache->bitsOffset);
+    }
+
+    if(dirty) {
+        set->dirty |= bit;
+    }
+    else {
+        set->dirty &= ~bit;
+    }
+
+    if(cache->shared != NULL) {
+        cache->shared[index] &= ~bit;
+    }
+
+    set->valid |= bit;
+    policyFill(cache->policy, meta, ways, j, &cache->policy_state, index);
+    putTag(cache, set, j, tag);
+
+    return 0;
+}
+
+/* invalidateBlock
+ *
+ * Removes the block holding 'address' from the cache, if it is there,
+ * for back-invalidation and for blocks moving out of an exclusive
+ * level. The counters are left alone.
+ *
+ * @param       cache       target cache struct
+ * @param       address     decoded memory address
+ * @param       dirty       output: the block was dirty
+ *
+ * @return      present     1
+ * @return      absent      0
+ */
+
+int invalidateBlock(Cache cache, uint64_t address, int *dirty) {
+
+    uint64_t tag;
+    unsigned int index, hits, bit;
+    Set set;
+
+    index = getSetIndex(cache, address);
+    tag = (address >> (cache->bitsOffset + cache->bitsIndex)) & cache->tag_mask;
+
+    set = getSet(cache, index);
+    hits = findTag(cache, set, tag) & set->valid;
+
+    if(hits == 0) {
+        *dirty = 0;
+        return 0;
+    }
+
+    /* an invalid way is filled before any policy victim, so the
+     * replacement state can stay as it is */
+
+    bit = hits & -hits;
+    *dirty = (set->dirty & bit) != 0;
+
+    set->valid &= ~bit;
+    set->dirty &= ~bit;
+
+    if(cache->shared != NULL) {
+        cache->shared[index] &= ~bit;
+    }
+
+    return 1;
+}
+
+/* probeBlock
+ *
+ * Returns the state of the block holding 'address' without touching
+ * the replacement state or the counters: 0 if it is absent, otherwise
+ * BLOCK_VALID plus BLOCK_DIRTY and BLOCK_SHARED if they are set. The
+ * shared flag is only ever set by setBlockState.
+ *
+ * @param       cache       target cache struct
+ * @param       address     decoded memory address
+ *
+ * @return      block state flags
+ */
+
+int probeBlock(Cache cache, uint64_t address) {
+
+    uint64_t tag;
+    unsigned int index, hits;
+    int state;
+    Set set;
+
+    index = getSetIndex(cache, address);
+    tag = (address >> (cache->bitsOffset + cache->bitsIndex)) & cache->tag_mask;
+
+    set = getSet(cache, index);
+    hits = findTag(cache, set, tag) & set->valid;
+
+    if(hits == 0) {
+        return 0;
+    }
+
+    hits &= -hits;
+    state = BLOCK_VALID;
+
+    if(set->dirty & hits) {
+        state |= BLOCK_DIRTY;
+    }
+
+    if(cache->shared != NULL && (cache->shared[index] & hits)) {
+        state |= BLOCK_SHARED;
+    }
+
+    return state;
+}
+
+/* setBlockState
+ *
+ * Sets the dirty and shared flags of the block holding 'address', or
+ * invalidates it if 'state' lacks BLOCK_VALID. Does nothing if the
+ * block is absent. A fill by accessBlock clears the shared flag of the
+ * way it fills.
+ *
+ * @param       cache       target cache struct
+ * @param       address     decoded memory address
+ * @param       state       block state flags
+ *
+ * @return      void
+ */
+
+void setBlockState(Cache cache, uint64_t address, int state) {
+
+    uint64_t tag;
+    unsigned int index, hits;
+    int dirty;
+    Set set;
+
+    if(!(state & BLOCK_VALID)) {
+        invalidateBlock(cache, address, &dirty);
+        return;
+    }
+
+    index = getSetIndex(cache, address);
+    tag = (address >> (cache->bitsOffset + cache->bitsIndex)) & cache->tag_mask;
+
+    set = getSet(cache, index);
+    hits = findTag(cache, set, tag) & set->valid;
+
+    if(hits == 0) {
+        return;
+    }
+
+    hits &= -hits;
+
+    if(state & BLOCK_DIRTY) {
+        set->dirty |= hits;
+    }
+    else {
+        set->dirty &= ~hits;
+    }
+
+    /* most caches never share a block: only then allocate the masks */
+
+    if(cache->shared == NULL) {
+
+        if(!(state & BLOCK_SHARED)) {
+            return;
+        }
+
+        cache->shared = (unsigned int*) calloc(cache->number_of_sets, sizeof(unsigned int));
+        assert(cache->shared != NULL);
+    }
+
+    if(state & BLOCK_SHARED) {
+        cache->shared[index] |= hits;
+    }
+    else {
+        cache->shared[index] &= ~hits;
+    }
+}
+
+/* createCacheShard
+ *
+ * Creates a view of 'cache' with its own, zeroed counters that shares
+ * the parent's tag store. Accesses through a shard update the parent's
+ * sets; mergeCacheShard adds the counters back. Shards used at the same
+ * time must touch disjoint sets. Returns NULL on failure.
+ *
+ * @param       cache       parent cache
+ *
+ * @return      success     new shard
+ * @return      failure     NULL
+ */
+
+Cache createCacheShard(Cache cache) {
+
+    Cache shard;
+
+    shard = (Cache) malloc(sizeof(struct Cache_));
+
+    if(shard == NULL) {
+        fprintf(stderr, "Error: could not allocate memory for cache shard.\n");
+        return NULL;
+    }
+
+    *shard = *cache;
+
+    shard->reads = 0;
+    shard->read_hits = 0;
+    shard->read_misses = 0;
+    shard->writes = 0;
+    shard->write_hits = 0;
+    shard->write_misses = 0;
+    shard->cycles = 0;
+    shard->stream_ins = 0;
+    shard->stream_outs = 0;
+    shard->evictions = 0;
+    shard->mem_accesses = 0;
+
+    return shard;
+}
+
+/* mergeCacheShard
+ *
+ * Adds a shard's counters to its parent and frees the shard (but not
+ * the shared tag store). The parent's access clock becomes the total # of
+ * accesses seen by all merged shards.
+ *
+ * @param       cache       parent cache
+ * @param       shard       shard created from 'cache'
+ *
+ * @return      void
+ */
+
+void mergeCacheShard(Cache cache, Cache shard) {
+
+    if(shard == NULL) {
+        return;
+    }
+
+    cache->reads += shard->reads;
+    cache->read_hits += shard->read_hits;
+    cache->read_misses += shard->read_misses;
+    cache->writes += shard->writes;
+    cache->write_hits += shard->write_hits;
+    cache->write_misses += shard->write_misses;
+    cache->cycles += shard->cycles;
+    cache->stream_ins += shard->stream_ins;
+    cache->stream_outs += shard->stream_outs;
+    cache->evictions += shard->evictions;
+    cache->mem_accesses += shard->reads + shard->writes;
+
+    free(shard);
+}
+
+/* printCache
+ *
+ * Prints out the values of each slot in the cache
+ * as well as the hit, miss, read, write, and size
+ * data.
+ *
+ * @param       cache       Cache struct
+ *
+ * @return      void
+ */
+
+void printCache(Cache cache) {
+
+    /* define some local integers to hold count totals */
+
+    long long cache_total = cache->reads + cache->writes;
+    long long cache_hits = cache->read_hits + cache->write_hits;
+    long long cache_misses = cache->read_misses + cache->write_misses;
+    long long demand;
+
+    if(cache != NULL) {
+
+    	/* Printing cache contents at the end of simulation
+    	 * if the debug flag was set */
+
+    	if (DUMP_DEBUG) {
+    		dumpCache(cache);
+    	}
+
+    	/* Printing cache statistics to the console */
+
+        printf("\nCache parameters:\n\n");
+
+        printf("\tCache size: %lld\n", cache->cache_size);
+        printf("\tCache block size: %d\n", cache->block_size);
+        printf("\tCache number of lines: %d\n", cache->number_of_sets);
+        printf("\tCache associativity: %d\n", cache->associativity);
+
+        if(cache->policy != POLICY_LRU) {
+            printf("\tCache replacement policy: %s\n", policyName(cache->policy));
+        }
+
+        if(cache->write_policy != WRITE_BACK) {
+            printf("\tCache write policy: %s, %s\n",
+                   (cache->write_policy & WRITE_THROUGH) ? "write-through" : "write-back",
+                   (cache->write_policy & WRITE_NO_ALLOCATE) ? "no-write-allocate" : "write-allocate");
+        }
+
+        if(cache->buffer_entries > 0) {
+            printf("\tWrite buffer entries: %d\n", cache->buffer_entries);
+        }
+
+        if(cache->side != NULL) {
+            printf("\t%s cache entries: %d\n", (victimCacheKind(cache->side) == VICTIM_CACHE) ? "Victim" : "Miss", victimCacheEntries(cache->side));
+        }
+
+        if(cache->prefetcher != NULL) {
+            printf("\tPrefetcher: %s, degree %d\n", prefetcherName(prefetcherKind(cache->prefetcher)), prefetcherDegree(cache->prefetcher));
+        }
+
+        printf("\nCache performance:\n\n");
+
+        printf("\tAttempted reads: %lld\n", cache->reads);
+        printf("\tCache read hits: %lld\n", cache->read_hits);
+        printf("\tCache read misses: %lld\n\n", cache->read_misses);
+
+        printf("\tAttempted writes: %lld\n", cache->writes);
+        printf("\tCache write hits: %lld\n", cache->write_hits);
+        printf("\tCache write misses: %lld\n\n", cache->write_misses);
+
+        printf("\tCache hits: %lld\n", cache_hits);
+        printf("\tCache misses: %lld\n", cache_misses);
+        printf("\tTotal accesses: %lld\n\n", cache_total);
+
+        printf("\tCache hit ratio: %2.2f%%\n", ((float) (cache_hits) / (float) (cache_total) ) * 100);
+        printf("\tCache miss ratio: %2.2f%%\n\n", ((float) (cache_misses) / (float) (cache_total) ) * 100);
+
+        if(cache->classes != NULL) {
+            printMissClass(cache->classes);
+        }
+
+        if(cache->interval != NULL) {
+            printInterval(cache->interval);
+        }
+
+        if(cache->side != NULL) {
+            printf("\t%s cache hits: %lld (%2.2f%% of misses)\n\n", (victimCacheKind(cache->side) == VICTIM_CACHE) ? "Victim" : "Miss",
+                   cache->side_hits, cache_misses ? ((float) cache->side_hits / (float) cache_misses) * 100 : 0.0);
+        }
+
+        printf("\tStream-in operations: %lld\n", cache->stream_ins);
+        printf("\tCache evictions: %lld\n", cache->evictions);
+        printf("\tStream-out operations: %lld\n\n", cache->stream_outs);
+
+        if(cache->buffer_entries > 0) {
+            printf("\tWrite buffer merges: %lld\n", cache->buffer_merges);
+            printf("\tWrite buffer stall cycles: %lld\n\n", cache->buffer_stalls);
+        }
+
+        if(cache->prefetcher != NULL) {
+
+            /* demand fetches are the stream-ins that were not prefetches */
+
+            demand = cache->stream_ins - cache->prefetches;
+
+            printf("\tPrefetches issued: %lld\n", cache->prefetches);
+            printf("\tPrefetches dropped (memory busy): %lld\n", cache->prefetch_dropped);
+            printf("\tUseful prefetches: %lld\n", cache->prefetch_useful);
+            printf("\tLate prefetches: %lld (%lld cycles)\n", cache->prefetch_late, cache->prefetch_late_cycles);
+            printf("\tUseless prefetches: %lld\n", cache->prefetch_useless);
+            printf("\tPolluting prefetches: %lld\n", cache->prefetch_polluting);
+            printf("\tPrefetch accuracy: %2.2f%%\n", cache->prefetches ? ((float) cache->prefetch_useful / (float) cache->prefetches) * 100 : 0.0);
+            printf("\tPrefetch coverage: %2.2f%%\n", (cache->prefetch_useful + demand) ? ((float) cache->prefetch_useful / (float) (cache->prefetch_useful + demand)) * 100 : 0.0);
+            printf("\tCycles waiting behind prefetches: %lld\n\n", cache->prefetch_contention);
+        }
+
+        printf("\tCycles with cache: %lld\n", cache->cycles);
+        printf("\tCycles without cache: %lld\n\n", 50*cache_total);
+
+        if(cache->mshr != NULL) {
+            printMshr(cache->mshr);
+        }
+
+        if(cache->sample != NULL) {
+            printf("Set sampling:\n\n");
+            printSetSample(cache->sample, cache->set_counters, cache->mem_accesses, cache->stream_ins, cache->stream_outs, cache->cycles);
+        }
+
+        if(cache->heatmap_top > 0) {
+            printf("Set heatmap:\n\n");
+            printHeatmap(cache->set_counters, cache->number_of_sets, cache->heatmap_top);
+        }
+
+    }
+
+}
+
+/* dumpCache
+ *
+ * Prints the valid, dirty, policy state, and tag of every way of every
+ * set, as the [-d] arg does in printCache.
+ *
+ * @param       cache       Cache struct
+ *
+ * @return      void
+ */
+
+void dumpCache(Cache cache) {
+
+    char tag[MAX_ADDRESS_SIZE + 1];
+    int i, j;
+    Set set;
+
+    for (j = 0; j < cache->associativity; j++) {
+        printf("\n\n******** Way # %d ********\n\n", j);
+
+        for(i = 0; i < cache->number_of_sets; i++) {
+
+            set = getSet(cache, i);
+            strcpy(tag, "NULL");
+
+            if((set->valid >> j) & 1) {
+                getBinary(getTag(cache, set, j), cache->bitsTag, tag);
+            }
+
+            printf("\t[%i]: { valid: %u, dirty: %u, %s: %d, tag: %s }\n", i, (set->valid >> j) & 1, (set->dirty >> j) & 1,
+                   policyStateName(cache->policy), policyWayState(cache->policy, setMeta(cache, set), cache->associativity, j), tag);
+        }
+    }
+}
+
+/* printSummary
+ *
+ * Prints one row per cache with its geometry and headline statistics,
+ * so the configurations of a sweep can be compared side by side.
+ *
+ * @param       caches      array of Cache structs
+ * @param       count       # of caches
+ *
+ * @return      void
+ */
+
+void printSummary(Cache *caches, int count) {
+
+    long long total;
+    int i;
+    Cache cache;
+
+    printf("\nConfiguration summary:\n\n");
+    printf("\t%3s %8s %5s %6s %7s %10s %10s %10s %12s %12s %12s\n", "#", "sets", "ways", "block", "policy", "size", "hit ratio", "miss ratio", "stream-ins", "stream-outs", "cycles");
+
+    for(i = 0; i < count; i++) {
+
+        cache = caches[i];
+        total = cache->reads + cache->writes;
+
+        printf("\t%3d %8d %5d %6d %7s %10lld %9.2f%% %9.2f%% %12lld %12lld %12lld\n", i + 1,
+               cache->number_of_sets, cache->associativity, cache->block_size, policyName(cache->policy), cache->cache_size,
+               ((float) (cache->read_hits + cache->write_hits) / (float) total) * 100,
+               ((float) (cache->read_misses + cache->write_misses) / (float) total) * 100,
+               cache->stream_ins, cache->stream_outs, cache->cycles);
+    }
+
+    printf("\n");
+}
+
+/********************************
+ *     6. Access Kernels        *
+ ********************************/
+
+/* Write Buffer
+ *
+ * The write buffer is a FIFO of block addresses waiting to be written
+ * to memory. Its head is always being written: that takes
+ * MEMORY_WRITE_CYCLES and ends at cycle 'buffer_done', after which the
+ * next entry starts. So the buffer drains in the background while
+ * accesses go on, and an access only waits for it when it is full or
+ * holds the block being fetched.
+ */
+
+/* drainBuffer
+ *
+ * Retires every entry whose write has finished by the current cycle.
+ */
+
+static void drainBuffer(Cache cache) {
+
+    while(cache->buffer_count > 0 && cache->buffer_done <= cache->cycles) {
+
+        cache->buffer_head = (cache->buffer_head + 1) % cache->buffer_entries;
+        cache->buffer_count--;
+        cache->stream_outs++;
+
+        if(cache->buffer_count > 0) {
+            cache->buffer_done += MEMORY_WRITE_CYCLES;
+        }
+    }
+}
+
+/* waitForBuffer
+ *
+ * Stalls until the entry 'position' places behind the head has been
+ * written, then retires it and every entry before it.
+ */
+
+static void waitForBuffer(Cache cache, int position) {
+
+    long long done = cache->buffer_done + position * MEMORY_WRITE_CYCLES;
+
+    cache->buffer_stalls += done - cache->cycles;
+    cache->cycles = done;
+    drainBuffer(cache);
+}
+
+/* bufferWrite
+ *
+ * Queues a block for memory. It merges into a waiting entry for the
+ * same block if there is one (not the head, which is already being
+ * written); if the buffer is full, the access waits for the head.
+ */
+
+static void bufferWrite(Cache cache, uint64_t block) {
+
+    int k;
+
+    drainBuffer(cache);
+
+    for(k = 1; k < cache->buffer_count; k++) {
+        if(cache->buffer[(cache->buffer_head + k) % cache->buffer_entries] == block) {
+            cache->buffer_merges++;
+            return;
+        }
+    }
+
+    if(cache->buffer_count == cache->buffer_entries) {
+        waitForBuffer(cache, 0);
+    }
+
+    if(cache->buffer_count == 0) {
+        cache->buffer_done = cache->cycles + MEMORY_WRITE_CYCLES;
+    }
+
+    cache->buffer[(cache->buffer_head + cache->buffer_count) % cache->buffer_entries] = block;
+    cache->buffer_count++;
+}
+
+/* bufferRead
+ *
+ * Before a block is fetched from memory, waits for any buffered write
+ * of it to reach memory first (a read-after-write hazard).
+ */
+
+static void bufferRead(Cache cache, uint64_t block) {
+
+    int k;
+
+    drainBuffer(cache);
+
+    for(k = cache->buffer_count - 1; k >= 0; k--) {
+        if(cache->buffer[(cache->buffer_head + k) % cache->buffer_entries] == block) {
+            waitForBuffer(cache, k);
+            return;
+        }
+    }
+}
+
+/* memoryWrite
+ *
+ * Sends a block to memory through the write buffer, if there is one,
+ * or directly, paying the whole write.
+ */
+
+static void memoryWrite(Cache cache, uint64_t block) {
+
+    if(cache->buffer_entries > 0) {
+        bufferWrite(cache, block);
+    }
+    else {
+        cache->stream_outs++;
+        cache->cycles += MEMORY_WRITE_CYCLES;
+    }
+}
+
+/* retireBlock
+ *
+ * A valid block leaves the sets: it moves to the victim cache, if there
+ * is one (writing back the block that pushes out, if dirty), or else
+ * is written back if dirty.
+ */
+
+static void retireBlock(Cache cache, uint64_t address, int dirty) {
+
+    uint64_t evicted;
+    int evicted_dirty;
+
+    if(cache->side != NULL && victimCacheKind(cache->side) == VICTIM_CACHE) {
+
+        if(victimCacheInsert(cache->side, address >> cache->bitsOffset, dirty, &evicted, &evicted_dirty) && evicted_dirty) {
+            memoryWrite(cache, evicted << cache->bitsOffset);
+        }
+
+        return;
+    }
+
+    if(dirty) {
+        memoryWrite(cache, address);
+    }
+}
+
+/* Prefetching
+ *
+ * Only the general kernel prefetches. A prefetched block is filled at
+ * once but only arrives at cycle 'arrival'; its bit in 'prefetched'
+ * stays set until a demand access uses it or it is evicted. Stream
+ * prefetches wait in the prefetcher's stream buffer instead.
+ */
+
+/* prefetchUse
+ *
+ * Called on a demand hit on way j. Returns 1 if it is the first use of
+ * a prefetched block, after waiting for the block if it is late.
+ */
+
+static int prefetchUse(Cache cache, unsigned int index, int j, int ways) {
+
+    unsigned int bit = 1u << j;
+    long long wait;
+
+    if(!(cache->prefetched[index] & bit)) {
+        return 0;
+    }
+
+    cache->prefetched[index] &= ~bit;
+    cache->prefetch_useful++;
+
+    wait = cache->arrival[index * ways + j] - cache->cycles;
+
+    if(wait > 0) {
+        cache->prefetch_late++;
+        cache->prefetch_late_cycles += wait;
+        cache->cycles += wait;
+    }
+
+    return 1;
+}
+
+/* prefetchMiss
+ *
+ * Called on a demand miss before the block is fetched. Blames a block
+ * a prefetch evicted, and takes the block from the stream buffer if it
+ * is there (returning 1, after waiting for it if it is late); otherwise
+ * the stream buffer is flushed for a new stream.
+ */
+
+static int prefetchMiss(Cache cache, uint64_t number) {
+
+    long long arrival, wait;
+    int skipped;
+
+    if(checkPollution(cache->prefetcher, number)) {
+        cache->prefetch_polluting++;
+    }
+
+    if(prefetcherKind(cache->prefetcher) != PREFETCH_STREAM) {
+        return 0;
+    }
+
+    if(!streamBufferTake(cache->prefetcher, number, &arrival, &skipped)) {
+        cache->prefetch_useless += streamBufferFlush(cache->prefetcher);
+        return 0;
+    }
+
+    cache->prefetch_useless += skipped;
+    cache->prefetch_useful++;
+
+    wait = arrival - cache->cycles;
+
+    if(wait > 0) {
+        cache->prefetch_late++;
+        cache->prefetch_late_cycles += wait;
+        cache->cycles += wait;
+    }
+
+    return 1;
+}
+
+/* prefetchFill
+ *
+ * Fills a prefetched block into the cache, evicting as a demand fill
+ * would, and tags it with its arrival cycle.
+ */
+
+static void prefetchFill(Cache cache, uint64_t address, long long arrival) {
+
+    uint64_t tag, victim;
+    unsigned int index, bit;
+    unsigned char *meta;
+    int ways = cache->associativity;
+    int j;
+    Set set;
+
+    index = getSetIndex(cache, address);
+    tag = (address >> (cache->bitsOffset + cache->bitsIndex)) & cache->tag_mask;
+
+    set = getSet(cache, index);
+    meta = setMeta(cache, set);
+
+    j = chooseWay(cache, set, meta, ways, cache->policy);
+    bit = 1u << j;
+
+    if(set->valid & bit) {
+
+        victim = (getTag(cache, set, j) << (cache->bitsOffset + cache->bitsIndex)) | ((uint64_t) index << cache->bitsOffset);
+        cache->evictions++;
+
+        if(cache->set_counters != NULL) {
+            cache->set_counters[index].evictions++;
+            cache->set_counters[index].dirty_evictions += (set->dirty >> j) & 1;
+        }
+
+        retireBlock(cache, victim, (set->dirty & bit) != 0);
+
+        /* a demand block pushed out by a prefetch may come back as a miss */
+
+        if(cache->prefetched[index] & bit) {
+            cache->prefetch_useless++;
+        }
+        else {
+            notePollution(cache->prefetcher, victim >> cache->bitsOffset);
+        }
+    }
+
+    set->dirty &= ~bit;
+    set->valid |= bit;
+    policyFill(cache->policy, meta, ways, j, &cache->policy_state, index);
+    putTag(cache, set, j, tag);
+
+    cache->prefetched[index] |= bit;
+    cache->arrival[index * ways + j] = arrival;
+}
+
+/* prefetchIssue
+ *
+ * Trains the prefetcher on a demand access and sends its predictions
+ * to memory, one after another, skipping blocks already held.
+ */
+
+static void prefetchIssue(Cache cache, uint64_t number, int event) {
+
+    uint64_t candidates[MAX_PREFETCH_DEGREE];
+    uint64_t address;
+    int stream = prefetcherKind(cache->prefetcher) == PREFETCH_STREAM;
+    int backlog = prefetcherDegree(cache->prefetcher) * MEMORY_READ_CYCLES;
+    long long start;
+    int count, k;
+
+    count = prefetchTrain(cache->prefetcher, number, event, candidates);
+
+    for(k = 0; k < count; k++) {
+
+        address = candidates[k] << cache->bitsOffset;
+
+        if(probeBlock(cache, address) || (stream && streamBufferHas(cache->prefetcher, candidates[k]))) {
+            continue;
+        }
+
+        /* memory already has a full degree of prefetches queued */
+
+        if(cache->prefetch_free - cache->cycles >= backlog) {
+            cache->prefetch_dropped++;
+            continue;
+        }
+
+        start = (cache->prefetch_free > cache->cycles) ? cache->prefetch_free : cache->cycles;
+        cache->prefetch_free = start + MEMORY_READ_CYCLES;
+        cache->prefetches++;
+        cache->stream_ins++;
+
+        if (TRACE_DEBUG) printf("\tPrefetch of block 0x%08" PRIx64 ", arriving at cycle %lld.\n", address, cache->prefetch_free);
+
+        if(stream) {
+            cache->prefetch_useless += streamBufferPut(cache->prefetcher, candidates[k], cache->prefetch_free);
+        }
+        else {
+            prefetchFill(cache, address, cache->prefetch_free);
+        }
+    }
+}
+
+/* logEvent
+ *
+ * Records the access that just finished in the event log: the way it
+ * hit or filled, the tag it evicted, and the cycles since 'start'.
+ */
+
+static void logEvent(Cache cache, uint64_t address, uint64_t tag, unsigned int index, int way, int flags, uint64_t victim, long long start) {
+
+    EventRecord event;
+    long long cycles = cache->cycles - start;
+
+    event.access = (uint64_t) cache->mem_accesses;
+    event.tag = tag;
+    event.victim = victim;
+    event.set = index;
+    event.cycles = (cycles > UINT32_MAX) ? UINT32_MAX : (uint32_t) cycles;
+    event.offset = (uint32_t) (address & ((1ull << cache->bitsOffset) - 1));
+    event.way = (uint8_t) way;
+    event.flags = (uint8_t) flags;
+
+    eventLogRecord(cache->log, &event);
+}
+
+/* accessSet
+ *
+ * Body shared by every access kernel. Decodes the address, compares the
+ * tag against all ways of its set, and on a miss fills the lowest
+ * invalid way or, if there is none, the victim chosen by the
+ * replacement policy. Reads leave the filled block clean; writes
+ * (allocate-on-write, write-back) mark it dirty.
+ *
+ * It is always inlined with 'policy' as a compile-time constant, and
+ * for the common LRU geometries with 'ways' and 'bitsOffset' as well,
+ * so the decode shifts become immediates and the way loops unroll. The
+ * generic kernels pass the runtime geometry instead.
+ *
+ * The 'general' kernel (any write policy, write buffer, prefetcher,
+ * side cache, or event log) passes general = 1 and the runtime policy. Every other kernel passes
+ * 0, so the write policy, buffer, and prefetch code is compiled out of
+ * them. Likewise only the wide kernel (wide = 1) handles 64-bit tags;
+ * the others decode the 64-bit address but keep 32-bit tags.
+ *
+ * @param       cache       target cache struct
+ * @param       address     decoded memory address
+ * @param       write       0 = read, 1 = write
+ * @param       ways        # of ways
+ * @param       bitsOffset  # of byte select bits
+ * @param       policy      replacement policy
+ * @param       general     honor the write policy, write buffer, and prefetcher
+ * @param       wide        the cache stores 64-bit tags
+ *
+ * @return      hit         1
+ * @return      miss        0
+ */
+
+static inline __attribute__((always_inline))
+int accessSet(Cache cache, uint64_t address, int write, const int ways, const int bitsOffset, const int policy, const int general, const int wide) {
+
+    uint64_t tag, block, evicted;
+    unsigned int index, hits;
+    unsigned char *meta;
+    int j, victim, used, side = 0, side_dirty = 0, evicted_dirty;
+    int through = general && (cache->write_policy & WRITE_THROUGH);
+    int prefetching = general && cache->prefetcher != NULL;
+    int logging = general && cache->log != NULL;
+    SetCounters *counters = cache->set_counters;
+    int flags = write ? EVENT_WRITE : 0;
+    uint64_t victim_tag = 0;
+    long long start = cache->cycles;
+    Set set;
+
+    index = (unsigned int) (address >> bitsOffset) & cache->index_mask;
+    tag = (address >> (bitsOffset + cache->bitsIndex)) & cache->tag_mask;
+    block = address & ~((1ull << bitsOffset) - 1);
+
+    set = getSet(cache, index);
+    meta = (unsigned char *) (set + 1) + ways * (wide ? sizeof(uint64_t) : sizeof(unsigned int));
+
+    if(counters != NULL) {
+        counters[index].accesses++;
+    }
+
+    /* Compare the tag against ALL ways of the set at once;
+     * a cache hit is a valid way whose tag matches */
+
+    if(wide) {
+        hits = matchTagsWide(setWideTags(set), ways, tag) & set->valid;
+    }
+    else if(ways <= 4) {
+        hits = matchTagsInline(setTags(set), ways, (unsigned int) tag) & set->valid;
+    }
+    else {
+        hits = matchTags(setTags(set), ways, (unsigned int) tag) & set->valid;
+    }
+
+    if(hits != 0) {
+
+        j = __builtin_ctz(hits);
+
+        if(write) {
+            cache->write_hits++;
+        }
+        else {
+            cache->read_hits++;
+        }
+
+        used = prefetching && prefetchUse(cache, index, j, ways);
+
+        cache->cycles += 1;
+
+        /* write-through: the block stays clean and memory is updated */
+
+        if(write && through) {
+            memoryWrite(cache, block);
+            if (TRACE_DEBUG) printf("\tWrite-through of block 0x%08" PRIx64 " to memory.\n", block);
+        }
+        else if(write) {
+            set->dirty |= 1u << j;
+        }
+
+        policyHit(policy, meta, ways, j);
+        if (TRACE_DEBUG) printf("\tCache hit on Way %d. Block timestamp updated to %lld.\n", j, cache->mem_accesses);
+
+        if(logging) {
+            logEvent(cache, address, tag, index, j, flags | EVENT_HIT | ((write && through) ? EVENT_THROUGH : 0), 0, start);
+        }
+
+        if(prefetching) {
+            prefetchIssue(cache, address >> bitsOffset, used ? PREFETCH_ON_USE : PREFETCH_ON_HIT);
+        }
+
+        return 1;
+    }
+
+    /* Otherwise, cache miss - let the replacement policy pick a victim */
+
+    if(write) {
+        cache->write_misses++;
+    }
+    else {
+        cache->read_misses++;
+    }
+
+    if(counters != NULL) {
+        counters[index].misses++;
+    }
+
+    /* the victim or miss cache is probed with the sets: a hit there
+     * swaps the block back in instead of fetching it */
+
+    if(general && cache->side != NULL) {
+        side = victimCacheTake(cache->side, address >> bitsOffset, &side_dirty);
+    }
+
+    if(side) {
+        cache->side_hits++;
+        cache->cycles += SIDE_HIT_CYCLES;
+        used = 0;
+        flags |= EVENT_SIDE;
+        if (TRACE_DEBUG) printf("\tCache miss - block 0x%08" PRIx64 " found in the %s cache.\n", block, (victimCacheKind(cache->side) == VICTIM_CACHE) ? "victim" : "miss");
+    }
+    else {
+
+        /* no-write-allocate: the write goes around the cache */
+
+        if(general && write && (cache->write_policy & WRITE_NO_ALLOCATE)) {
+            cache->cycles += 1;
+            memoryWrite(cache, block);
+            if (TRACE_DEBUG) printf("\tCache miss - write of block 0x%08" PRIx64 " sent to memory without allocating.\n", block);
+
+            if(logging) {
+                logEvent(cache, address, tag, index, 0, flags | EVENT_BYPASS, 0, start);
+            }
+
+            return 0;
+        }
+
+        if(general && cache->buffer_entries > 0) {
+            bufferRead(cache, block);
+        }
+
+        /* a block from the stream buffer is already on its way; any other
+         * miss waits for the prefetches queued ahead of it */
+
+        used = prefetching && prefetchMiss(cache, address >> bitsOffset);
+
+        if(used) {
+            cache->cycles += 1;
+            flags |= EVENT_STREAM;
+            if (TRACE_DEBUG) printf("\tCache miss - block 0x%08" PRIx64 " taken from the stream buffer.\n", block);
+        }
+        else {
+
+            if(prefetching && cache->prefetch_free > cache->cycles) {
+                cache->prefetch_contention += cache->prefetch_free - cache->cycles;
+                cache->cycles = cache->prefetch_free;
+            }
+
+            cache->stream_ins++;
+            cache->cycles += 51;
+        }
+    }
+
+    /* An invalid way is always used first */
+
+    victim = chooseWay(cache, set, meta, ways, policy);
+
+    /* evict the victim and update cache statistics */
+
+    if (TRACE_DEBUG) printf("\tCache miss - eviction on Way %d. Block timestamp updated to %lld.\n", victim, cache->mem_accesses);
+
+    /* if data was dirty, need to stream-out (or, with a victim cache,
+     * the victim moves there) */
+
+    if(logging && ((set->valid >> victim) & 1)) {
+        victim_tag = wide ? setWideTags(set)[victim] : setTags(set)[victim];
+        flags |= EVENT_EVICT | (((set->dirty >> victim) & 1) ? EVENT_WRITEBACK : 0);
+    }
+
+    if(general) {
+        if((set->valid >> victim) & 1) {
+            retireBlock(cache, ((wide ? setWideTags(set)[victim] : setTags(set)[victim]) << (bitsOffset + cache->bitsIndex)) | ((uint64_t) index << bitsOffset),
+                        (set->dirty >> victim) & 1);
+        }
+    }
+    else if((set->dirty >> victim) & 1) {
+        cache->stream_outs++;
+        cache->cycles += MEMORY_WRITE_CYCLES;
+    }
+
+    /* if valid data got evicted, log an eviction */
+
+    if((set->valid >> victim) & 1) {
+
+        cache->evictions++;
+
+        if(counters != NULL) {
+            counters[index].evictions++;
+            counters[index].dirty_evictions += (set->dirty >> victim) & 1;
+        }
+    }
+
+    if(prefetching && ((cache->prefetched[index] >> victim) & 1)) {
+        cache->prefetch_useless++;
+        cache->prefetched[index] &= ~(1u << victim);
+    }
+
+    /* allocate-on-write policy -> written data is dirty in the cache
+     * (or, write-through, sent on to memory), read data comes in clean */
+
+    if((write && !through) || side_dirty) {
+        set->dirty |= 1u << victim;
+    }
+    else {
+        set->dirty &= ~(1u << victim);
+    }
+
+    if(write && through) {
+        memoryWrite(cache, block);
+        flags |= EVENT_THROUGH;
+    }
+
+    set->valid |= 1u << victim;
+    policyFill(policy, meta, ways, victim, &cache->policy_state, index);
+
+    /* replace victim tag with incoming block's tag */
+
+    if(wide) {
+        setWideTags(set)[victim] = tag;
+    }
+    else {
+        setTags(set)[victim] = (unsigned int) tag;
+    }
+
+    /* a miss cache keeps a copy of every block fetched from memory */
+
+    if(general && !side && cache->side != NULL && victimCacheKind(cache->side) == MISS_CACHE) {
+        victimCacheInsert(cache->side, address >> bitsOffset, 0, &evicted, &evicted_dirty);
+    }
+
+    if(logging) {
+        logEvent(cache, address, tag, index, victim, flags, victim_tag, start);
+    }
+
+    if(prefetching) {
+        prefetchIssue(cache, address >> bitsOffset, used ? PREFETCH_ON_USE : PREFETCH_ON_MISS);
+    }
+
+    return 0;
+}
+
+/* Specialized LRU kernels for 2/4/8/16 ways with 32 or 64 byte blocks */
+
+#define ACCESS_KERNEL(W, OFFSET) \
+    static int accessKernel_##W##_##OFFSET(Cache cache, uint64_t address, int write) { \
+        return accessSet(cache, address, write, W, OFFSET, POLICY_LRU, 0, 0); \
+    }
+
+ACCESS_KERNEL(2, 5)
+ACCESS_KERNEL(2, 6)
+ACCESS_KERNEL(4, 5)
+ACCESS_KERNEL(4, 6)
+ACCESS_KERNEL(8, 5)
+ACCESS_KERNEL(8, 6)
+ACCESS_KERNEL(16, 5)
+ACCESS_KERNEL(16, 6)
+
+/* One kernel per policy for any geometry */
+
+#define POLICY_KERNEL(NAME, POLICY) \
+    static int accessKernel##NAME(Cache cache, uint64_t address, int write) { \
+        return accessSet(cache, address, write, cache->associativity, cache->bitsOffset, POLICY, 0, 0); \
+    }
+
+POLICY_KERNEL(LRU, POLICY_LRU)
+POLICY_KERNEL(PLRU, POLICY_PLRU)
+POLICY_KERNEL(FIFO, POLICY_FIFO)
+POLICY_KERNEL(Random, POLICY_RANDOM)
+POLICY_KERNEL(SRRIP, POLICY_SRRIP)
+POLICY_KERNEL(BRRIP, POLICY_BRRIP)
+POLICY_KERNEL(DRRIP, POLICY_DRRIP)
+
+/* Any write policy and write buffer, with the policy read at runtime */
+
+static int accessKernelGeneral(Cache cache, uint64_t address, int write) {
+    return accessSet(cache, address, write, cache->associativity, cache->bitsOffset, cache->policy, 1, 0);
+}
+
+/* The same for caches with 64-bit tags */
+
+static int accessKernelWide(Cache cache, uint64_t address, int write) {
+    return accessSet(cache, address, write, cache->associativity, cache->bitsOffset, cache->policy, 1, 1);
+}
+
+static const struct {
+    int associativity;
+    int bitsOffset;
+    AccessKernel kernel;
+} kernels[] = {
+    { 2, 5, accessKernel_2_5 },
+    { 2, 6, accessKernel_2_6 },
+    { 4, 5, accessKernel_4_5 },
+    { 4, 6, accessKernel_4_6 },
+    { 8, 5, accessKernel_8_5 },
+    { 8, 6, accessKernel_8_6 },
+    { 16, 5, accessKernel_16_5 },
+    { 16, 6, accessKernel_16_6 },
+};
+
+static const AccessKernel policyKernels[POLICY_COUNT] = {
+    accessKernelLRU,
+    accessKernelPLRU,
+    accessKernelFIFO,
+    accessKernelRandom,
+    accessKernelSRRIP,
+    accessKernelBRRIP,
+    accessKernelDRRIP,
+};
+
+/* needsGeneralKernel
+ *
+ * Caches that are not write-back/allocate-on-write, or that have a
+ * write buffer, a prefetcher, a victim or miss cache, or an event log,
+ * need the general kernel.
+ */
+
+static int needsGeneralKernel(Cache cache) {
+    return cache->write_policy != WRITE_BACK || cache->buffer_entries > 0 || cache->prefetcher != NULL || cache->side != NULL || cache->log != NULL;
+}
+
+/* selectKernel
+ *
+ * Returns the specialized kernel for a geometry and policy, or the
+ * policy's generic one, or the general kernel if 'general' is set.
+ * Caches with 64-bit tags always get the wide kernel: addresses that
+ * long are rare enough that they need not be specialized.
+ */
+
+static AccessKernel selectKernel(int associativity, int bitsOffset, int policy, int general, int wide) {
+
+    size_t i;
+
+    if(wide) {
+        return accessKernelWide;
+    }
+
+    if(general) {
+        return accessKernelGeneral;
+    }
+
+    if(policy == POLICY_LRU) {
+        for(i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++) {
+            if(kernels[i].associativity == associativity && kernels[i].bitsOffset == bitsOffset) {
+                return kernels[i].kernel;
+            }
+        }
+    }
+
+    return policyKernels[policy];
+}
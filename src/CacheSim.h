@@ -1,116 +1,677 @@
-/* File: CacheSim.h
- * 
- * This program simulates a single-level blocking cache using a trace file.
- * The cache is assumed to be fixed size, allocate-on-write, and write-back.
- * 
- * Usage: ./CacheSim <trace file> [-v] [-t] [-d]
- *
- * <trace file> is the file location that contains a memory access trace.
- *
- * [-v] will include program version information in the output.
- * [-t] will include information about the trace accesses in the output (r/w, tag, offset, etc.)
- * [-d] will dump the final cache contents in the output (valid, dirty, tag, etc.)
- *
- * Trace file must be specified immediately after program executable.
- * Debug commands can be in any order. For example:
- *
- * ./CacheSim "C:\folder\trace.txt"
- * ./CacheSim "C:\folder\trace.txt" -t -v
- * ./CacheSim "C:\folder\trace.txt" -v -d -t
- *
- */
- 
-#ifndef CACHESIM_H
-#define CACHESIM_H
-
-/* Constants */
-
-/* Max Line Length in Trace */
-#define LINELENGTH 128
-
-/* Address Size */
-#define ADDRESS_SIZE 32
-
-/* Cache Parameters */
-#define NUMBER_OF_SETS 1024
-#define ASSOCIATIVITY 4
-#define BLOCK_SIZE 32
-#define CACHE_SIZE (NUMBER_OF_SETS * ASSOCIATIVITY * BLOCK_SIZE)
-
-/* Typedefs */
-typedef struct Cache_* Cache;
-typedef struct Block_* Block;
-typedef struct Way_* Way;
-
-/* createCache
- *
- * Function to create a new cache struct.  Returns the new struct on success
- * and NULL on failure.
- *
- * @param   cache_size      size of cache in bytes
- * @param   block_size      size of each block in bytes
- * @param 	associativity 	# of ways
- *
- * @return  success         new Cache
- * @return  failure         NULL
- */
-
-Cache createCache(int cache_size, int write_policy, int associativity);
-
-/* destroyCache
- *
- * Function that destroys a created cache. Frees all allocated memory. If
- * you pass in NULL, nothing happens. So make sure to set your cache = NULL
- * after you destroy it to prevent a double free.
- *
- * @param   cache           cache object to be destroyed
- *
- * @return  void
- */
-
-void destroyCache(Cache cache);
-
-/* readFromCache
- *
- * Function that reads data from a cache. Returns 0 on failure
- * or 1 on success.
- *
- * @param       cache       target cache struct
- * @param       address     hexidecimal address
- *
- * @return      success     1
- * @return      failure     0
- */
-
-int readFromCache(Cache cache, char* address);
-
-/* writeToCache
- *
- * Function that writes data to the cache. Returns 0 on failure or
- * 1 on success. Frees any old tags that already existed in the
- * target slot.
- *
- * @param       cache       target cache struct
- * @param       address     hexidecimal address
- *
- * @return      success     1
- * @return      error       0
- */
-
-int writeToCache(Cache cache, char* address);
-
-/* printCache
- *
- * Prints out the values of each slot in the cache
- * as well as the hit, miss, read, write, and size
- * data.
- *
- * @param       cache       Cache struct
- *
- * @return      void
- */
-
-void printCache(Cache cache);
-
-#endif
-/* CACHESIM_H */
+/* File: CacheSim.h
+ * 
+ * This program simulates a single-level blocking cache using a trace file.
+ * The cache is fixed size and, by default, allocate-on-write and write-back.
+ * 
+ * Usage: ./CacheSim <trace file> [-v] [-t] [-d] [-sets N] [-ways N] [-block N] [-addr N]
+ *                   [-config SETS:WAYS:BLOCK[:POLICY]]... [-threads N] [-shards N] [-mrc K]
+ *                   [-policy NAME] [-seed N] [-level SETS:WAYS:BLOCK:LATENCY[:INCLUSION][:POLICY]]...
+ *                   [-memory N] [-core <trace file>]... [-protocol NAME] [-quantum N]
+ *                   [-write-through] [-no-write-allocate] [-write-buffer N] [-mshrs N]
+ *                   [-prefetch NAME] [-prefetch-degree N] [-victim-cache N] [-miss-cache N] [-3c]
+ *                   [-log FILE] [-log-sets FIRST[:LAST]] [-log-tag T] [-log-accesses FIRST[:LAST]]
+ *                   [-interval N] [-interval-cycles N] [-interval-file FILE] [-heatmap K]
+ *                   [-checkpoint FILE] [-checkpoint-at N] [-warm FILE] [-resume FILE]
+ *                   [-sample-sets N]
+ *        ./CacheSim convert <text trace> <binary trace>
+ *        ./CacheSim decode <event log>
+ *
+ * <trace file> is the file location that contains a memory access trace,
+ * either text or binary (as written by the convert subcommand). A text
+ * trace may also come from a named pipe, or from stdin when <trace file>
+ * is -.
+ *
+ * [-v] will include program version information in the output.
+ * [-t] will include information about the trace accesses in the output (r/w, tag, offset, etc.)
+ * [-d] will dump the final cache contents in the output (valid, dirty, tag, etc.)
+ * [-sets N] sets the number of sets (power of two, default 1024)
+ * [-ways N] sets the associativity (1 - 32, default 4)
+ * [-block N] sets the block size in bytes (power of two, default 32)
+ * [-addr N] sets the address width in bits (1 - 64, default 32)
+ * [-config SETS:WAYS:BLOCK[:POLICY]] adds a configuration to a single-pass sweep (repeatable)
+ * [-threads N] sets the # of sweep worker threads (default: # of CPUs)
+ * [-shards N] simulates the single cache on N threads, each owning a range of sets
+ * [-mrc K] prints LRU miss ratio curves for 1 - K ways and 1 - N sets instead of simulating
+ * [-policy NAME] sets the replacement policy: lru (default), plru, fifo, random, srrip, brrip, drrip
+ * [-seed N] seeds the random choices of the random, brrip, and drrip policies (default 1)
+ * [-level SETS:WAYS:BLOCK:LATENCY[:INCLUSION][:POLICY]] adds the next level of a cache hierarchy,
+ *     L1 first (repeatable); INCLUSION is inclusive, exclusive, or nine (default)
+ * [-memory N] sets the memory latency of a hierarchy in cycles (default 50)
+ * [-core <trace file>] adds another core with its own trace and private cache (repeatable);
+ *     the first trace file is core 0
+ * [-protocol NAME] sets the coherence protocol of the cores: mesi (default) or moesi
+ * [-quantum N] sets the # of accesses each core runs before the next core's turn (default 1)
+ * [-write-through] writes every write hit on to memory instead of writing dirty blocks back
+ * [-no-write-allocate] sends write misses to memory without filling the block
+ * [-write-buffer N] buffers writes to memory in an N-entry coalescing write buffer (1 - 64)
+ * [-mshrs N] also times the cache as non-blocking with N miss status holding registers (1 - 64)
+ * [-prefetch NAME] adds a hardware prefetcher: next-line, stride, or stream
+ * [-prefetch-degree N] sets how many blocks the prefetcher runs ahead (1 - 16, default 2)
+ * [-victim-cache N] adds an N-block fully-associative victim cache (1 - 64)
+ * [-miss-cache N] adds an N-block fully-associative miss cache (1 - 64)
+ * [-3c] classifies every miss as compulsory, capacity, or conflict
+ * [-log FILE] records every access in a binary event log instead of printing it (see decode)
+ * [-log-sets FIRST[:LAST]] only logs accesses to sets FIRST - LAST
+ * [-log-tag T] only logs accesses with the hexadecimal tag T
+ * [-log-accesses FIRST[:LAST]] only logs accesses FIRST - LAST (1-based)
+ * [-interval N] writes a CSV row of statistics for every N accesses
+ * [-interval-cycles N] writes a CSV row of statistics for every N cycles
+ * [-interval-file FILE] writes the interval rows to FILE instead of stdout
+ * [-heatmap K] counts accesses, misses, and evictions per set and lists the K hottest and
+ *     most conflicted sets
+ * [-checkpoint FILE] saves the cache's state to FILE at the end of the trace
+ * [-checkpoint-at N] saves the checkpoint once N accesses have run instead
+ * [-warm FILE] starts from the cache contents saved in FILE, with the counters at zero
+ * [-resume FILE] continues the run saved in FILE from where it was taken
+ * [-sample-sets N] simulates 1 in N sets and estimates the full run's miss ratio
+ *     with a 95% confidence interval
+ *
+ * Trace file must be specified immediately after program executable.
+ * Debug commands can be in any order. For example:
+ *
+ * ./CacheSim "C:\folder\trace.txt"
+ * ./CacheSim "C:\folder\trace.txt" -t -v
+ * ./CacheSim "C:\folder\trace.txt" -v -d -t
+ * ./CacheSim "C:\folder\trace.txt" -ways 16 -block 64
+ * ./CacheSim "C:\folder\trace.txt" -config 1024:4:32 -config 2048:8:64
+ * ./CacheSim "C:\folder\trace.txt" -config 1024:8:64:lru -config 1024:8:64:drrip
+ * ./CacheSim "C:\folder\trace.txt" -shards 4 -sets 65536
+ * ./CacheSim "C:\folder\trace.txt" -mrc 16 -sets 4096
+ * ./CacheSim "C:\folder\trace.txt" -level 64:8:64:4 -level 1024:8:64:12:inclusive -memory 200
+ * ./CacheSim "C:\folder\core0.txt" -core "C:\folder\core1.txt" -protocol moesi
+ * ./CacheSim "C:\folder\trace.txt" -write-through -no-write-allocate -write-buffer 8
+ * ./CacheSim "C:\folder\trace.txt" -mshrs 8
+ * ./CacheSim "C:\folder\trace.txt" -prefetch stride -prefetch-degree 4
+ * ./CacheSim "C:\folder\trace.txt" -victim-cache 8
+ * ./CacheSim "C:\folder\trace.txt" -3c -config 1024:1:32 -config 256:4:32
+ * ./CacheSim "C:\folder\trace.txt" -log "C:\folder\trace.log" -log-sets 128:131
+ * ./CacheSim decode "C:\folder\trace.log"
+ * ./CacheSim "C:\folder\trace.txt" -interval 100000 -interval-file "C:\folder\phases.csv"
+ * ./CacheSim "C:\folder\trace.txt" -heatmap 8
+ * ./CacheSim "C:\folder\trace.txt" -checkpoint "C:\folder\warm.ckpt" -checkpoint-at 1000000
+ * ./CacheSim "C:\folder\trace.txt" -resume "C:\folder\warm.ckpt"
+ * ./CacheSim "C:\folder\trace.bin" -sets 65536 -sample-sets 32
+ * tracer | ./CacheSim - -ways 8
+ *
+ */
+ 
+#ifndef CACHESIM_H
+#define CACHESIM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "EventLog.h"
+
+/* Constants */
+
+/* Default Cache Parameters (override with -sets, -ways, -block, -addr) */
+#define DEFAULT_ADDRESS_SIZE 32
+#define DEFAULT_NUMBER_OF_SETS 1024
+#define DEFAULT_ASSOCIATIVITY 4
+#define DEFAULT_BLOCK_SIZE 32
+
+/* Limits: valid/dirty bits are one 32-bit mask per set. Addresses are
+ * decoded as 64-bit integers; a cache whose tags fit in 32 bits stores
+ * them in 32 bits, any other cache in 64 */
+#define MAX_ADDRESS_SIZE 64
+#define MAX_ASSOCIATIVITY 32
+
+/* Typedefs */
+typedef struct Cache_* Cache;
+typedef struct Set_* Set;
+
+/* Block state flags (probeBlock, setBlockState) */
+#define BLOCK_VALID 1
+#define BLOCK_DIRTY 2
+#define BLOCK_SHARED 4
+
+/* Write policies (setWritePolicy): write-back and allocate-on-write by
+ * default; WRITE_THROUGH and WRITE_NO_ALLOCATE may be combined */
+#define WRITE_BACK 0
+#define WRITE_THROUGH 1
+#define WRITE_NO_ALLOCATE 2
+
+/* Limit on the write buffer (setWritePolicy) */
+#define MAX_WRITE_BUFFER 64
+
+/* BlockVictim
+ *
+ * The block that accessBlock evicted to make room for a fill.
+ *
+ * @param   valid           a valid block was evicted
+ * @param   dirty           the evicted block was dirty
+ * @param   address         address of the evicted block's first byte
+ */
+
+typedef struct {
+    int valid;
+    int dirty;
+    uint64_t address;
+} BlockVictim;
+
+/* CacheCounters
+ *
+ * The access counters of a cache (getCacheCounters).
+ *
+ * @param   accesses        # of accesses so far
+ * @param   reads           # of attempted reads
+ * @param   read_hits       # of reads that hit
+ * @param   read_misses     # of reads that missed
+ * @param   writes          # of attempted writes
+ * @param   write_hits      # of writes that hit
+ * @param   write_misses    # of writes that missed
+ * @param   evictions       # of valid blocks evicted
+ * @param   stream_ins      # of blocks read from memory
+ * @param   stream_outs     # of blocks written to memory
+ * @param   cycles          # of cycles elapsed
+ */
+
+typedef struct {
+    long long accesses;
+    long long reads;
+    long long read_hits;
+    long long read_misses;
+    long long writes;
+    long long write_hits;
+    long long write_misses;
+    long long evictions;
+    long long stream_ins;
+    long long stream_outs;
+    long long cycles;
+} CacheCounters;
+
+/* createCache
+ *
+ * Function to create a new cache struct.  Returns the new struct on success
+ * and NULL on failure. The number of sets and the block size must be powers
+ * of two, and the address must leave at least one tag bit.
+ *
+ * @param   number_of_sets  # of sets (lines per way)
+ * @param 	associativity 	# of ways (1 - MAX_ASSOCIATIVITY)
+ * @param   block_size      size of each block in bytes
+ * @param   address_size    width of a memory address in bits (1 - MAX_ADDRESS_SIZE)
+ * @param   policy          replacement policy (POLICY_LRU, ...; see Policy.h)
+ * @param   seed            seed for the policies that make random choices
+ *
+ * @return  success         new Cache
+ * @return  failure         NULL
+ */
+
+Cache createCache(int number_of_sets, int associativity, int block_size, int address_size, int policy, unsigned int seed);
+
+/* destroyCache
+ *
+ * Function that destroys a created cache. Frees all allocated memory. If
+ * you pass in NULL, nothing happens. So make sure to set your cache = NULL
+ * after you destroy it to prevent a double free.
+ *
+ * @param   cache           cache object to be destroyed
+ *
+ * @return  void
+ */
+
+void destroyCache(Cache cache);
+
+/* setWritePolicy
+ *
+ * Sets how the cache handles writes. By default it is write-back and
+ * allocates on a write miss; WRITE_THROUGH sends every write on to
+ * memory (and leaves the block clean), WRITE_NO_ALLOCATE sends a write
+ * miss to memory without filling the block. With 'buffer_entries' > 0,
+ * writes to memory (write-throughs and dirty evictions) go through a
+ * coalescing write buffer of that many blocks instead of stalling the
+ * cache. Must be called before the first access.
+ *
+ * @param       cache           target cache struct
+ * @param       write_policy    WRITE_BACK, or WRITE_THROUGH | WRITE_NO_ALLOCATE
+ * @param       buffer_entries  # of write buffer entries (0 - MAX_WRITE_BUFFER)
+ *
+ * @return      success         0
+ * @return      failure         -1
+ */
+
+int setWritePolicy(Cache cache, int write_policy, int buffer_entries);
+
+/* flushWriteBuffer
+ *
+ * Waits for every write still in the write buffer to reach memory, at
+ * the end of a simulation. Does nothing if the buffer is empty.
+ *
+ * @param       cache       target cache struct
+ *
+ * @return      void
+ */
+
+void flushWriteBuffer(Cache cache);
+
+/* setMshrs
+ *
+ * Adds a non-blocking timing model with 'entries' MSHRs (see Mshr.h)
+ * next to the cache's blocking cycle count. printCache reports both.
+ * Must be called before the first access.
+ *
+ * @param       cache       target cache struct
+ * @param       entries     # of MSHRs (1 - MAX_MSHRS)
+ *
+ * @return      success     0
+ * @return      failure     -1
+ */
+
+int setMshrs(Cache cache, int entries);
+
+/* setPrefetcher
+ *
+ * Adds a hardware prefetcher (see Prefetch.h) to the cache. Prefetches
+ * cost a stream-in each and share memory with the demand misses: a
+ * prefetch waits for the ones before it, a demand miss waits for all of
+ * them, and a prefetch is dropped when 'degree' of them are already
+ * queued. A demand access to a prefetched block that has not arrived
+ * yet waits for it. Must be called before the first access.
+ *
+ * @param       cache       target cache struct
+ * @param       kind        PREFETCH_NEXT_LINE, PREFETCH_STRIDE, or PREFETCH_STREAM
+ * @param       degree      blocks prefetched ahead (1 - MAX_PREFETCH_DEGREE)
+ *
+ * @return      success     0
+ * @return      failure     -1
+ */
+
+int setPrefetcher(Cache cache, int kind, int degree);
+
+/* setVictimCache
+ *
+ * Adds a small fully-associative victim cache or miss cache beside the
+ * sets (see VictimCache.h). A miss in the sets that hits in it costs
+ * SIDE_HIT_CYCLES instead of a fetch from memory. Must be called before
+ * the first access.
+ *
+ * @param       cache       target cache struct
+ * @param       kind        VICTIM_CACHE or MISS_CACHE
+ * @param       entries     # of blocks (1 - MAX_VICTIM_ENTRIES)
+ *
+ * @return      success     0
+ * @return      failure     -1
+ */
+
+int setVictimCache(Cache cache, int kind, int entries);
+
+/* setMissClass
+ *
+ * Classifies every miss of the cache as compulsory, capacity, or
+ * conflict (see MissClass.h); printCache reports the counts. Must be
+ * called before the first access.
+ *
+ * @param       cache       target cache struct
+ *
+ * @return      success     0
+ * @return      failure     -1
+ */
+
+int setMissClass(Cache cache);
+
+/* setEventLog
+ *
+ * Records every access of the cache in 'log' (see EventLog.h) instead
+ * of printing it, for [-log]. The log stays owned by the caller and
+ * must outlive the accesses. Must be called before the first access.
+ *
+ * @param       cache       target cache struct
+ * @param       log         event log, or NULL to stop logging
+ *
+ * @return      success     0
+ * @return      failure     -1
+ */
+
+int setEventLog(Cache cache, EventLog log);
+
+/* setInterval
+ *
+ * Writes a row of interval statistics (see Interval.h) every 'period'
+ * accesses, or every 'period' cycles with 'by_cycles' set, and sums
+ * them up in printCache. Must be called before the first access.
+ *
+ * @param       cache       target cache struct
+ * @param       path        CSV output file, or NULL for stdout
+ * @param       period      accesses or cycles per interval
+ * @param       by_cycles   'period' counts cycles instead of accesses
+ *
+ * @return      success     0
+ * @return      failure     -1
+ */
+
+int setInterval(Cache cache, const char *path, long long period, int by_cycles);
+
+/* flushInterval
+ *
+ * Writes the row of the last, partial interval at the end of a
+ * simulation. Does nothing without interval statistics.
+ *
+ * @param       cache       target cache struct
+ *
+ * @return      void
+ */
+
+void flushInterval(Cache cache);
+
+/* setHeatmap
+ *
+ * Counts the accesses, misses, evictions, and dirty evictions of every
+ * set (see Heatmap.h); printCache lists the 'top' hottest and most
+ * conflicted sets and a histogram of accesses per set. Must be called
+ * before the first access.
+ *
+ * @param       cache       target cache struct
+ * @param       top         # of sets in each list (1 - MAX_HEATMAP_TOP)
+ *
+ * @return      success     0
+ * @return      failure     -1
+ */
+
+int setHeatmap(Cache cache, int top);
+
+/* setSampling
+ *
+ * Simulates only 1 in 'ratio' sets, chosen by a hash of the index (see
+ * Sample.h), and drops every access to the others as soon as its set
+ * is known. The counters then cover the sampled sets, and printCache
+ * adds the estimates for the full run with their confidence interval.
+ * Must be called before the first access.
+ *
+ * @param       cache       target cache struct
+ * @param       ratio       sample 1 in 'ratio' sets (2 - number_of_sets / 2)
+ *
+ * @return      success     0
+ * @return      failure     -1
+ */
+
+int setSampling(Cache cache, int ratio);
+
+/* saveCache
+ *
+ * Writes a checkpoint of the cache (see Checkpoint.h): its tag store,
+ * replacement state, and counters, and 'trace_offset', where a resumed
+ * run picks the trace up again. Only the sets and the state above are
+ * saved, so it is meant for a cache without a write buffer, MSHRs, a
+ * prefetcher, a victim or miss cache, or miss classification.
+ *
+ * @param       cache           target cache struct
+ * @param       path            checkpoint file
+ * @param       trace_offset    text trace byte offset after the last access
+ *
+ * @return      success         0
+ * @return      failure         -1
+ */
+
+int saveCache(Cache cache, const char *path, unsigned long long trace_offset);
+
+/* restoreCache
+ *
+ * Loads a checkpoint written by saveCache into a cache of the same
+ * geometry and policy. The tag store is mapped from the file rather
+ * than read. With 'counters' set the counters and access clock are
+ * restored too, to resume the run; otherwise they stay at zero for a
+ * warm start. Must be called before the first access and before
+ * setInterval.
+ *
+ * @param       cache           target cache struct
+ * @param       path            checkpoint file
+ * @param       counters        restore the counters as well
+ * @param       trace_offset    output: text trace byte offset saved with it
+ *
+ * @return      success         0
+ * @return      failure         -1
+ */
+
+int restoreCache(Cache cache, const char *path, int counters, unsigned long long *trace_offset);
+
+/* readFromCache
+ *
+ * Function that reads data from a cache. Returns 0 on failure
+ * or 1 on success.
+ *
+ * @param       cache       target cache struct
+ * @param       address     hexidecimal address
+ *
+ * @return      success     1
+ * @return      failure     0
+ */
+
+int readFromCache(Cache cache, char* address);
+
+/* writeToCache
+ *
+ * Function that writes data to the cache. Returns 0 on failure or
+ * 1 on success. Overwrites any old tag that already existed in the
+ * target slot.
+ *
+ * @param       cache       target cache struct
+ * @param       address     hexidecimal address
+ *
+ * @return      success     1
+ * @return      error       0
+ */
+
+int writeToCache(Cache cache, char* address);
+
+/* accessCache
+ *
+ * Reads or writes an already decoded address. This is the path used
+ * when the trace has been parsed elsewhere: no strings and no [-t]
+ * output, just the counters and the tag store update.
+ *
+ * @param       cache       target cache struct
+ * @param       address     decoded memory address
+ * @param       write       0 = read, 1 = write
+ *
+ * @return      hit         1
+ * @return      miss        0
+ */
+
+int accessCache(Cache cache, uint64_t address, int write);
+
+/* accessCacheAt
+ *
+ * Same as accessCache, but the access clock is set to 'clock' (the
+ * access number in the whole trace) instead of being advanced by one,
+ * so a shard that only sees some of the accesses keeps the same clock
+ * as the sequential run would. Under set sampling an access to a set
+ * that is not sampled only moves the clock and returns 0.
+ *
+ * @param       cache       target cache struct
+ * @param       address     decoded memory address
+ * @param       write       0 = read, 1 = write
+ * @param       clock       1-based position of this access in the trace
+ *
+ * @return      hit         1
+ * @return      miss        0
+ */
+
+int accessCacheAt(Cache cache, uint64_t address, int write, long long clock);
+
+/* accessCacheBatch
+ *
+ * Runs 'count' decoded accesses through the cache, as accessCache would
+ * one at a time, with the kernel looked up once for the whole batch.
+ *
+ * @param       cache       target cache struct
+ * @param       addresses   decoded memory addresses
+ * @param       writes      0 = read, anything else = write, per access
+ * @param       count       # of accesses
+ *
+ * @return      # of accesses that hit
+ */
+
+long long accessCacheBatch(Cache cache, const uint64_t *addresses, const unsigned char *writes, size_t count);
+
+/* getCacheCounters
+ *
+ * Copies the access counters of a cache into 'counters'.
+ *
+ * @param       cache       target cache struct
+ * @param       counters    output: the counters
+ *
+ * @return      void
+ */
+
+void getCacheCounters(Cache cache, CacheCounters *counters);
+
+/* getSetIndex
+ *
+ * Returns the set an address maps to.
+ *
+ * @param       cache       target cache struct
+ * @param       address     decoded memory address
+ *
+ * @return      set index (0 - number_of_sets - 1)
+ */
+
+unsigned int getSetIndex(Cache cache, uint64_t address);
+
+/* getNumberOfSets
+ *
+ * Returns the # of sets in the cache.
+ *
+ * @param       cache       target cache struct
+ *
+ * @return      # of sets
+ */
+
+int getNumberOfSets(Cache cache);
+
+/* accessBlock
+ *
+ * Block-level access used when the cache is one level of a hierarchy.
+ * Unlike accessCache it leaves the counters alone, and the caller
+ * decides whether a miss allocates. On a hit the block is marked dirty
+ * if 'dirty' is set and the replacement state is updated. On a miss
+ * with 'fill' set the block is brought in (dirty if 'dirty' is set)
+ * and the block it replaced, if any, is returned in 'victim'.
+ *
+ * @param       cache       target cache struct
+ * @param       address     decoded memory address
+ * @param       dirty       mark the block dirty
+ * @param       fill        allocate the block on a miss
+ * @param       victim      output: evicted block (may be NULL)
+ *
+ * @return      hit         1
+ * @return      miss        0
+ */
+
+int accessBlock(Cache cache, uint64_t address, int dirty, int fill, BlockVictim *victim);
+
+/* invalidateBlock
+ *
+ * Removes the block holding 'address' from the cache, if it is there,
+ * for back-invalidation and for blocks moving out of an exclusive
+ * level. The counters are left alone.
+ *
+ * @param       cache       target cache struct
+ * @param       address     decoded memory address
+ * @param       dirty       output: the block was dirty
+ *
+ * @return      present     1
+ * @return      absent      0
+ */
+
+int invalidateBlock(Cache cache, uint64_t address, int *dirty);
+
+/* probeBlock
+ *
+ * Returns the state of the block holding 'address' without touching
+ * the replacement state or the counters: 0 if it is absent, otherwise
+ * BLOCK_VALID plus BLOCK_DIRTY and BLOCK_SHARED if they are set. The
+ * shared flag is only ever set by setBlockState.
+ *
+ * @param       cache       target cache struct
+ * @param       address     decoded memory address
+ *
+ * @return      block state flags
+ */
+
+int probeBlock(Cache cache, uint64_t address);
+
+/* setBlockState
+ *
+ * Sets the dirty and shared flags of the block holding 'address', or
+ * invalidates it if 'state' lacks BLOCK_VALID. Does nothing if the
+ * block is absent. A fill by accessBlock clears the shared flag of the
+ * way it fills.
+ *
+ * @param       cache       target cache struct
+ * @param       address     decoded memory address
+ * @param       state       block state flags
+ *
+ * @return      void
+ */
+
+void setBlockState(Cache cache, uint64_t address, int state);
+
+/* createCacheShard
+ *
+ * Creates a view of 'cache' with its own, zeroed counters that shares
+ * the parent's tag store. Accesses through a shard update the parent's
+ * sets; mergeCacheShard adds the counters back. Shards used at the same
+ * time must touch disjoint sets. Returns NULL on failure.
+ *
+ * @param       cache       parent cache
+ *
+ * @return      success     new shard
+ * @return      failure     NULL
+ */
+
+Cache createCacheShard(Cache cache);
+
+/* mergeCacheShard
+ *
+ * Adds a shard's counters to its parent and frees the shard (but not
+ * the shared tag store). The parent's access clock becomes the total # of
+ * accesses seen by all merged shards.
+ *
+ * @param       cache       parent cache
+ * @param       shard       shard created from 'cache'
+ *
+ * @return      void
+ */
+
+void mergeCacheShard(Cache cache, Cache shard);
+
+/* printCache
+ *
+ * Prints out the values of each slot in the cache
+ * as well as the hit, miss, read, write, and size
+ * data.
+ *
+ * @param       cache       Cache struct
+ *
+ * @return      void
+ */
+
+void printCache(Cache cache);
+
+/* dumpCache
+ *
+ * Prints the valid, dirty, policy state, and tag of every way of every
+ * set, as the [-d] arg does in printCache.
+ *
+ * @param       cache       Cache struct
+ *
+ * @return      void
+ */
+
+void dumpCache(Cache cache);
+
+/* printSummary
+ *
+ * Prints one row per cache with its geometry and headline statistics,
+ * so the configurations of a sweep can be compared side by side.
+ *
+ * @param       caches      array of Cache structs
+ * @param       count       # of caches
+ *
+ * @return      void
+ */
+
+void printSummary(Cache *caches, int count);
+
+#endif
+/* CACHESIM_H */
@@ -0,0 +1,280 @@
+/* File: Checkpoint.c
+ *
+ * Cache state snapshots. See Checkpoint.h for the layout.
+ *
+ * The header is encoded field by field; the tag store is written and
+ * mapped as raw bytes. Where the page size does not divide the header
+ * (pages over 4 KB) the tag store is read into anonymous memory
+ * instead, so the caller always releases it with munmap.
+ *
+ * A checkpoint is written to a temporary file next to its target and
+ * renamed over it once complete. The run may still have the old file
+ * mapped (saving to the file it resumed from), and truncating that file
+ * in place would pull the pages out from under the mapping.
+ *
+ */
+
+/********************************
+ *     1. Includes              *
+ *******************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "Checkpoint.h"
+
+/********************************
+ *     2. Utility Functions     *
+ ********************************/
+
+/* putLE / getLE
+ *
+ * Store and load little endian integers of 'bytes' bytes.
+ */
+
+static void putLE(unsigned char *out, uint64_t value, int bytes) {
+
+    int i;
+
+    for(i = 0; i < bytes; i++) {
+        out[i] = (unsigned char) (value >> (8 * i));
+    }
+}
+
+static uint64_t getLE(const unsigned char *in, int bytes) {
+
+    uint64_t value = 0;
+    int i;
+
+    for(i = 0; i < bytes; i++) {
+        value |= (uint64_t) in[i] << (8 * i);
+    }
+
+    return value;
+}
+
+/* putCounters / getCounters
+ *
+ * Store and load the counters at bytes 48 - 135 of the header.
+ */
+
+static void putCounters(unsigned char *out, const CacheCounters *c) {
+
+    const long long values[11] = {
+        c->accesses, c->reads, c->read_hits, c->read_misses, c->writes, c->write_hits,
+        c->write_misses, c->evictions, c->stream_ins, c->stream_outs, c->cycles,
+    };
+    int i;
+
+    for(i = 0; i < 11; i++) {
+        putLE(out + 8 * i, (uint64_t) values[i], 8);
+    }
+}
+
+static void getCounters(const unsigned char *in, CacheCounters *c) {
+
+    c->accesses = (long long) getLE(in, 8);
+    c->reads = (long long) getLE(in + 8, 8);
+    c->read_hits = (long long) getLE(in + 16, 8);
+    c->read_misses = (long long) getLE(in + 24, 8);
+    c->writes = (long long) getLE(in + 32, 8);
+    c->write_hits = (long long) getLE(in + 40, 8);
+    c->write_misses = (long long) getLE(in + 48, 8);
+    c->evictions = (long long) getLE(in + 56, 8);
+    c->stream_ins = (long long) getLE(in + 64, 8);
+    c->stream_outs = (long long) getLE(in + 72, 8);
+    c->cycles = (long long) getLE(in + 80, 8);
+}
+
+/* readAll
+ *
+ * Reads 'size' bytes at 'offset', retrying short reads.
+ */
+
+static int readAll(int fd, void *out, size_t size, off_t offset) {
+
+    unsigned char *p = (unsigned char *) out;
+    ssize_t n;
+
+    while(size > 0) {
+
+        n = pread(fd, p, size, offset);
+
+        if(n <= 0) {
+            return -1;
+        }
+
+        p += n;
+        size -= (size_t) n;
+        offset += n;
+    }
+
+    return 0;
+}
+
+/********************************
+ *     3. Interface             *
+ ********************************/
+
+int writeCheckpoint(const char *path, const CheckpointInfo *info, const void *sets) {
+
+    unsigned char header[CHECKPOINT_HEADER_SIZE];
+    uint64_t order = CHECKPOINT_BYTE_ORDER;
+    FILE *file;
+    char *temp;
+    int failed;
+    int fd;
+
+    memset(header, 0, sizeof(header));
+    memcpy(header, CHECKPOINT_MAGIC, 4);
+    putLE(header + 4, CHECKPOINT_VERSION, 2);
+    putLE(header + 6, (uint64_t) info->address_size, 2);
+    putLE(header + 8, (uint64_t) info->number_of_sets, 4);
+    putLE(header + 12, (uint64_t) info->associativity, 4);
+    putLE(header + 16, (uint64_t) info->block_size, 4);
+    putLE(header + 20, (uint64_t) info->policy, 4);
+    putLE(header + 24, info->set_stride, 8);
+    putLE(header + 32, info->bytes, 8);
+    memcpy(header + 40, &order, 8);
+    putCounters(header + 48, &info->counters);
+    putLE(header + 136, info->rng, 8);
+    putLE(header + 144, (uint64_t) (uint32_t) info->psel, 4);
+    putLE(header + 152, info->trace_offset, 8);
+
+    /* write beside the target, then rename over it */
+
+    temp = (char *) malloc(strlen(path) + 5);
+
+    if(temp == NULL) {
+        fprintf(stderr, "Error: could not allocate memory for checkpoint path.\n");
+        return -1;
+    }
+
+    sprintf(temp, "%s.tmp", path);
+    fd = open(temp, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    file = (fd < 0) ? NULL : fdopen(fd, "wb");
+
+    if(file == NULL) {
+        fprintf(stderr, "Error: Could not create checkpoint %s.\n", path);
+        if(fd >= 0) {
+            close(fd);
+            unlink(temp);
+        }
+        free(temp);
+        return -1;
+    }
+
+    failed = fwrite(header, 1, sizeof(header), file) != sizeof(header) ||
+             fwrite(sets, 1, (size_t) info->bytes, file) != (size_t) info->bytes;
+
+    if(fclose(file) != 0) {
+        failed = 1;
+    }
+
+    if(!failed && rename(temp, path) != 0) {
+        failed = 1;
+    }
+
+    if(failed) {
+        fprintf(stderr, "Error: Could not write checkpoint %s.\n", path);
+        unlink(temp);
+        free(temp);
+        return -1;
+    }
+
+    free(temp);
+    return 0;
+}
+
+void *mapCheckpoint(const char *path, CheckpointInfo *info) {
+
+    unsigned char header[CHECKPOINT_HEADER_SIZE];
+    uint64_t order;
+    struct stat st;
+    long page;
+    void *sets;
+    int fd;
+
+    fd = open(path, O_RDONLY);
+
+    if(fd < 0 || fstat(fd, &st) != 0) {
+        fprintf(stderr, "Error: Could not open checkpoint %s.\n", path);
+        if(fd >= 0) close(fd);
+        return NULL;
+    }
+
+    if(readAll(fd, header, sizeof(header), 0) != 0 || memcmp(header, CHECKPOINT_MAGIC, 4) != 0) {
+        fprintf(stderr, "Error: %s is not a checkpoint.\n", path);
+        close(fd);
+        return NULL;
+    }
+
+    if(getLE(header + 4, 2) != CHECKPOINT_VERSION) {
+        fprintf(stderr, "Error: %s is checkpoint version %d; only version %d is supported.\n", path, (int) getLE(header + 4, 2), CHECKPOINT_VERSION);
+        close(fd);
+        return NULL;
+    }
+
+    memcpy(&order, header + 40, 8);
+
+    if(order != CHECKPOINT_BYTE_ORDER) {
+        fprintf(stderr, "Error: %s was written on a machine of the other byte order.\n", path);
+        close(fd);
+        return NULL;
+    }
+
+    info->address_size = (int) getLE(header + 6, 2);
+    info->number_of_sets = (int) getLE(header + 8, 4);
+    info->associativity = (int) getLE(header + 12, 4);
+    info->block_size = (int) getLE(header + 16, 4);
+    info->policy = (int) getLE(header + 20, 4);
+    info->set_stride = getLE(header + 24, 8);
+    info->bytes = getLE(header + 32, 8);
+    getCounters(header + 48, &info->counters);
+    info->rng = getLE(header + 136, 8);
+    info->psel = (int) (uint32_t) getLE(header + 144, 4);
+    info->trace_offset = getLE(header + 152, 8);
+
+    if(info->bytes == 0 || (uint64_t) st.st_size != CHECKPOINT_HEADER_SIZE + info->bytes) {
+        fprintf(stderr, "Error: checkpoint %s is truncated.\n", path);
+        close(fd);
+        return NULL;
+    }
+
+    /* map the tag store in place; pages the header does not fill
+     * up exactly get a private copy */
+
+    page = sysconf(_SC_PAGESIZE);
+
+    if(page > 0 && CHECKPOINT_HEADER_SIZE % page == 0) {
+        sets = mmap(NULL, (size_t) info->bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, CHECKPOINT_HEADER_SIZE);
+    }
+    else {
+        sets = mmap(NULL, (size_t) info->bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if(sets != MAP_FAILED && readAll(fd, sets, (size_t) info->bytes, CHECKPOINT_HEADER_SIZE) != 0) {
+            munmap(sets, (size_t) info->bytes);
+            sets = MAP_FAILED;
+        }
+    }
+
+    close(fd);
+
+    if(sets == MAP_FAILED) {
+        fprintf(stderr, "Error: could not map checkpoint %s into memory.\n", path);
+        return NULL;
+    }
+
+    return sets;
+}
+
+void unmapCheckpoint(void *sets, uint64_t bytes) {
+
+    if(sets != NULL) {
+        munmap(sets, (size_t) bytes);
+    }
+}
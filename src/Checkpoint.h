@@ -0,0 +1,129 @@
+/* File: Checkpoint.h
+ *
+ * Snapshots of a cache's state, for warm starts and resumed runs.
+ *
+ * A checkpoint holds everything the single-cache simulation carries from
+ * one access to the next: the tag store with its valid and dirty bits and
+ * per-set replacement metadata, the cache-wide replacement state, the
+ * counters, and where in the trace it was taken. Restoring it with the
+ * counters ("-resume") continues the run as if it had never stopped;
+ * restoring it without ("-warm") starts a new trace on a cache that is
+ * already warm.
+ *
+ * The file starts with a header page, all fields little endian:
+ *
+ *      bytes   0 -   3   magic "CSCP"
+ *      bytes   4 -   5   format version (1)
+ *      bytes   6 -   7   address width in bits
+ *      bytes   8 -  11   # of sets
+ *      bytes  12 -  15   associativity
+ *      bytes  16 -  19   block size in bytes
+ *      bytes  20 -  23   replacement policy (POLICY_*)
+ *      bytes  24 -  31   bytes per set record
+ *      bytes  32 -  39   bytes of tag store
+ *      bytes  40 -  47   byte order mark, in the writer's byte order
+ *      bytes  48 - 135   counters, in CacheCounters order
+ *      bytes 136 - 143   replacement rng state
+ *      bytes 144 - 147   DRRIP selector
+ *      bytes 148 - 151   reserved (0)
+ *      bytes 152 - 159   text trace byte offset after the last access
+ *      bytes 160 - 4095  reserved (0)
+ *
+ * followed by the tag store exactly as it is laid out in memory. The
+ * tag store is in the writer's byte order, so a checkpoint only loads on
+ * a machine of the same endianness; the byte order mark catches the
+ * rest. Because the tag store starts on a page boundary it is mapped
+ * copy-on-write straight from the file: a restore reads the header and
+ * the pages the simulation touches, not the whole snapshot.
+ *
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+#include "CacheSim.h"
+
+/* Format constants */
+#define CHECKPOINT_MAGIC "CSCP"
+#define CHECKPOINT_VERSION 1
+#define CHECKPOINT_HEADER_SIZE 4096
+#define CHECKPOINT_BYTE_ORDER 0x0102030405060708ull
+
+/* CheckpointInfo
+ *
+ * The header of a checkpoint.
+ *
+ * @param   address_size    address width in bits
+ * @param   number_of_sets  # of sets
+ * @param   associativity   # of ways
+ * @param   block_size      block size in bytes
+ * @param   policy          replacement policy (POLICY_*)
+ * @param   set_stride      bytes per set record
+ * @param   bytes           bytes of tag store
+ * @param   counters        the cache's counters
+ * @param   rng             replacement rng state
+ * @param   psel            DRRIP selector
+ * @param   trace_offset    text trace byte offset after the last access
+ */
+
+typedef struct {
+    int address_size;
+    int number_of_sets;
+    int associativity;
+    int block_size;
+    int policy;
+    uint64_t set_stride;
+    uint64_t bytes;
+    CacheCounters counters;
+    uint64_t rng;
+    int psel;
+    unsigned long long trace_offset;
+} CheckpointInfo;
+
+/* writeCheckpoint
+ *
+ * Writes a checkpoint of 'info->bytes' of tag store. The file is
+ * replaced only once the new one is complete, so 'path' may be the
+ * checkpoint the tag store is mapped from. Returns 0 on success and -1
+ * on failure.
+ *
+ * @param   path            checkpoint file
+ * @param   info            header fields
+ * @param   sets            the tag store
+ *
+ * @return  success         0
+ * @return  failure         -1
+ */
+
+int writeCheckpoint(const char *path, const CheckpointInfo *info, const void *sets);
+
+/* mapCheckpoint
+ *
+ * Reads a checkpoint's header into 'info' and maps its tag store
+ * copy-on-write, so the caller may change it without touching the file.
+ * Returns NULL on failure.
+ *
+ * @param   path            checkpoint file
+ * @param   info            output: header fields
+ *
+ * @return  success         tag store, 'info->bytes' long and page aligned
+ * @return  failure         NULL
+ */
+
+void *mapCheckpoint(const char *path, CheckpointInfo *info);
+
+/* unmapCheckpoint
+ *
+ * Releases a tag store returned by mapCheckpoint.
+ *
+ * @param   sets            tag store
+ * @param   bytes           its size
+ *
+ * @return  void
+ */
+
+void unmapCheckpoint(void *sets, uint64_t bytes);
+
+#endif
+/* CHECKPOINT_H */
@@ -0,0 +1,774 @@
+/* File: Coherence.c
+ *
+ * Multicore simulation with coherent private caches. See Coherence.h
+ * for the protocol and the threading model.
+ *
+ * Core c's reader thread is the producer on its ring (Ring.h) and the
+ * bus is the one consumer. The bus keeps the batch it is taking
+ * accesses from until it has taken every one of them.
+ *
+ */
+
+/********************************
+ *     1. Includes              *
+ *******************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "Coherence.h"
+#include "Ring.h"
+#include "Policy.h"
+#include "BinTrace.h"
+#include "TextTrace.h"
+
+/********************************
+ *     2. Structs & Globals     *
+ ********************************/
+
+/* Batch
+ *
+ * A run of decoded accesses from one core's trace.
+ */
+
+struct Batch_ {
+    int count;
+    uint64_t addresses[COHERENCE_BATCH];
+    unsigned char writes[COHERENCE_BATCH];
+};
+
+/* LostBlock
+ *
+ * A block a core lost to another core's write, and the words written
+ * by the writes that invalidated it.
+ */
+
+struct LostBlock_ {
+    uint64_t block;
+    unsigned int words;
+    bool used;
+};
+
+/* LostBlocks
+ *
+ * Open-addressing hash set of LostBlock entries (linear probing).
+ */
+
+struct LostBlocks_ {
+    struct LostBlock_* entries;
+    size_t capacity;
+    size_t count;
+};
+
+/* Core
+ *
+ * One core: its trace, its reader thread and ring, its private cache,
+ * and its statistics.
+ *
+ * @param   batches                 batches in flight, one per ring slot
+ * @param   ring                    hands the batches to the bus
+ * @param   failed                  the reader hit a malformed trace
+ * @param   batch                   bus side: batch being read, or NULL
+ * @param   position                bus side: next access in that batch
+ * @param   finished                bus side: every access has been taken
+ * @param   lost                    blocks lost to other cores' writes
+ * @param   coherence_misses        misses on a block in 'lost'
+ * @param   true_sharing            ... that touched a word written by the invalidating write
+ * @param   false_sharing           ... that did not
+ * @param   upgrades                write hits on a shared block (BusUpgr)
+ * @param   invalidations_sent      copies this core's writes invalidated
+ * @param   invalidations_received  copies of this core's invalidated by others
+ * @param   transfers_in            misses filled by another cache
+ * @param   transfers_out           blocks supplied to another cache
+ * @param   evictions               valid blocks evicted
+ * @param   writebacks              dirty blocks written to memory
+ */
+
+struct Core_ {
+    struct Batch_ batches[COHERENCE_RING];
+    Ring ring;
+    atomic_bool failed;
+    pthread_t thread;
+    const char* path;
+    TextTrace text;
+    BinaryTrace trace;
+    Cache cache;
+    struct Batch_* batch;
+    int position;
+    bool finished;
+    struct LostBlocks_ lost;
+    long long reads;
+    long long read_hits;
+    long long read_misses;
+    long long writes;
+    long long write_hits;
+    long long write_misses;
+    long long coherence_misses;
+    long long true_sharing;
+    long long false_sharing;
+    long long upgrades;
+    long long invalidations_sent;
+    long long invalidations_received;
+    long long transfers_in;
+    long long transfers_out;
+    long long evictions;
+    long long writebacks;
+};
+
+/* Coherence
+ *
+ * @param   cores               cores, in bus order
+ * @param   count               # of cores
+ * @param   protocol            PROTOCOL_MESI or PROTOCOL_MOESI
+ * @param   quantum             accesses per core per turn
+ * @param   block_size          block size of every private cache
+ * @param   word_size           granularity of the true/false sharing test
+ * @param   bus_reads           # of BusRd transactions (read misses)
+ * @param   bus_read_exclusives # of BusRdX transactions (write misses)
+ * @param   bus_upgrades        # of BusUpgr transactions
+ * @param   transfers           # of cache-to-cache transfers
+ * @param   memory_reads        # of blocks read from memory
+ * @param   memory_writes       # of blocks written to memory
+ */
+
+struct Coherence_ {
+    struct Core_* cores;
+    int count;
+    int protocol;
+    int quantum;
+    int block_size;
+    int word_size;
+    long long bus_reads;
+    long long bus_read_exclusives;
+    long long bus_upgrades;
+    long long transfers;
+    long long memory_reads;
+    long long memory_writes;
+};
+
+static const char *protocolNames[] = { "mesi", "moesi" };
+
+/********************************
+ *     3. Lost Blocks           *
+ ********************************/
+
+/* lostSlot
+ *
+ * Returns the slot holding 'block', or the empty slot where it belongs.
+ */
+
+static size_t lostSlot(const struct LostBlocks_ *lost, uint64_t block) {
+
+    size_t mask = lost->capacity - 1;
+    size_t slot = (size_t) ((block * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+
+    while(lost->entries[slot].used && lost->entries[slot].block != block) {
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+/* addLost
+ *
+ * Records that 'block' was invalidated by a write to 'words'.
+ */
+
+static void addLost(struct LostBlocks_ *lost, uint64_t block, unsigned int words) {
+
+    struct LostBlock_ *old;
+    size_t capacity, slot, k;
+
+    /* keep the table at most half full */
+
+    if(2 * (lost->count + 1) > lost->capacity) {
+
+        old = lost->entries;
+        capacity = lost->capacity;
+
+        lost->capacity = capacity ? 2 * capacity : 1024;
+        lost->entries = (struct LostBlock_*) calloc(lost->capacity, sizeof(struct LostBlock_));
+        assert(lost->entries != NULL);
+
+        for(k = 0; k < capacity; k++) {
+            if(old[k].used) {
+                lost->entries[lostSlot(lost, old[k].block)] = old[k];
+            }
+        }
+
+        free(old);
+    }
+
+    slot = lostSlot(lost, block);
+
+    if(!lost->entries[slot].used) {
+        lost->entries[slot].used = true;
+        lost->entries[slot].block = block;
+        lost->entries[slot].words = 0;
+        lost->count++;
+    }
+
+    lost->entries[slot].words |= words;
+}
+
+/* takeLost
+ *
+ * Removes 'block' from the set. Returns 1 and the words written if it
+ * was there, or 0. Later entries of the probe run are shifted back so
+ * that no tombstones are needed.
+ */
+
+static int takeLost(struct LostBlocks_ *lost, uint64_t block, unsigned int *words) {
+
+    size_t mask, hole, slot, home;
+
+    if(lost->count == 0) {
+        return 0;
+    }
+
+    mask = lost->capacity - 1;
+    hole = lostSlot(lost, block);
+
+    if(!lost->entries[hole].used) {
+        return 0;
+    }
+
+    *words = lost->entries[hole].words;
+    lost->entries[hole].used = false;
+    lost->count--;
+
+    for(slot = (hole + 1) & mask; lost->entries[slot].used; slot = (slot + 1) & mask) {
+
+        home = (size_t) ((lost->entries[slot].block * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+
+        /* move the entry into the hole unless its home lies in (hole, slot] */
+
+        if(((slot - home) & mask) >= ((slot - hole) & mask)) {
+            lost->entries[hole] = lost->entries[slot];
+            lost->entries[slot].used = false;
+            hole = slot;
+        }
+    }
+
+    return 1;
+}
+
+/********************************
+ *     4. Reader Threads        *
+ ********************************/
+
+/* runReader
+ *
+ * Decodes this core's trace into its ring until the trace ends.
+ */
+
+static void *runReader(void *arg) {
+
+    struct Core_* core = (struct Core_*) arg;
+    struct Batch_* batch;
+    int slot, n;
+
+    /* a slot comes back once the bus has taken its batch, or never
+     * if the run is abandoned */
+
+    while((slot = ringClaim(core->ring)) >= 0) {
+
+        batch = &core->batches[slot];
+
+        if(core->trace != NULL) {
+            n = readBinaryTrace(core->trace, batch->addresses, batch->writes, COHERENCE_BATCH);
+        }
+        else {
+            n = readTextTrace(core->text, batch->addresses, batch->writes, COHERENCE_BATCH);
+        }
+
+        if(n < 0) {
+            atomic_store_explicit(&core->failed, true, memory_order_relaxed);
+        }
+
+        if(n <= 0) {
+            break;
+        }
+
+        batch->count = n;
+        ringPublish(core->ring);
+    }
+
+    ringFinish(core->ring);
+
+    return NULL;
+}
+
+/* nextAccess
+ *
+ * Takes the core's next access off its ring, waiting for the reader if
+ * needed. Returns 0 once the trace is exhausted.
+ */
+
+static int nextAccess(struct Core_ *core, uint64_t *address, int *write) {
+
+    int slot;
+
+    while(true) {
+
+        if(core->batch == NULL) {
+
+            if((slot = ringConsume(core->ring, 0)) < 0) {
+                return 0;
+            }
+
+            core->batch = &core->batches[slot];
+            core->position = 0;
+        }
+
+        if(core->position < core->batch->count) {
+            *address = core->batch->addresses[core->position];
+            *write = core->batch->writes[core->position];
+            core->position++;
+            return 1;
+        }
+
+        /* hand the slot back to the reader */
+
+        core->batch = NULL;
+        ringRelease(core->ring, 0);
+    }
+}
+
+/********************************
+ *     5. Protocol              *
+ ********************************/
+
+/* wordMask
+ *
+ * Returns the bit of the word 'address' falls in within its block.
+ */
+
+static unsigned int wordMask(Coherence coherence, uint64_t address) {
+    return 1u << (((unsigned int) address & (coherence->block_size - 1)) / coherence->word_size);
+}
+
+/* invalidateOthers
+ *
+ * Invalidates every other core's copy of a block for a write by core c.
+ * Returns the core whose copy was dirty (it supplies the data), or -1.
+ */
+
+static int invalidateOthers(Coherence coherence, int c, uint64_t address) {
+
+    struct Core_ *core = &coherence->cores[c];
+    struct Core_ *other;
+    uint64_t block = address & ~(uint64_t) (coherence->block_size - 1);
+    int o, dirty, supplier = -1;
+
+    for(o = 0; o < coherence->count; o++) {
+
+        other = &coherence->cores[o];
+
+        if(o == c || !invalidateBlock(other->cache, address, &dirty)) {
+            continue;
+        }
+
+        core->invalidations_sent++;
+        other->invalidations_received++;
+        addLost(&other->lost, block, wordMask(coherence, address));
+
+        if(dirty) {
+            supplier = o;
+        }
+    }
+
+    return supplier;
+}
+
+/* shareOthers
+ *
+ * Snoops a read miss by core c: every other copy becomes shared. Under
+ * MESI a modified copy is written back first; under MOESI it becomes
+ * owned. Returns 1 if another cache had the block, and sets 'supplier'
+ * to the core holding it dirty, if any.
+ */
+
+static int shareOthers(Coherence coherence, int c, uint64_t address, int *supplier) {
+
+    struct Core_ *other;
+    int o, state, shared = 0;
+
+    *supplier = -1;
+
+    for(o = 0; o < coherence->count; o++) {
+
+        other = &coherence->cores[o];
+
+        if(o == c || !((state = probeBlock(other->cache, address)) & BLOCK_VALID)) {
+            continue;
+        }
+
+        shared = 1;
+
+        if(state & BLOCK_DIRTY) {
+
+            *supplier = o;
+
+            if(coherence->protocol == PROTOCOL_MESI) {
+                other->writebacks++;
+                coherence->memory_writes++;
+                state &= ~BLOCK_DIRTY;
+            }
+        }
+
+        setBlockState(other->cache, address, state | BLOCK_SHARED);
+    }
+
+    return shared;
+}
+
+/* coherentAccess
+ *
+ * Runs one access of core c through its cache and the bus.
+ */
+
+static void coherentAccess(Coherence coherence, int c, uint64_t address, int write) {
+
+    struct Core_ *core = &coherence->cores[c];
+    BlockVictim victim;
+    unsigned int words;
+    int state, supplier, shared;
+
+    state = probeBlock(core->cache, address);
+
+    if(write) {
+        core->writes++;
+    }
+    else {
+        core->reads++;
+    }
+
+    /* Hits: only a write to a shared (S or O) block needs the bus */
+
+    if(state & BLOCK_VALID) {
+
+        if(!write) {
+            core->read_hits++;
+            accessBlock(core->cache, address, 0, 0, NULL);
+            return;
+        }
+
+        core->write_hits++;
+
+        if(state & BLOCK_SHARED) {
+            core->upgrades++;
+            coherence->bus_upgrades++;
+            invalidateOthers(coherence, c, address);
+        }
+
+        /* E, S, O -> M */
+
+        accessBlock(core->cache, address, 1, 0, NULL);
+        setBlockState(core->cache, address, BLOCK_VALID | BLOCK_DIRTY);
+        return;
+    }
+
+    /* Misses */
+
+    if(write) {
+        core->write_misses++;
+    }
+    else {
+        core->read_misses++;
+    }
+
+    if(takeLost(&core->lost, address & ~(uint64_t) (coherence->block_size - 1), &words)) {
+
+        core->coherence_misses++;
+
+        if(words & wordMask(coherence, address)) {
+            core->true_sharing++;
+        }
+        else {
+            core->false_sharing++;
+        }
+    }
+
+    if(write) {
+
+        /* BusRdX: a dirty copy hands its data over, every copy goes */
+
+        coherence->bus_read_exclusives++;
+        supplier = invalidateOthers(coherence, c, address);
+        shared = 0;
+    }
+    else {
+
+        /* BusRd: E if no one else has the block, otherwise S */
+
+        coherence->bus_reads++;
+        shared = shareOthers(coherence, c, address, &supplier);
+    }
+
+    /* clean copies do not supply data: memory does */
+
+    if(supplier >= 0) {
+        coherence->transfers++;
+        core->transfers_in++;
+        coherence->cores[supplier].transfers_out++;
+    }
+    else {
+        coherence->memory_reads++;
+    }
+
+    accessBlock(core->cache, address, write, 1, &victim);
+
+    if(shared) {
+        setBlockState(core->cache, address, BLOCK_VALID | BLOCK_SHARED);
+    }
+
+    /* M and O victims are written back; sharers of an O block keep
+     * clean copies */
+
+    if(victim.valid) {
+
+        core->evictions++;
+
+        if(victim.dirty) {
+            core->writebacks++;
+            coherence->memory_writes++;
+        }
+    }
+}
+
+/********************************
+ *     6. Simulation            *
+ ********************************/
+
+int parseProtocol(const char *name) {
+
+    int protocol;
+
+    for(protocol = 0; protocol < (int) (sizeof(protocolNames) / sizeof(protocolNames[0])); protocol++) {
+        if(strcmp(name, protocolNames[protocol]) == 0) {
+            return protocol;
+        }
+    }
+
+    return -1;
+}
+
+Coherence createCoherence(const char **paths, int cores, int number_of_sets, int associativity, int block_size,
+                          int address_size, int policy, unsigned int seed, int protocol, int quantum) {
+
+    Coherence coherence;
+    struct Core_ *core;
+    int c;
+
+    /* Validate Inputs */
+    if(cores < 1 || cores > MAX_CORES) {
+        fprintf(stderr, "Error: Number of cores must be between 1 and %d!\n", MAX_CORES);
+        return NULL;
+    }
+
+    if(quantum < 1) {
+        fprintf(stderr, "Error: Quantum must be at least one access!\n");
+        return NULL;
+    }
+
+    coherence = (Coherence) calloc(1, sizeof(struct Coherence_));
+
+    if(coherence != NULL) {
+        coherence->cores = (struct Core_*) malloc(sizeof(struct Core_) * cores);
+    }
+
+    if(coherence == NULL || coherence->cores == NULL) {
+        fprintf(stderr, "Error: could not allocate memory for cores.\n");
+        free(coherence);
+        return NULL;
+    }
+
+    memset(coherence->cores, 0, sizeof(struct Core_) * cores);
+
+    coherence->protocol = protocol;
+    coherence->quantum = quantum;
+    coherence->block_size = block_size;
+
+    /* 4-byte words, or 32 words per block for blocks over 128 bytes */
+
+    coherence->word_size = (block_size / 32 > 4) ? block_size / 32 : 4;
+
+    if(coherence->word_size > block_size) {
+        coherence->word_size = block_size;
+    }
+
+    for(c = 0; c < cores; c++) {
+
+        core = &coherence->cores[c];
+        core->path = paths[c];
+
+        atomic_init(&core->failed, false);
+
+        core->ring = createRing(COHERENCE_RING, 1);
+        core->cache = (core->ring != NULL) ? createCache(number_of_sets, associativity, block_size, address_size, policy, seed) : NULL;
+
+        if(core->cache != NULL) {
+            if(isBinaryTrace(paths[c])) {
+                core->trace = openBinaryTrace(paths[c]);
+            }
+            else {
+                core->text = openTextTrace(paths[c]);
+            }
+        }
+
+        /* count this core so destroyCoherence cleans it up */
+
+        coherence->count = c + 1;
+
+        if(core->cache == NULL || (core->trace == NULL && core->text == NULL)) {
+            destroyCoherence(coherence);
+            return NULL;
+        }
+    }
+
+    return coherence;
+}
+
+int runCoherence(Coherence coherence) {
+
+    struct Core_ *core;
+    uint64_t address;
+    int write, active, started, c, q;
+    int result = 0;
+
+    for(started = 0; started < coherence->count; started++) {
+        if(pthread_create(&coherence->cores[started].thread, NULL, runReader, &coherence->cores[started]) != 0) {
+            fprintf(stderr, "Error: could not start core reader thread.\n");
+            result = -1;
+            break;
+        }
+    }
+
+    /* Round-robin: 'quantum' accesses from each core that has any left */
+
+    active = (result == 0) ? coherence->count : 0;
+
+    while(active > 0) {
+
+        for(c = 0; c < coherence->count; c++) {
+
+            core = &coherence->cores[c];
+
+            for(q = 0; q < coherence->quantum && !core->finished; q++) {
+
+                if(nextAccess(core, &address, &write)) {
+                    coherentAccess(coherence, c, address, write);
+                }
+                else {
+                    core->finished = true;
+                    active--;
+                }
+            }
+        }
+    }
+
+    /* if a reader failed to start, nothing was simulated: stop the
+     * readers that did start instead of waiting for their traces */
+
+    for(c = 0; c < started; c++) {
+
+        core = &coherence->cores[c];
+
+        if(result != 0) {
+            ringCancel(core->ring);
+        }
+
+        pthread_join(core->thread, NULL);
+
+        if(atomic_load_explicit(&core->failed, memory_order_relaxed)) {
+            result = -1;
+        }
+    }
+
+    return result;
+}
+
+void printCoherence(Coherence coherence, int dump) {
+
+    struct Core_ *core;
+    long long total, hits, misses;
+    int c;
+
+    for(c = 0; c < coherence->count; c++) {
+
+        core = &coherence->cores[c];
+
+        total = core->reads + core->writes;
+        hits = core->read_hits + core->write_hits;
+        misses = core->read_misses + core->write_misses;
+
+        printf("\n\n******** Core %d: %s ********\n", c, core->path);
+
+        if(dump) {
+            dumpCache(core->cache);
+        }
+
+        printf("\nCore performance:\n\n");
+
+        printf("\tAttempted reads: %lld\n", core->reads);
+        printf("\tCache read hits: %lld\n", core->read_hits);
+        printf("\tCache read misses: %lld\n\n", core->read_misses);
+
+        printf("\tAttempted writes: %lld\n", core->writes);
+        printf("\tCache write hits: %lld\n", core->write_hits);
+        printf("\tCache write misses: %lld\n\n", core->write_misses);
+
+        printf("\tCache hit ratio: %2.2f%%\n", total ? ((float) hits / (float) total) * 100 : 0.0);
+        printf("\tCache miss ratio: %2.2f%%\n\n", total ? ((float) misses / (float) total) * 100 : 0.0);
+
+        printf("\tCoherence misses: %lld\n", core->coherence_misses);
+        printf("\tTrue sharing misses: %lld\n", core->true_sharing);
+        printf("\tFalse sharing misses: %lld\n\n", core->false_sharing);
+
+        printf("\tUpgrades: %lld\n", core->upgrades);
+        printf("\tInvalidations sent: %lld\n", core->invalidations_sent);
+        printf("\tInvalidations received: %lld\n", core->invalidations_received);
+        printf("\tCache-to-cache transfers in: %lld\n", core->transfers_in);
+        printf("\tCache-to-cache transfers out: %lld\n\n", core->transfers_out);
+
+        printf("\tCache evictions: %lld\n", core->evictions);
+        printf("\tWrite-backs: %lld\n", core->writebacks);
+    }
+
+    printf("\nCoherence performance (%s, %d cores, quantum %d):\n\n", protocolNames[coherence->protocol], coherence->count, coherence->quantum);
+
+    printf("\tBus reads: %lld\n", coherence->bus_reads);
+    printf("\tBus read-exclusives: %lld\n", coherence->bus_read_exclusives);
+    printf("\tBus upgrades: %lld\n\n", coherence->bus_upgrades);
+
+    printf("\tCache-to-cache transfers: %lld\n", coherence->transfers);
+    printf("\tMemory reads: %lld\n", coherence->memory_reads);
+    printf("\tMemory writes: %lld\n\n", coherence->memory_writes);
+}
+
+void destroyCoherence(Coherence coherence) {
+
+    struct Core_ *core;
+    int c;
+
+    if(coherence != NULL) {
+
+        for(c = 0; c < coherence->count; c++) {
+            core = &coherence->cores[c];
+            closeTextTrace(core->text);
+            closeBinaryTrace(core->trace);
+            destroyCache(core->cache);
+            destroyRing(core->ring);
+            free(core->lost.entries);
+        }
+
+        free(coherence->cores);
+        free(coherence);
+    }
+}
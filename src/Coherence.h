@@ -0,0 +1,128 @@
+/* File: Coherence.h
+ *
+ * Multicore simulation with coherent private caches.
+ *
+ * Every core has its own trace and a private Cache of the same
+ * geometry. The caches are kept coherent by a snooping MESI or MOESI
+ * protocol on a shared bus. A block's state is held in the cache's
+ * valid, dirty, and shared flags:
+ *
+ *      M   valid, dirty            E   valid, clean
+ *      O   valid, dirty, shared    S   valid, clean, shared
+ *
+ * A read miss (BusRd) takes the block from the cache holding it dirty
+ * (a cache-to-cache transfer) or else from memory, and every other
+ * copy becomes shared: under MESI a modified copy is written back and
+ * becomes S, under MOESI it becomes O and keeps the data dirty. A write
+ * miss (BusRdX) or a write hit on a shared block (BusUpgr) invalidates
+ * every other copy. A miss on a block this core lost to such an
+ * invalidation is a coherence miss. It counts as true sharing if it
+ * touches the word whose write invalidated the block, and as false
+ * sharing otherwise.
+ *
+ * Each core's trace is decoded on its own host thread into a ring of
+ * batches (Ring.h). The main thread owns the bus: it takes 'quantum'
+ * accesses from each core in turn, round-robin, so the interleaving,
+ * and with it every result, does not depend on how the threads are
+ * scheduled.
+ *
+ */
+
+#ifndef COHERENCE_H
+#define COHERENCE_H
+
+#include "CacheSim.h"
+
+/* Limits and defaults */
+#define MAX_CORES 64
+#define DEFAULT_QUANTUM 1
+
+/* Accesses per batch and batches in flight per core */
+#define COHERENCE_BATCH 4096
+#define COHERENCE_RING 4
+
+/* Protocols */
+enum {
+    PROTOCOL_MESI,
+    PROTOCOL_MOESI
+};
+
+/* Typedefs */
+typedef struct Coherence_* Coherence;
+
+/* parseProtocol
+ *
+ * Returns the protocol with the given name ("mesi", "moesi"), or -1 if
+ * there is none.
+ *
+ * @param   name            protocol name
+ *
+ * @return  success         protocol
+ * @return  failure         -1
+ */
+
+int parseProtocol(const char *name);
+
+/* createCoherence
+ *
+ * Opens every core's trace and creates its private cache. Returns NULL
+ * (after printing an error) on failure.
+ *
+ * @param   paths           trace file of each core
+ * @param   cores           # of cores (1 - MAX_CORES)
+ * @param   number_of_sets  # of sets of each private cache
+ * @param   associativity   # of ways
+ * @param   block_size      block size in bytes
+ * @param   address_size    width of a memory address in bits
+ * @param   policy          replacement policy
+ * @param   seed            seed for the policies that make random choices
+ * @param   protocol        PROTOCOL_MESI or PROTOCOL_MOESI
+ * @param   quantum         accesses a core runs before the next core's turn
+ *
+ * @return  success         new Coherence
+ * @return  failure         NULL
+ */
+
+Coherence createCoherence(const char **paths, int cores, int number_of_sets, int associativity, int block_size,
+                          int address_size, int policy, unsigned int seed, int protocol, int quantum);
+
+/* runCoherence
+ *
+ * Starts the reader threads and simulates every trace to its end.
+ * A malformed trace is reported by its reader.
+ *
+ * @param   coherence       target simulation
+ *
+ * @return  success         0
+ * @return  failure         -1
+ */
+
+int runCoherence(Coherence coherence);
+
+/* printCoherence
+ *
+ * Prints every core's statistics (and cache contents, if 'dump' is
+ * set) followed by the bus and memory traffic.
+ *
+ * @param   coherence       target simulation
+ * @param   dump            also print each core's cache contents
+ *
+ * @return  void
+ */
+
+void printCoherence(Coherence coherence, int dump);
+
+/* destroyCoherence
+ *
+ * Closes the traces, destroys the caches, and frees the simulation.
+ * Passing NULL does nothing.
+ *
+ * @param   coherence       simulation to destroy
+ *
+ * @return  void
+ */
+
+void destroyCoherence(Coherence coherence);
+
+#endif
+/* COHERENCE_H */
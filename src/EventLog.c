@@ -0,0 +1,392 @@
+/* File: EventLog.c
+ *
+ * Binary per-access event log. See EventLog.h for the layout.
+ *
+ * The simulation is the producer on the ring (Ring.h) and the writer
+ * thread is the one consumer. The writer encodes each batch into little
+ * endian records, writes it, and releases the slot to be refilled. The
+ * header's event count is filled in when the log is closed.
+ *
+ */
+
+/********************************
+ *     1. Includes              *
+ *******************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "EventLog.h"
+#include "Ring.h"
+
+/********************************
+ *     2. Structs               *
+ ********************************/
+
+/* Batch
+ *
+ * A run of events handed to the writer thread in one go.
+ */
+
+struct Batch_ {
+    int count;
+    EventRecord events[EVENTLOG_BATCH];
+};
+
+/* EventLog
+ *
+ * @param   batches         batches in flight, one per ring slot
+ * @param   ring            hands the batches to the writer
+ * @param   failed          a write has failed
+ * @param   thread          writer thread
+ * @param   filling         producer side: batch being filled
+ * @param   filter          events to keep
+ * @param   file            output file
+ * @param   encoded         writer side: records of the batch being written
+ * @param   total           # of events written
+ */
+
+struct EventLog_ {
+    struct Batch_ batches[EVENTLOG_RING];
+    Ring ring;
+    atomic_bool failed;
+    pthread_t thread;
+    struct Batch_* filling;
+    EventFilter filter;
+    FILE* file;
+    unsigned char encoded[EVENTLOG_BATCH * EVENTLOG_RECORD_SIZE];
+    long long total;
+};
+
+/* EventLogReader
+ *
+ * @param   file            log being decoded
+ * @param   left            # of events not yet decoded
+ */
+
+struct EventLogReader_ {
+    FILE* file;
+    uint64_t left;
+};
+
+/********************************
+ *     3. Utility Functions     *
+ ********************************/
+
+/* putLE / getLE
+ *
+ * Store and load little endian integers of 'bytes' bytes.
+ */
+
+static void putLE(unsigned char *out, uint64_t value, int bytes) {
+
+    int i;
+
+    for(i = 0; i < bytes; i++) {
+        out[i] = (unsigned char) (value >> (8 * i));
+    }
+}
+
+static uint64_t getLE(const unsigned char *in, int bytes) {
+
+    uint64_t value = 0;
+    int i;
+
+    for(i = 0; i < bytes; i++) {
+        value |= (uint64_t) in[i] << (8 * i);
+    }
+
+    return value;
+}
+
+/* writeHeader
+ *
+ * Writes the file header at the start of the file.
+ */
+
+static int writeHeader(FILE *file, const EventLogInfo *info, uint64_t events) {
+
+    unsigned char header[EVENTLOG_HEADER_SIZE];
+
+    memset(header, 0, sizeof(header));
+    memcpy(header, EVENTLOG_MAGIC, 4);
+    putLE(header + 4, EVENTLOG_VERSION, 2);
+    putLE(header + 6, info->address_size, 2);
+    putLE(header + 8, info->number_of_sets, 4);
+    putLE(header + 12, info->associativity, 4);
+    putLE(header + 16, info->block_size, 4);
+    putLE(header + 24, events, 8);
+
+    return (fwrite(header, 1, sizeof(header), file) == sizeof(header)) ? 0 : -1;
+}
+
+/* writeBatch
+ *
+ * Encodes a batch of events and writes it out.
+ */
+
+static void writeBatch(EventLog log, const struct Batch_ *batch) {
+
+    unsigned char *out = log->encoded;
+    unsigned char *record;
+    const EventRecord *event;
+    int i;
+
+    memset(out, 0, (size_t) batch->count * EVENTLOG_RECORD_SIZE);
+
+    for(i = 0; i < batch->count; i++) {
+
+        event = &batch->events[i];
+        record = out + (size_t) i * EVENTLOG_RECORD_SIZE;
+
+        putLE(record, event->access, 8);
+        putLE(record + 8, event->tag, 8);
+        putLE(record + 16, event->victim, 8);
+        putLE(record + 24, event->set, 4);
+        putLE(record + 28, event->cycles, 4);
+        putLE(record + 32, event->offset, 4);
+        record[36] = event->way;
+        record[37] = event->flags;
+    }
+
+    if(fwrite(out, EVENTLOG_RECORD_SIZE, batch->count, log->file) != (size_t) batch->count) {
+        atomic_store_explicit(&log->failed, true, memory_order_relaxed);
+    }
+
+    log->total += batch->count;
+}
+
+/********************************
+ *     4. Writer Thread         *
+ ********************************/
+
+/* runWriter
+ *
+ * Writes every published batch until the last one.
+ */
+
+static void *runWriter(void *arg) {
+
+    EventLog log = (EventLog) arg;
+    int slot;
+
+    while((slot = ringConsume(log->ring, 0)) >= 0) {
+        writeBatch(log, &log->batches[slot]);
+        ringRelease(log->ring, 0);
+    }
+
+    return NULL;
+}
+
+/* claimBatch
+ *
+ * Starts filling the next batch, waiting for the writer to free its
+ * slot if the whole ring is full.
+ */
+
+static void claimBatch(EventLog log) {
+
+    log->filling = &log->batches[ringClaim(log->ring)];
+    log->filling->count = 0;
+}
+
+/********************************
+ *     5. Interface             *
+ ********************************/
+
+void initEventFilter(EventFilter *filter) {
+
+    filter->first_set = 0;
+    filter->last_set = UINT32_MAX;
+    filter->match_tag = 0;
+    filter->tag = 0;
+    filter->first_access = 0;
+    filter->last_access = UINT64_MAX;
+}
+
+EventLog createEventLog(const char *path, const EventLogInfo *info, const EventFilter *filter) {
+
+    EventLog log;
+
+    log = (EventLog) calloc(1, sizeof(struct EventLog_));
+    assert(log != NULL);
+
+    log->file = fopen(path, "wb");
+
+    if(log->file == NULL) {
+        fprintf(stderr, "Error: Could not create event log %s.\n", path);
+        free(log);
+        return NULL;
+    }
+
+    if(writeHeader(log->file, info, 0) != 0) {
+        fprintf(stderr, "Error: Could not write event log %s.\n", path);
+        fclose(log->file);
+        free(log);
+        return NULL;
+    }
+
+    log->ring = createRing(EVENTLOG_RING, 1);
+
+    if(log->ring == NULL) {
+        fclose(log->file);
+        free(log);
+        return NULL;
+    }
+
+    atomic_init(&log->failed, false);
+    log->filter = *filter;
+    claimBatch(log);
+
+    if(pthread_create(&log->thread, NULL, runWriter, log) != 0) {
+        fprintf(stderr, "Error: could not start the event log writer thread.\n");
+        destroyRing(log->ring);
+        fclose(log->file);
+        free(log);
+        return NULL;
+    }
+
+    return log;
+}
+
+void eventLogRecord(EventLog log, const EventRecord *event) {
+
+    const EventFilter *filter = &log->filter;
+
+    if(event->set < filter->first_set || event->set > filter->last_set ||
+       event->access < filter->first_access || event->access > filter->last_access ||
+       (filter->match_tag && event->tag != filter->tag)) {
+        return;
+    }
+
+    log->filling->events[log->filling->count++] = *event;
+
+    if(log->filling->count == EVENTLOG_BATCH) {
+        ringPublish(log->ring);
+        claimBatch(log);
+    }
+}
+
+long long closeEventLog(EventLog log) {
+
+    unsigned char count[8];
+    long long total;
+    int failed;
+
+    if(log == NULL) {
+        return 0;
+    }
+
+    /* publish the partial batch, if any, and let the writer drain */
+
+    if(log->filling->count > 0) {
+        ringPublish(log->ring);
+    }
+
+    ringFinish(log->ring);
+    pthread_join(log->thread, NULL);
+    destroyRing(log->ring);
+
+    total = log->total;
+    failed = atomic_load_explicit(&log->failed, memory_order_relaxed);
+
+    /* fill in the event count */
+
+    putLE(count, (uint64_t) total, 8);
+
+    if(fseek(log->file, EVENTLOG_HEADER_SIZE - 8, SEEK_SET) != 0 || fwrite(count, 1, sizeof(count), log->file) != sizeof(count)) {
+        failed = 1;
+    }
+
+    if(fclose(log->file) != 0) {
+        failed = 1;
+    }
+
+    free(log);
+
+    if(failed) {
+        fprintf(stderr, "Error: Could not write the event log.\n");
+        return -1;
+    }
+
+    return total;
+}
+
+EventLogReader openEventLog(const char *path, EventLogInfo *info) {
+
+    unsigned char header[EVENTLOG_HEADER_SIZE];
+    EventLogReader reader;
+    FILE *file;
+
+    file = fopen(path, "rb");
+
+    if(file == NULL) {
+        fprintf(stderr, "Error: Could not open event log %s.\n", path);
+        return NULL;
+    }
+
+    if(fread(header, 1, sizeof(header), file) != sizeof(header) || memcmp(header, EVENTLOG_MAGIC, 4) != 0) {
+        fprintf(stderr, "Error: %s is not an event log.\n", path);
+        fclose(file);
+        return NULL;
+    }
+
+    if(getLE(header + 4, 2) != EVENTLOG_VERSION) {
+        fprintf(stderr, "Error: %s is event log version %d; only version %d is supported.\n", path, (int) getLE(header + 4, 2), EVENTLOG_VERSION);
+        fclose(file);
+        return NULL;
+    }
+
+    info->address_size = (int) getLE(header + 6, 2);
+    info->number_of_sets = (int) getLE(header + 8, 4);
+    info->associativity = (int) getLE(header + 12, 4);
+    info->block_size = (int) getLE(header + 16, 4);
+    info->events = getLE(header + 24, 8);
+
+    reader = (EventLogReader) malloc(sizeof(struct EventLogReader_));
+    assert(reader != NULL);
+
+    reader->file = file;
+    reader->left = info->events;
+
+    return reader;
+}
+
+int readEventLog(EventLogReader reader, EventRecord *event) {
+
+    unsigned char record[EVENTLOG_RECORD_SIZE];
+
+    if(reader->left == 0) {
+        return 0;
+    }
+
+    if(fread(record, 1, sizeof(record), reader->file) != sizeof(record)) {
+        fprintf(stderr, "Error: the event log ends %llu events early.\n", (unsigned long long) reader->left);
+        return -1;
+    }
+
+    event->access = getLE(record, 8);
+    event->tag = getLE(record + 8, 8);
+    event->victim = getLE(record + 16, 8);
+    event->set = (uint32_t) getLE(record + 24, 4);
+    event->cycles = (uint32_t) getLE(record + 28, 4);
+    event->offset = (uint32_t) getLE(record + 32, 4);
+    event->way = record[36];
+    event->flags = record[37];
+
+    reader->left--;
+
+    return 1;
+}
+
+void closeEventLogReader(EventLogReader reader) {
+
+    if(reader != NULL) {
+        fclose(reader->file);
+        free(reader);
+    }
+}
@@ -0,0 +1,222 @@
+/* File: EventLog.h
+ *
+ * Binary per-access event log, the low-overhead form of [-t].
+ *
+ * Each access the cache records becomes one fixed-size event: its
+ * access number, read or write, tag, set, byte offset, the way it hit
+ * or filled, the tag it evicted, and the cycles it took. Events are
+ * copied into a ring of EVENTLOG_RING batches and written out by a
+ * writer thread, so the simulation never formats text or waits on the
+ * file unless the whole ring is full (see Ring.h). A filter by set
+ * range, tag, and access range keeps the log to the part of the trace
+ * of interest.
+ *
+ * "./CacheSim decode <event log>" renders a log as [-t] text.
+ *
+ * The log starts with a 32-byte header, all fields little endian:
+ *
+ *      bytes  0 -  3   magic "CSEL"
+ *      bytes  4 -  5   format version (1)
+ *      bytes  6 -  7   address width in bits
+ *      bytes  8 - 11   # of sets
+ *      bytes 12 - 15   associativity
+ *      bytes 16 - 19   block size in bytes
+ *      bytes 20 - 23   reserved (0)
+ *      bytes 24 - 31   # of events
+ *
+ * followed by one 40-byte record per event:
+ *
+ *      bytes  0 -  7   access number (1-based)
+ *      bytes  8 - 15   tag
+ *      bytes 16 - 23   tag of the evicted block (if EVENT_EVICT)
+ *      bytes 24 - 27   set index
+ *      bytes 28 - 31   cycles taken by the access
+ *      bytes 32 - 35   byte offset
+ *      byte  36        way hit or filled
+ *      byte  37        EVENT_* flags
+ *      bytes 38 - 39   reserved (0)
+ *
+ */
+
+#ifndef EVENTLOG_H
+#define EVENTLOG_H
+
+#include <stdint.h>
+
+/* Format constants */
+#define EVENTLOG_MAGIC "CSEL"
+#define EVENTLOG_VERSION 1
+#define EVENTLOG_HEADER_SIZE 32
+#define EVENTLOG_RECORD_SIZE 40
+
+/* Events per batch and batches in flight */
+#define EVENTLOG_BATCH 4096
+#define EVENTLOG_RING 8
+
+/* Event flags */
+#define EVENT_WRITE 1           /* the access was a write */
+#define EVENT_HIT 2             /* the access hit in the sets */
+#define EVENT_EVICT 4           /* a valid block was evicted */
+#define EVENT_WRITEBACK 8       /* the evicted block was dirty */
+#define EVENT_SIDE 16           /* the miss hit in the victim or miss cache */
+#define EVENT_STREAM 32         /* the miss was served by the stream buffer */
+#define EVENT_BYPASS 64         /* a write miss went to memory without allocating */
+#define EVENT_THROUGH 128       /* the write was sent on to memory */
+
+/* Typedefs */
+typedef struct EventLog_* EventLog;
+typedef struct EventLogReader_* EventLogReader;
+
+/* EventRecord
+ *
+ * One access, as recorded and as decoded.
+ *
+ * @param   access          access number (1-based)
+ * @param   tag             tag of the address
+ * @param   victim          tag of the evicted block (if EVENT_EVICT)
+ * @param   set             set index
+ * @param   cycles          cycles taken by the access
+ * @param   offset          byte offset in the block
+ * @param   way             way hit or filled
+ * @param   flags           EVENT_* flags
+ */
+
+typedef struct {
+    uint64_t access;
+    uint64_t tag;
+    uint64_t victim;
+    uint32_t set;
+    uint32_t cycles;
+    uint32_t offset;
+    uint8_t way;
+    uint8_t flags;
+} EventRecord;
+
+/* EventFilter
+ *
+ * Which events are kept. An event is logged only if it passes every
+ * part of the filter.
+ *
+ * @param   first_set       lowest set logged
+ * @param   last_set        highest set logged
+ * @param   match_tag       only log events with tag 'tag'
+ * @param   tag             tag to log when 'match_tag' is set
+ * @param   first_access    lowest access number logged
+ * @param   last_access     highest access number logged
+ */
+
+typedef struct {
+    uint32_t first_set;
+    uint32_t last_set;
+    int match_tag;
+    uint64_t tag;
+    uint64_t first_access;
+    uint64_t last_access;
+} EventFilter;
+
+/* EventLogInfo
+ *
+ * The cache geometry and length recorded in a log's header.
+ */
+
+typedef struct {
+    int address_size;
+    int number_of_sets;
+    int associativity;
+    int block_size;
+    uint64_t events;
+} EventLogInfo;
+
+/* initEventFilter
+ *
+ * Sets a filter that keeps every event.
+ *
+ * @param   filter          filter to initialize
+ *
+ * @return  void
+ */
+
+void initEventFilter(EventFilter *filter);
+
+/* createEventLog
+ *
+ * Creates (or truncates) an event log for a cache of the given geometry
+ * and starts its writer thread. Returns NULL on failure.
+ *
+ * @param   path            output file location
+ * @param   info            geometry for the header ('events' is ignored)
+ * @param   filter          events to keep (copied)
+ *
+ * @return  success         new EventLog
+ * @return  failure         NULL
+ */
+
+EventLog createEventLog(const char *path, const EventLogInfo *info, const EventFilter *filter);
+
+/* eventLogRecord
+ *
+ * Queues one event if it passes the filter. Blocks only when all
+ * EVENTLOG_RING batches are still being written.
+ *
+ * @param   log             target log
+ * @param   event           event to queue (copied)
+ *
+ * @return  void
+ */
+
+void eventLogRecord(EventLog log, const EventRecord *event);
+
+/* closeEventLog
+ *
+ * Writes the last partial batch, joins the writer thread, fills in the
+ * event count, and closes the file. The log is freed even on failure.
+ * Passing NULL does nothing.
+ *
+ * @param   log             log to close
+ *
+ * @return  success         # of events written
+ * @return  failure         -1
+ */
+
+long long closeEventLog(EventLog log);
+
+/* openEventLog
+ *
+ * Opens an event log for decoding and reads its header. Returns NULL
+ * on failure.
+ *
+ * @param   path            event log location
+ * @param   info            output: geometry and # of events
+ *
+ * @return  success         new EventLogReader
+ * @return  failure         NULL
+ */
+
+EventLogReader openEventLog(const char *path, EventLogInfo *info);
+
+/* readEventLog
+ *
+ * Decodes the next event.
+ *
+ * @param   reader          log opened with openEventLog
+ * @param   event           output: the event
+ *
+ * @return  success         1 (0 at the end)
+ * @return  failure         -1 if the log is truncated
+ */
+
+int readEventLog(EventLogReader reader, EventRecord *event);
+
+/* closeEventLogReader
+ *
+ * Closes the log and frees the reader. Passing NULL does nothing.
+ *
+ * @param   reader          reader to close
+ *
+ * @return  void
+ */
+
+void closeEventLogReader(EventLogReader reader);
+
+#endif
+/* EVENTLOG_H */
@@ -0,0 +1,170 @@
+/* File: Heatmap.c
+ *
+ * Per-set access counters and the conflict hotspot report. See
+ * Heatmap.h.
+ *
+ * The report sorts (key, set) pairs once per list, so it costs
+ * O(sets log sets) at the end of the run and nothing during it.
+ *
+ */
+
+/********************************
+ *     1. Includes              *
+ *******************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "Heatmap.h"
+
+/********************************
+ *     2. Structs               *
+ ********************************/
+
+/* Rank
+ *
+ * One set and the counter it is ranked by.
+ */
+
+struct Rank_ {
+    uint64_t key;
+    int set;
+};
+
+// # of histogram buckets: unused, then < 1/8 of the mean up to >= 4x
+
+#define UTILIZATION_BUCKETS 8
+
+static const char *bucketNames[UTILIZATION_BUCKETS] = {
+    "unused", "< 1/8", "1/8 - 1/4", "1/4 - 1/2", "1/2 - 1", "1 - 2", "2 - 4", ">= 4",
+};
+
+// upper end of each bucket, as a multiple of the mean
+
+static const double bucketLimits[UTILIZATION_BUCKETS - 1] = {
+    0.0, 0.125, 0.25, 0.5, 1.0, 2.0, 4.0,
+};
+
+/********************************
+ *     3. Report                *
+ ********************************/
+
+/* compareRanks
+ *
+ * Orders ranks by key, largest first, and then by set.
+ */
+
+static int compareRanks(const void *a, const void *b) {
+
+    const struct Rank_ *x = (const struct Rank_ *) a;
+    const struct Rank_ *y = (const struct Rank_ *) b;
+
+    if(x->key != y->key) {
+        return (x->key > y->key) ? -1 : 1;
+    }
+
+    return x->set - y->set;
+}
+
+/* printRanking
+ *
+ * Prints the 'top' sets with the largest 'key' (0 = accesses,
+ * 1 = evictions), skipping sets where it is 0.
+ */
+
+static void printRanking(const SetCounters *counters, int number_of_sets, int top, int by_evictions, struct Rank_ *ranks) {
+
+    const SetCounters *c;
+    int i;
+
+    for(i = 0; i < number_of_sets; i++) {
+        ranks[i].key = by_evictions ? counters[i].evictions : counters[i].accesses;
+        ranks[i].set = i;
+    }
+
+    qsort(ranks, number_of_sets, sizeof(struct Rank_), compareRanks);
+
+    printf("\t%8s %12s %12s %10s %12s %12s\n", "set", "accesses", "misses", "miss ratio", "evictions", "dirty evicts");
+
+    for(i = 0; i < top && i < number_of_sets && ranks[i].key > 0; i++) {
+
+        c = &counters[ranks[i].set];
+
+        printf("\t%8d %12llu %12llu %9.2f%% %12llu %12llu\n", ranks[i].set, (unsigned long long) c->accesses, (unsigned long long) c->misses,
+               c->accesses ? ((double) c->misses / (double) c->accesses) * 100 : 0.0,
+               (unsigned long long) c->evictions, (unsigned long long) c->dirty_evictions);
+    }
+
+    if(i == 0) {
+        printf("\t%8s\n", "none");
+    }
+
+    printf("\n");
+}
+
+/********************************
+ *     4. Interface             *
+ ********************************/
+
+SetCounters *createSetCounters(int number_of_sets) {
+
+    SetCounters *counters;
+
+    counters = (SetCounters *) calloc(number_of_sets, sizeof(SetCounters));
+
+    if(counters == NULL) {
+        fprintf(stderr, "Error: could not allocate memory for the set counters.\n");
+    }
+
+    return counters;
+}
+
+void printHeatmap(const SetCounters *counters, int number_of_sets, int top) {
+
+    long long buckets[UTILIZATION_BUCKETS] = { 0 };
+    struct Rank_ *ranks;
+    uint64_t total = 0;
+    double mean, share;
+    int i, b;
+
+    ranks = (struct Rank_ *) malloc(number_of_sets * sizeof(struct Rank_));
+    assert(ranks != NULL);
+
+    printf("\tHottest sets (by accesses):\n\n");
+    printRanking(counters, number_of_sets, top, 0, ranks);
+
+    printf("\tMost conflicted sets (by evictions):\n\n");
+    printRanking(counters, number_of_sets, top, 1, ranks);
+
+    free(ranks);
+
+    /* bucket every set by its accesses relative to the mean */
+
+    for(i = 0; i < number_of_sets; i++) {
+        total += counters[i].accesses;
+    }
+
+    mean = (double) total / (double) number_of_sets;
+
+    for(i = 0; i < number_of_sets; i++) {
+
+        if(counters[i].accesses == 0) {
+            buckets[0]++;
+            continue;
+        }
+
+        share = (double) counters[i].accesses / mean;
+
+        for(b = 1; b < UTILIZATION_BUCKETS - 1 && share >= bucketLimits[b]; b++);
+
+        buckets[b]++;
+    }
+
+    printf("\tSet utilization (accesses per set vs. the mean of %.2f):\n\n", mean);
+
+    for(b = 0; b < UTILIZATION_BUCKETS; b++) {
+        printf("\t%10s: %8lld sets (%2.2f%%)\n", bucketNames[b], buckets[b], ((double) buckets[b] / (double) number_of_sets) * 100);
+    }
+
+    printf("\n");
+}
@@ -0,0 +1,70 @@
+/* File: Heatmap.h
+ *
+ * Per-set access counters and the conflict hotspot report.
+ *
+ * A cache with a heatmap keeps one SetCounters record per set in an
+ * array beside its tag store, indexed like the sets. The access kernels
+ * bump the record of the set they touch, which costs one increment per
+ * access and a few more per miss, so the counters can stay on for
+ * production runs.
+ *
+ * At the end of a run the report lists the 'top' sets with the most
+ * accesses and the 'top' sets with the most evictions, which are the
+ * sets where blocks that alias to the same index keep pushing each
+ * other out. A histogram then shows how evenly the accesses spread
+ * over the sets, in powers of two of the mean.
+ *
+ */
+
+#ifndef HEATMAP_H
+#define HEATMAP_H
+
+#include <stdint.h>
+
+/* Limits */
+#define MAX_HEATMAP_TOP 1024
+
+/* SetCounters
+ *
+ * @param   accesses        # of accesses to the set
+ * @param   misses          # of those that missed
+ * @param   evictions       # of valid blocks evicted from the set
+ * @param   dirty_evictions # of those that were dirty
+ */
+
+typedef struct {
+    uint64_t accesses;
+    uint64_t misses;
+    uint64_t evictions;
+    uint64_t dirty_evictions;
+} SetCounters;
+
+/* createSetCounters
+ *
+ * Allocates zeroed counters for 'number_of_sets' sets. Returns NULL on
+ * failure. Free them with free().
+ *
+ * @param   number_of_sets  # of sets in the cache
+ *
+ * @return  success         array of counters, one per set
+ * @return  failure         NULL
+ */
+
+SetCounters *createSetCounters(int number_of_sets);
+
+/* printHeatmap
+ *
+ * Prints the 'top' hottest and most conflicted sets and the histogram
+ * of accesses per set.
+ *
+ * @param   counters        counters of every set
+ * @param   number_of_sets  # of sets
+ * @param   top             # of sets in each list (1 - MAX_HEATMAP_TOP)
+ *
+ * @return  void
+ */
+
+void printHeatmap(const SetCounters *counters, int number_of_sets, int top);
+
+#endif
+/* HEATMAP_H */
@@ -0,0 +1,429 @@
+/* File: Hierarchy.c
+ *
+ * Multi-level cache hierarchy. See Hierarchy.h for the model.
+ *
+ * A demand miss walks down the levels until one hits (or memory
+ * supplies the block) and the block is then filled on the way back up,
+ * lowest level first. Each fill may evict a block, which is handled by
+ * evictBlock before the next level up is filled: an inclusive level
+ * back-invalidates the copies above it, and the victim is written back
+ * or, if the level below is exclusive, moved into it.
+ *
+ */
+
+/********************************
+ *     1. Includes              *
+ *******************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Hierarchy.h"
+#include "Policy.h"
+
+/********************************
+ *     2. Structs & Globals     *
+ ********************************/
+
+/* Level
+ *
+ * One level of the hierarchy and its statistics.
+ *
+ * @param   cache               tag store of this level
+ * @param   config              geometry, latency, and policies
+ * @param   accesses            # of demand lookups (from the trace or a miss above)
+ * @param   hits                # of demand lookups that hit
+ * @param   misses              # of demand lookups that missed
+ * @param   fills               # of blocks allocated (demand fills and victims)
+ * @param   evictions           # of valid blocks evicted
+ * @param   writebacks_in       # of dirty blocks received from the level above
+ * @param   writebacks_out      # of dirty blocks sent to the level below
+ * @param   back_invalidations  # of blocks above invalidated by this level's evictions
+ */
+
+struct Level_ {
+    Cache cache;
+    LevelConfig config;
+    long long accesses;
+    long long hits;
+    long long misses;
+    long long fills;
+    long long evictions;
+    long long writebacks_in;
+    long long writebacks_out;
+    long long back_invalidations;
+};
+
+/* Hierarchy
+ *
+ * @param   levels          levels, L1 first
+ * @param   count           # of levels
+ * @param   memory_latency  cycles to read or write a block in memory
+ * @param   reads           # of reads in the trace
+ * @param   writes          # of writes in the trace
+ * @param   memory_reads    # of blocks read from memory
+ * @param   memory_writes   # of blocks written back to memory
+ * @param   cycles          # of cycles elapsed in the simulation
+ */
+
+struct Hierarchy_ {
+    struct Level_ levels[MAX_LEVELS];
+    int count;
+    int memory_latency;
+    long long reads;
+    long long writes;
+    long long memory_reads;
+    long long memory_writes;
+    long long cycles;
+};
+
+static const char *inclusionNames[] = { "nine", "inclusive", "exclusive" };
+
+/********************************
+ *     3. Block Movement        *
+ ********************************/
+
+static void evictBlock(Hierarchy hierarchy, int k, const BlockVictim *victim);
+
+/* writeBlock
+ *
+ * A block leaves level k - 1 for level k (memory when k == count).
+ * Dirty blocks are write-backs; clean ones only arrive at an exclusive
+ * level, which takes in every victim from above. A non-exclusive level
+ * that does not hold a written-back block passes it further down.
+ */
+
+static void writeBlock(Hierarchy hierarchy, int k, uint64_t address, int dirty) {
+
+    struct Level_ *level;
+    BlockVictim victim;
+
+    if(k == hierarchy->count) {
+
+        if(dirty) {
+            hierarchy->memory_writes++;
+            hierarchy->cycles += hierarchy->memory_latency;
+        }
+
+        return;
+    }
+
+    level = &hierarchy->levels[k];
+
+    if(level->config.inclusion != INCLUSION_EXCLUSIVE && !dirty) {
+        return;
+    }
+
+    hierarchy->cycles += level->config.latency;
+
+    if(dirty) {
+        level->writebacks_in++;
+    }
+
+    if(level->config.inclusion == INCLUSION_EXCLUSIVE) {
+
+        if(!accessBlock(level->cache, address, dirty, 1, &victim)) {
+            level->fills++;
+        }
+
+        if(victim.valid) {
+            evictBlock(hierarchy, k, &victim);
+        }
+    }
+    else if(!accessBlock(level->cache, address, 1, 0, NULL)) {
+        writeBlock(hierarchy, k + 1, address, 1);
+    }
+}
+
+/* evictBlock
+ *
+ * Sends a block evicted from level k down the hierarchy. An inclusive
+ * level first removes every copy of it from the levels above; if one
+ * of them was dirty, the block is written back as dirty.
+ */
+
+static void evictBlock(Hierarchy hierarchy, int k, const BlockVictim *victim) {
+
+    struct Level_ *level = &hierarchy->levels[k];
+    int dirty = victim->dirty;
+    int j, copy_dirty;
+    unsigned int offset;
+
+    level->evictions++;
+
+    /* levels above may use smaller blocks: invalidate each of them */
+
+    if(level->config.inclusion == INCLUSION_INCLUSIVE) {
+        for(j = 0; j < k; j++) {
+            for(offset = 0; offset < (unsigned int) level->config.block_size; offset += hierarchy->levels[j].config.block_size) {
+                if(invalidateBlock(hierarchy->levels[j].cache, victim->address + offset, &copy_dirty)) {
+                    level->back_invalidations++;
+                    dirty |= copy_dirty;
+                }
+            }
+        }
+    }
+
+    if(dirty) {
+        level->writebacks_out++;
+    }
+
+    writeBlock(hierarchy, k + 1, victim->address, dirty);
+}
+
+/* fillBlock
+ *
+ * Allocates a block in level k and sends its victim down.
+ */
+
+static void fillBlock(Hierarchy hierarchy, int k, uint64_t address, int dirty) {
+
+    struct Level_ *level = &hierarchy->levels[k];
+    BlockVictim victim;
+
+    accessBlock(level->cache, address, dirty, 1, &victim);
+    level->fills++;
+
+    if(victim.valid) {
+        evictBlock(hierarchy, k, &victim);
+    }
+}
+
+/* readBlock
+ *
+ * Demand lookup of a block at level k after a miss above it (memory
+ * when k == count). Returns 1 if the block moves up dirty, which only
+ * happens when it leaves an exclusive level: a level that keeps its
+ * copy also keeps responsibility for writing it back.
+ */
+
+static int readBlock(Hierarchy hierarchy, int k, uint64_t address) {
+
+    struct Level_ *level;
+    int dirty;
+
+    if(k == hierarchy->count) {
+        hierarchy->memory_reads++;
+        hierarchy->cycles += hierarchy->memory_latency;
+        return 0;
+    }
+
+    level = &hierarchy->levels[k];
+    level->accesses++;
+    hierarchy->cycles += level->config.latency;
+
+    /* an exclusive level gives the block up and is not filled on a miss */
+
+    if(level->config.inclusion == INCLUSION_EXCLUSIVE) {
+
+        if(invalidateBlock(level->cache, address, &dirty)) {
+            level->hits++;
+            return dirty;
+        }
+
+        level->misses++;
+        return readBlock(hierarchy, k + 1, address);
+    }
+
+    if(accessBlock(level->cache, address, 0, 0, NULL)) {
+        level->hits++;
+        return 0;
+    }
+
+    level->misses++;
+    dirty = readBlock(hierarchy, k + 1, address);
+    fillBlock(hierarchy, k, address, dirty);
+
+    return 0;
+}
+
+/********************************
+ *     4. Hierarchy Functions   *
+ ********************************/
+
+int parseInclusion(const char *name) {
+
+    int inclusion;
+
+    for(inclusion = 0; inclusion < (int) (sizeof(inclusionNames) / sizeof(inclusionNames[0])); inclusion++) {
+        if(strcmp(name, inclusionNames[inclusion]) == 0) {
+            return inclusion;
+        }
+    }
+
+    return -1;
+}
+
+Hierarchy createHierarchy(const LevelConfig *configs, int count, int memory_latency, int address_size, unsigned int seed) {
+
+    Hierarchy hierarchy;
+    int k;
+
+    /* Validate Inputs */
+    if(count < 1 || count > MAX_LEVELS) {
+        fprintf(stderr, "Error: A hierarchy needs between 1 and %d levels!\n", MAX_LEVELS);
+        return NULL;
+    }
+
+    if(memory_latency < 0) {
+        fprintf(stderr, "Error: Memory latency must not be negative!\n");
+        return NULL;
+    }
+
+    for(k = 0; k < count; k++) {
+
+        if(configs[k].latency < 0) {
+            fprintf(stderr, "Error: L%d latency must not be negative!\n", k + 1);
+            return NULL;
+        }
+
+        if(k > 0 && configs[k].block_size < configs[k - 1].block_size) {
+            fprintf(stderr, "Error: L%d blocks must not be smaller than L%d blocks!\n", k + 1, k);
+            return NULL;
+        }
+
+        if(k > 0 && configs[k].inclusion == INCLUSION_EXCLUSIVE && configs[k].block_size != configs[k - 1].block_size) {
+            fprintf(stderr, "Error: Exclusive L%d must use the block size of L%d!\n", k + 1, k);
+            return NULL;
+        }
+    }
+
+    hierarchy = (Hierarchy) calloc(1, sizeof(struct Hierarchy_));
+
+    if(hierarchy == NULL) {
+        fprintf(stderr, "Error: could not allocate memory for cache hierarchy.\n");
+        return NULL;
+    }
+
+    hierarchy->count = count;
+    hierarchy->memory_latency = memory_latency;
+
+    for(k = 0; k < count; k++) {
+
+        hierarchy->levels[k].config = configs[k];
+
+        /* L1 has nothing above it to include or exclude */
+
+        if(k == 0) {
+            hierarchy->levels[k].config.inclusion = INCLUSION_NINE;
+        }
+
+        hierarchy->levels[k].cache = createCache(configs[k].number_of_sets, configs[k].associativity, configs[k].block_size,
+                                                 address_size, configs[k].policy, seed);
+
+        if(hierarchy->levels[k].cache == NULL) {
+            destroyHierarchy(hierarchy);
+            return NULL;
+        }
+    }
+
+    return hierarchy;
+}
+
+int hierarchyAccess(Hierarchy hierarchy, uint64_t address, int write) {
+
+    struct Level_ *l1 = &hierarchy->levels[0];
+    int dirty;
+
+    if(write) {
+        hierarchy->writes++;
+    }
+    else {
+        hierarchy->reads++;
+    }
+
+    l1->accesses++;
+    hierarchy->cycles += l1->config.latency;
+
+    if(accessBlock(l1->cache, address, write, 0, NULL)) {
+        l1->hits++;
+        return 1;
+    }
+
+    /* allocate-on-write: a write miss fetches the block like a read */
+
+    l1->misses++;
+    dirty = readBlock(hierarchy, 1, address);
+    fillBlock(hierarchy, 0, address, write || dirty);
+
+    return 0;
+}
+
+void printHierarchy(Hierarchy hierarchy, int dump) {
+
+    struct Level_ *level;
+    long long total = hierarchy->reads + hierarchy->writes;
+    double amat = hierarchy->memory_latency;
+    int k;
+
+    for(k = 0; k < hierarchy->count; k++) {
+
+        level = &hierarchy->levels[k];
+
+        printf("\n\n******** L%d: %d sets, %d ways, %d byte blocks, %s", k + 1, level->config.number_of_sets,
+               level->config.associativity, level->config.block_size, policyName(level->config.policy));
+
+        if(k > 0) {
+            printf(", %s", inclusionNames[level->config.inclusion]);
+        }
+
+        printf(", %d cycles ********\n", level->config.latency);
+
+        if(dump) {
+            dumpCache(level->cache);
+        }
+
+        printf("\nLevel performance:\n\n");
+
+        printf("\tCache size: %lld\n", (long long) level->config.number_of_sets * level->config.associativity * level->config.block_size);
+        printf("\tAccesses: %lld\n", level->accesses);
+        printf("\tHits: %lld\n", level->hits);
+        printf("\tMisses: %lld\n\n", level->misses);
+
+        printf("\tLocal miss ratio: %2.2f%%\n", level->accesses ? ((float) level->misses / (float) level->accesses) * 100 : 0.0);
+        printf("\tGlobal miss ratio: %2.2f%%\n\n", total ? ((float) level->misses / (float) total) * 100 : 0.0);
+
+        printf("\tFills: %lld\n", level->fills);
+        printf("\tEvictions: %lld\n", level->evictions);
+        printf("\tWrite-backs received: %lld\n", level->writebacks_in);
+        printf("\tWrite-backs sent: %lld\n", level->writebacks_out);
+        printf("\tBack-invalidations: %lld\n", level->back_invalidations);
+    }
+
+    /* AMAT = t1 + m1 * (t2 + m2 * (... + memory latency)), innermost first */
+
+    for(k = hierarchy->count - 1; k >= 0; k--) {
+
+        level = &hierarchy->levels[k];
+        amat = level->config.latency + (level->accesses ? (double) level->misses / level->accesses : 0.0) * amat;
+    }
+
+    printf("\nHierarchy performance:\n\n");
+
+    printf("\tAttempted reads: %lld\n", hierarchy->reads);
+    printf("\tAttempted writes: %lld\n", hierarchy->writes);
+    printf("\tTotal accesses: %lld\n\n", total);
+
+    printf("\tMemory reads: %lld\n", hierarchy->memory_reads);
+    printf("\tMemory writes: %lld\n\n", hierarchy->memory_writes);
+
+    printf("\tCycles with cache: %lld\n", hierarchy->cycles);
+    printf("\tCycles without cache: %lld\n\n", hierarchy->memory_latency * total);
+
+    printf("\tAMAT: %.2f cycles\n", amat);
+    printf("\tAverage cycles per access (with write-backs): %.2f\n\n", total ? (double) hierarchy->cycles / total : 0.0);
+}
+
+void destroyHierarchy(Hierarchy hierarchy) {
+
+    int k;
+
+    if(hierarchy != NULL) {
+
+        for(k = 0; k < hierarchy->count; k++) {
+            destroyCache(hierarchy->levels[k].cache);
+        }
+
+        free(hierarchy);
+    }
+}
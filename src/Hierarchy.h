@@ -0,0 +1,140 @@
+/* File: Hierarchy.h
+ *
+ * Multi-level cache hierarchy.
+ *
+ * A chain of Cache levels (L1 first) in front of memory. Every level
+ * has its own geometry, replacement policy, and hit latency, and every
+ * level below L1 has an inclusion policy describing what it holds
+ * relative to the levels above it:
+ *
+ *      inclusive   holds every block held above it; evicting a block
+ *                  back-invalidates the copies above (a dirty copy is
+ *                  written back with it)
+ *      exclusive   holds only blocks not held by the level above; it
+ *                  is filled by that level's victims, and a hit moves
+ *                  the block up (dirty or not) instead of copying it
+ *      nine        non-inclusive non-exclusive: filled on a miss like
+ *                  an inclusive level, but evicts without
+ *                  back-invalidation
+ *
+ * All levels are write-back and allocate on write. A demand access
+ * pays the latency of every level it looks up and, if all of them
+ * miss, the memory latency. A write-back or victim moved into a level
+ * pays that level's latency (or memory's). With one level of latency
+ * 1 and a memory latency of 50 this is exactly the single cache model.
+ *
+ */
+
+#ifndef HIERARCHY_H
+#define HIERARCHY_H
+
+#include "CacheSim.h"
+
+/* Limits and defaults */
+#define MAX_LEVELS 8
+#define DEFAULT_MEMORY_LATENCY 50
+
+/* Inclusion policies */
+enum {
+    INCLUSION_NINE,
+    INCLUSION_INCLUSIVE,
+    INCLUSION_EXCLUSIVE
+};
+
+/* LevelConfig
+ *
+ * Geometry and behaviour of one level.
+ *
+ * @param   number_of_sets  # of sets
+ * @param   associativity   # of ways
+ * @param   block_size      block size in bytes
+ * @param   latency         hit latency in cycles
+ * @param   inclusion       inclusion policy (ignored for L1)
+ * @param   policy          replacement policy
+ */
+
+typedef struct {
+    int number_of_sets;
+    int associativity;
+    int block_size;
+    int latency;
+    int inclusion;
+    int policy;
+} LevelConfig;
+
+/* Typedefs */
+typedef struct Hierarchy_* Hierarchy;
+
+/* parseInclusion
+ *
+ * Returns the inclusion policy with the given name ("inclusive",
+ * "exclusive", "nine"), or -1 if there is none.
+ *
+ * @param   name            inclusion policy name
+ *
+ * @return  success         inclusion policy
+ * @return  failure         -1
+ */
+
+int parseInclusion(const char *name);
+
+/* createHierarchy
+ *
+ * Creates one Cache per level. Block sizes may not shrink going down,
+ * and an exclusive level must use the block size of the level above
+ * it. Returns NULL (after printing an error) on failure.
+ *
+ * @param   configs         levels, L1 first
+ * @param   count           # of levels (1 - MAX_LEVELS)
+ * @param   memory_latency  cycles to read or write a block in memory
+ * @param   address_size    width of a memory address in bits
+ * @param   seed            seed for the policies that make random choices
+ *
+ * @return  success         new Hierarchy
+ * @return  failure         NULL
+ */
+
+Hierarchy createHierarchy(const LevelConfig *configs, int count, int memory_latency, int address_size, unsigned int seed);
+
+/* hierarchyAccess
+ *
+ * Runs one read or write from the trace through the hierarchy.
+ *
+ * @param   hierarchy       target hierarchy
+ * @param   address         decoded memory address
+ * @param   write           0 = read, 1 = write
+ *
+ * @return  L1 hit          1
+ * @return  L1 miss         0
+ */
+
+int hierarchyAccess(Hierarchy hierarchy, uint64_t address, int write);
+
+/* printHierarchy
+ *
+ * Prints every level's statistics (and contents, if 'dump' is set)
+ * followed by the memory traffic, the total cycles, and the average
+ * memory access time.
+ *
+ * @param   hierarchy       target hierarchy
+ * @param   dump            also print each level's contents
+ *
+ * @return  void
+ */
+
+void printHierarchy(Hierarchy hierarchy, int dump);
+
+/* destroyHierarchy
+ *
+ * Destroys every level and frees the hierarchy. Passing NULL does
+ * nothing.
+ *
+ * @param   hierarchy       hierarchy to destroy
+ *
+ * @return  void
+ */
+
+void destroyHierarchy(Hierarchy hierarchy);
+
+#endif
+/* HIERARCHY_H */
@@ -0,0 +1,165 @@
+/* File: Interval.c
+ *
+ * Interval (phase) statistics. See Interval.h for the CSV columns.
+ *
+ * The previous snapshot is kept whole, so each row is one subtraction
+ * per counter. The summary is updated as the rows are written.
+ *
+ */
+
+/********************************
+ *     1. Includes              *
+ *******************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+#include "Interval.h"
+
+/********************************
+ *     2. Structs               *
+ ********************************/
+
+/* Interval
+ *
+ * @param   file            CSV output
+ * @param   period          accesses or cycles per interval
+ * @param   by_cycles       'period' counts cycles
+ * @param   previous        counters at the end of the last interval
+ * @param   count           # of intervals written
+ * @param   min_ratio       lowest interval miss ratio (%)
+ * @param   max_ratio       highest interval miss ratio (%)
+ * @param   min_interval    interval with the lowest miss ratio
+ * @param   max_interval    interval with the highest miss ratio
+ * @param   last_ratio      miss ratio of the last interval (%)
+ * @param   phases          # of phase changes
+ */
+
+struct Interval_ {
+    FILE* file;
+    long long period;
+    int by_cycles;
+    CacheCounters previous;
+    long long count;
+    double min_ratio;
+    double max_ratio;
+    long long min_interval;
+    long long max_interval;
+    double last_ratio;
+    long long phases;
+};
+
+/********************************
+ *     3. Interface             *
+ ********************************/
+
+Interval createInterval(const char *path, long long period, int by_cycles) {
+
+    Interval iv;
+
+    if(period <= 0) {
+        fprintf(stderr, "Error: the interval must be at least 1.\n");
+        return NULL;
+    }
+
+    iv = (Interval) calloc(1, sizeof(struct Interval_));
+    assert(iv != NULL);
+
+    iv->file = (path != NULL) ? fopen(path, "w") : stdout;
+
+    if(iv->file == NULL) {
+        fprintf(stderr, "Error: Could not create interval file %s.\n", path);
+        free(iv);
+        return NULL;
+    }
+
+    iv->period = period;
+    iv->by_cycles = by_cycles;
+
+    fprintf(iv->file, "interval,end_access,end_cycle,accesses,hits,misses,hit_ratio,stream_ins,stream_outs,evictions,cycles\n");
+
+    return iv;
+}
+
+long long intervalPeriod(Interval iv) {
+    return iv->period;
+}
+
+int intervalByCycles(Interval iv) {
+    return iv->by_cycles;
+}
+
+void intervalStart(Interval iv, const CacheCounters *now) {
+    iv->previous = *now;
+}
+
+void intervalSample(Interval iv, const CacheCounters *now) {
+
+    const CacheCounters *prev = &iv->previous;
+    long long accesses, hits, misses;
+    double ratio;
+
+    accesses = now->accesses - prev->accesses;
+
+    if(accesses == 0) {
+        return;
+    }
+
+    hits = (now->read_hits + now->write_hits) - (prev->read_hits + prev->write_hits);
+    misses = (now->read_misses + now->write_misses) - (prev->read_misses + prev->write_misses);
+    ratio = (hits + misses) ? ((double) misses / (double) (hits + misses)) * 100 : 0.0;
+
+    iv->count++;
+
+    fprintf(iv->file, "%lld,%lld,%lld,%lld,%lld,%lld,%.4f,%lld,%lld,%lld,%lld\n", iv->count, now->accesses, now->cycles,
+            accesses, hits, misses, 100 - ratio, now->stream_ins - prev->stream_ins, now->stream_outs - prev->stream_outs,
+            now->evictions - prev->evictions, now->cycles - prev->cycles);
+
+    /* keep the summary up to date */
+
+    if(iv->count == 1 || ratio < iv->min_ratio) {
+        iv->min_ratio = ratio;
+        iv->min_interval = iv->count;
+    }
+
+    if(iv->count == 1 || ratio > iv->max_ratio) {
+        iv->max_ratio = ratio;
+        iv->max_interval = iv->count;
+    }
+
+    if(iv->count > 1 && fabs(ratio - iv->last_ratio) >= PHASE_CHANGE) {
+        iv->phases++;
+    }
+
+    iv->last_ratio = ratio;
+    iv->previous = *now;
+}
+
+void printInterval(Interval iv) {
+
+    printf("\tIntervals: %lld of %lld %s\n", iv->count, iv->period, iv->by_cycles ? "cycles" : "accesses");
+
+    if(iv->count > 0) {
+        printf("\tInterval miss ratio: %2.2f%% (interval %lld) - %2.2f%% (interval %lld)\n", iv->min_ratio, iv->min_interval, iv->max_ratio, iv->max_interval);
+        printf("\tPhase changes (%.0f points or more): %lld\n", PHASE_CHANGE, iv->phases);
+    }
+
+    printf("\n");
+}
+
+void destroyInterval(Interval iv) {
+
+    if(iv != NULL) {
+
+        if(iv->file != stdout) {
+            fclose(iv->file);
+        }
+        else {
+            fflush(stdout);
+        }
+
+        free(iv);
+    }
+}
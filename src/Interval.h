@@ -0,0 +1,107 @@
+/* File: Interval.h
+ *
+ * Interval (phase) statistics.
+ *
+ * Every 'period' accesses, or every 'period' cycles, the cache's
+ * counters are compared with the previous snapshot and the difference
+ * is written as one CSV row:
+ *
+ *      interval,end_access,end_cycle,accesses,hits,misses,hit_ratio,
+ *      stream_ins,stream_outs,evictions,cycles
+ *
+ * where end_access and end_cycle are the totals at the end of the
+ * interval and every other column covers the interval alone. A
+ * snapshot only copies the counters, so the cost is one row per
+ * interval. The intervals are also summed up at the end: the lowest
+ * and highest miss ratio and the # of phase changes, intervals whose
+ * miss ratio moved by PHASE_CHANGE points or more from the one before.
+ *
+ */
+
+#ifndef INTERVAL_H
+#define INTERVAL_H
+
+#include <stdio.h>
+#include "CacheSim.h"
+
+/* Miss ratio change, in percentage points, that counts as a new phase */
+#define PHASE_CHANGE 10.0
+
+/* Typedefs */
+typedef struct Interval_* Interval;
+
+/* createInterval
+ *
+ * Creates the time series and writes the CSV header. Returns NULL on
+ * failure.
+ *
+ * @param   path            CSV output file, or NULL for stdout
+ * @param   period          accesses or cycles per interval
+ * @param   by_cycles       'period' counts cycles instead of accesses
+ *
+ * @return  success         new Interval
+ * @return  failure         NULL
+ */
+
+Interval createInterval(const char *path, long long period, int by_cycles);
+
+/* intervalPeriod / intervalByCycles
+ *
+ * Return the period and whether it counts cycles.
+ */
+
+long long intervalPeriod(Interval iv);
+int intervalByCycles(Interval iv);
+
+/* intervalStart
+ *
+ * Starts the first interval at 'now' instead of at zero, for a cache
+ * whose counters were restored from a checkpoint.
+ *
+ * @param   iv              time series
+ * @param   now             the cache's counters
+ *
+ * @return  void
+ */
+
+void intervalStart(Interval iv, const CacheCounters *now);
+
+/* intervalSample
+ *
+ * Ends the current interval at 'now' and writes its row. Does nothing
+ * if no access was made since the last sample.
+ *
+ * @param   iv              target time series
+ * @param   now             the cache's counters
+ *
+ * @return  void
+ */
+
+void intervalSample(Interval iv, const CacheCounters *now);
+
+/* printInterval
+ *
+ * Prints the # of intervals, the lowest and highest interval miss
+ * ratios, and the # of phase changes.
+ *
+ * @param   iv              time series to print
+ *
+ * @return  void
+ */
+
+void printInterval(Interval iv);
+
+/* destroyInterval
+ *
+ * Closes the CSV output and frees the time series. Passing NULL does
+ * nothing.
+ *
+ * @param   iv              time series to destroy
+ *
+ * @return  void
+ */
+
+void destroyInterval(Interval iv);
+
+#endif
+/* INTERVAL_H */
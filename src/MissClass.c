@@ -0,0 +1,357 @@
+/* File: MissClass.c
+ *
+ * 3C miss classification. See MissClass.h for the classes.
+ *
+ * The hash table uses linear probing and only ever grows (at half
+ * load). The fully-associative shadow cache is an LRU list threaded
+ * through the table itself: each slot of a cached block holds the slots
+ * of its neighbours, so the lookup and the relink of a shadow hit share
+ * one cache line. head is the most recently used block, tail the least.
+ *
+ */
+
+/********************************
+ *     1. Includes              *
+ *******************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "MissClass.h"
+
+/********************************
+ *     2. Structs               *
+ ********************************/
+
+/* Slot
+ *
+ * @param   block           block number
+ * @param   prev            slot of the previous (more recent) cached
+ *                          block or NO_SLOT, NOT_CACHED if the block is
+ *                          not cached, or EMPTY_SLOT
+ * @param   next            slot of the next (less recent) cached block,
+ *                          or NO_SLOT
+ */
+
+struct Slot_ {
+    uint64_t block;
+    int prev;
+    int next;
+};
+
+#define EMPTY_SLOT -3
+#define NOT_CACHED -2
+#define NO_SLOT -1
+#define INITIAL_BITS 10
+
+/* MissClass
+ *
+ * @param   slots           hash table of every block seen
+ * @param   slot_bits       log2 of the # of slots
+ * @param   seen            # of blocks seen
+ * @param   capacity        # of blocks in the shadow cache
+ * @param   used            # of blocks cached
+ * @param   head            slot of the most recently used block
+ * @param   tail            slot of the least recently used block
+ * @param   compulsory      # of compulsory misses
+ * @param   capacity_misses # of capacity misses
+ * @param   conflict        # of conflict misses
+ */
+
+struct MissClass_ {
+    struct Slot_* slots;
+    int slot_bits;
+    unsigned int seen;
+    int capacity;
+    int used;
+    int head;
+    int tail;
+    long long compulsory;
+    long long capacity_misses;
+    long long conflict;
+};
+
+/********************************
+ *     3. Hash Table            *
+ ********************************/
+
+/* hashBlock
+ *
+ * Fibonacci hashing: the slot is the top 'bits' bits of the product, which
+ * depend on every bit of the block number, so power-of-two strides spread
+ * over the table instead of piling into one probe run.
+ */
+
+static inline unsigned int hashBlock(uint64_t block, int bits) {
+    return (unsigned int) ((block * 0x9E3779B97F4A7C15ULL) >> (64 - bits));
+}
+
+/* findSlot
+ *
+ * Returns the slot of 'block', or the empty slot where it belongs.
+ */
+
+static inline unsigned int findSlot(struct MissClass_* mc, uint64_t block) {
+
+    unsigned int mask = (1u << mc->slot_bits) - 1;
+    unsigned int i = hashBlock(block, mc->slot_bits);
+
+    while(mc->slots[i].prev != EMPTY_SLOT && mc->slots[i].block != block) {
+        i = (i + 1) & mask;
+    }
+
+    return i;
+}
+
+/* growSlots
+ *
+ * Doubles the hash table. The blocks move to new slots, so the links of
+ * the LRU list are translated through a map from old to new slot.
+ */
+
+static void growSlots(struct MissClass_* mc) {
+
+    struct Slot_* old = mc->slots;
+    unsigned int count = 1u << mc->slot_bits;
+    unsigned int* moved;
+    unsigned int i, j;
+
+    moved = (unsigned int*) malloc(count * sizeof(unsigned int));
+    mc->slot_bits++;
+    mc->slots = (struct Slot_*) malloc(count * 2 * sizeof(struct Slot_));
+    assert(moved != NULL && mc->slots != NULL);
+
+    for(i = 0; i < count * 2; i++) {
+        mc->slots[i].prev = EMPTY_SLOT;
+    }
+
+    for(i = 0; i < count; i++) {
+
+        if(old[i].prev == EMPTY_SLOT) {
+            continue;
+        }
+
+        j = findSlot(mc, old[i].block);
+        mc->slots[j] = old[i];
+        moved[i] = j;
+    }
+
+    for(i = 0; i < count; i++) {
+
+        if(old[i].prev == EMPTY_SLOT || old[i].prev == NOT_CACHED) {
+            continue;
+        }
+
+        j = moved[i];
+
+        if(old[i].prev >= 0) {
+            mc->slots[j].prev = (int) moved[old[i].prev];
+        }
+
+        if(old[i].next >= 0) {
+            mc->slots[j].next = (int) moved[old[i].next];
+        }
+    }
+
+    if(mc->head >= 0) {
+        mc->head = (int) moved[mc->head];
+        mc->tail = (int) moved[mc->tail];
+    }
+
+    free(moved);
+    free(old);
+}
+
+/********************************
+ *     4. Shadow Cache          *
+ ********************************/
+
+static inline void unlinkSlot(struct MissClass_* mc, int n) {
+
+    struct Slot_* s = &mc->slots[n];
+
+    if(s->prev >= 0) {
+        mc->slots[s->prev].next = s->next;
+    }
+    else {
+        mc->head = s->next;
+    }
+
+    if(s->next >= 0) {
+        mc->slots[s->next].prev = s->prev;
+    }
+    else {
+        mc->tail = s->prev;
+    }
+}
+
+static inline void pushSlot(struct MissClass_* mc, int n) {
+
+    mc->slots[n].prev = NO_SLOT;
+    mc->slots[n].next = mc->head;
+
+    if(mc->head >= 0) {
+        mc->slots[mc->head].prev = n;
+    }
+    else {
+        mc->tail = n;
+    }
+
+    mc->head = n;
+}
+
+/********************************
+ *     5. Interface             *
+ ********************************/
+
+/* createMissClass
+ *
+ * Creates a classifier with a shadow cache of 'blocks' blocks. Returns
+ * NULL on failure.
+ *
+ * @param   blocks          capacity of the cache in blocks
+ *
+ * @return  success         new MissClass
+ * @return  failure         NULL
+ */
+
+MissClass createMissClass(int blocks) {
+
+    MissClass mc;
+    unsigned int i;
+
+    if(blocks < 1) {
+        fprintf(stderr, "Error: the shadow cache needs at least one block.\n");
+        return NULL;
+    }
+
+    mc = (MissClass) calloc(1, sizeof(struct MissClass_));
+    assert(mc != NULL);
+
+    mc->slot_bits = INITIAL_BITS;
+    mc->slots = (struct Slot_*) malloc((1u << INITIAL_BITS) * sizeof(struct Slot_));
+    assert(mc->slots != NULL);
+
+    for(i = 0; i < (1u << INITIAL_BITS); i++) {
+        mc->slots[i].prev = EMPTY_SLOT;
+    }
+
+    mc->capacity = blocks;
+    mc->head = NO_SLOT;
+    mc->tail = NO_SLOT;
+
+    return mc;
+}
+
+/* missClassAccess
+ *
+ * Records one access and, if the cache missed, classifies the miss.
+ *
+ * @param   mc              target classifier
+ * @param   block           block number (address >> offset bits)
+ * @param   hit             the cache hit
+ *
+ * @return  void
+ */
+
+void missClassAccess(MissClass mc, uint64_t block, int hit) {
+
+    int i = (int) findSlot(mc, block);
+    int state = mc->slots[i].prev;
+    int n;
+
+    /* a shadow hit only moves the block to the front */
+
+    if(state >= NO_SLOT) {
+
+        if(!hit) {
+            mc->conflict++;
+        }
+
+        if(mc->head != i) {
+            unlinkSlot(mc, i);
+            pushSlot(mc, i);
+        }
+
+        return;
+    }
+
+    if(state == EMPTY_SLOT) {
+
+        if(!hit) {
+            mc->compulsory++;
+        }
+
+        mc->slots[i].block = block;
+        mc->seen++;
+    }
+    else if(!hit) {
+        mc->capacity_misses++;
+    }
+
+    /* bring the block into the shadow cache, evicting the LRU block */
+
+    if(mc->used < mc->capacity) {
+        mc->used++;
+    }
+    else {
+        n = mc->tail;
+        unlinkSlot(mc, n);
+        mc->slots[n].prev = NOT_CACHED;
+    }
+
+    pushSlot(mc, i);
+
+    if(mc->seen * 2 > (1u << mc->slot_bits) - 1) {
+        growSlots(mc);
+    }
+}
+
+/* missClassPrefetch
+ *
+ * Starts loading the hash slot of a block that is accessed soon.
+ *
+ * @param   mc              target classifier
+ * @param   block           block number (address >> offset bits)
+ *
+ * @return  void
+ */
+
+void missClassPrefetch(MissClass mc, uint64_t block) {
+    __builtin_prefetch(&mc->slots[hashBlock(block, mc->slot_bits)]);
+}
+
+/* printMissClass
+ *
+ * Prints the # and share of compulsory, capacity, and conflict misses.
+ *
+ * @param   mc              classifier to print
+ *
+ * @return  void
+ */
+
+void printMissClass(MissClass mc) {
+
+    long long misses = mc->compulsory + mc->capacity_misses + mc->conflict;
+
+    printf("\tCompulsory misses: %lld (%2.2f%%)\n", mc->compulsory, misses ? ((double) mc->compulsory / (double) misses) * 100 : 0.0);
+    printf("\tCapacity misses: %lld (%2.2f%%)\n", mc->capacity_misses, misses ? ((double) mc->capacity_misses / (double) misses) * 100 : 0.0);
+    printf("\tConflict misses: %lld (%2.2f%%)\n\n", mc->conflict, misses ? ((double) mc->conflict / (double) misses) * 100 : 0.0);
+}
+
+/* destroyMissClass
+ *
+ * Frees the classifier. Passing NULL does nothing.
+ *
+ * @param   mc              classifier to destroy
+ *
+ * @return  void
+ */
+
+void destroyMissClass(MissClass mc) {
+
+    if(mc != NULL) {
+        free(mc->slots);
+        free(mc);
+    }
+}
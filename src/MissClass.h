@@ -0,0 +1,89 @@
+/* File: MissClass.h
+ *
+ * 3C miss classification.
+ *
+ * Every miss of a cache is put in one of three classes:
+ *
+ *      compulsory  the first access to its block
+ *      capacity    would also miss in a fully-associative LRU cache
+ *                  of the same size
+ *      conflict    every other miss: it hits in the fully-associative
+ *                  cache, so only the mapping to sets made it miss
+ *
+ * One hash table, which never forgets a block, records every block seen
+ * (for compulsory misses). The fully-associative shadow cache is a
+ * doubly linked LRU list threaded through the same table, so each
+ * access costs one hash lookup and a few index updates.
+ *
+ */
+
+#ifndef MISSCLASS_H
+#define MISSCLASS_H
+
+#include <stdint.h>
+
+/* Typedefs */
+typedef struct MissClass_* MissClass;
+
+/* createMissClass
+ *
+ * Creates a classifier with a shadow cache of 'blocks' blocks. Returns
+ * NULL on failure.
+ *
+ * @param   blocks          capacity of the cache in blocks
+ *
+ * @return  success         new MissClass
+ * @return  failure         NULL
+ */
+
+MissClass createMissClass(int blocks);
+
+/* missClassAccess
+ *
+ * Records one access and, if the cache missed, classifies the miss.
+ *
+ * @param   mc              target classifier
+ * @param   block           block number (address >> offset bits)
+ * @param   hit             the cache hit
+ *
+ * @return  void
+ */
+
+void missClassAccess(MissClass mc, uint64_t block, int hit);
+
+/* missClassPrefetch
+ *
+ * Starts loading the hash slot of a block that is accessed soon.
+ *
+ * @param   mc              target classifier
+ * @param   block           block number (address >> offset bits)
+ *
+ * @return  void
+ */
+
+void missClassPrefetch(MissClass mc, uint64_t block);
+
+/* printMissClass
+ *
+ * Prints the # and share of compulsory, capacity, and conflict misses.
+ *
+ * @param   mc              classifier to print
+ *
+ * @return  void
+ */
+
+void printMissClass(MissClass mc);
+
+/* destroyMissClass
+ *
+ * Frees the classifier. Passing NULL does nothing.
+ *
+ * @param   mc              classifier to destroy
+ *
+ * @return  void
+ */
+
+void destroyMissClass(MissClass mc);
+
+#endif
+/* MISSCLASS_H */
@@ -0,0 +1,265 @@
+/* File: Mshr.c
+ *
+ * Non-blocking cache timing with miss status holding registers. See
+ * Mshr.h for the model.
+ *
+ * The busy MSHRs are kept unordered in the first 'busy' slots of two
+ * small arrays (block, completion cycle). There are at most MAX_MSHRS,
+ * so a linear scan finds the next to complete. Time only moves forward:
+ * every step from one cycle to the next is added to the occupancy
+ * histogram under the # of MSHRs busy during it.
+ *
+ */
+
+/********************************
+ *     1. Includes              *
+ *******************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "Mshr.h"
+
+/********************************
+ *     2. Structs               *
+ ********************************/
+
+/* Mshr
+ *
+ * @param   entries         # of MSHRs
+ * @param   latency         cycles to fetch a block
+ * @param   busy            # of MSHRs in use
+ * @param   blocks          block being fetched by each busy MSHR
+ * @param   done            cycle at which each busy MSHR's block arrives
+ * @param   clock           current cycle
+ * @param   occupancy       # of cycles with 0 .. entries MSHRs busy
+ * @param   primary         # of misses that fetched a block
+ * @param   secondary       # of accesses merged into a busy MSHR
+ * @param   stalls          # of fetches that found every MSHR busy
+ * @param   stall_cycles    # of cycles spent waiting for a free MSHR
+ */
+
+struct Mshr_ {
+    int entries;
+    int latency;
+    int busy;
+    uint64_t* blocks;
+    long long* done;
+    long long clock;
+    long long* occupancy;
+    long long primary;
+    long long secondary;
+    long long stalls;
+    long long stall_cycles;
+};
+
+/********************************
+ *     3. Timing                *
+ ********************************/
+
+/* advance
+ *
+ * Moves the clock forward to 'cycle', freeing every MSHR whose block
+ * arrives on the way.
+ */
+
+static void advance(struct Mshr_* mshr, long long cycle) {
+
+    int i, first;
+
+    while(mshr->busy > 0) {
+
+        first = 0;
+
+        for(i = 1; i < mshr->busy; i++) {
+            if(mshr->done[i] < mshr->done[first]) {
+                first = i;
+            }
+        }
+
+        if(mshr->done[first] > cycle) {
+            break;
+        }
+
+        mshr->occupancy[mshr->busy] += mshr->done[first] - mshr->clock;
+        mshr->clock = mshr->done[first];
+
+        /* free it by moving the last busy MSHR into its slot */
+
+        mshr->busy--;
+        mshr->blocks[first] = mshr->blocks[mshr->busy];
+        mshr->done[first] = mshr->done[mshr->busy];
+    }
+
+    mshr->occupancy[mshr->busy] += cycle - mshr->clock;
+    mshr->clock = cycle;
+}
+
+/* nextFree
+ *
+ * Returns the cycle at which the first busy MSHR is freed.
+ */
+
+static long long nextFree(struct Mshr_* mshr) {
+
+    long long cycle = mshr->done[0];
+    int i;
+
+    for(i = 1; i < mshr->busy; i++) {
+        if(mshr->done[i] < cycle) {
+            cycle = mshr->done[i];
+        }
+    }
+
+    return cycle;
+}
+
+/********************************
+ *     4. Interface             *
+ ********************************/
+
+/* createMshr
+ *
+ * Creates the timing model for a cache. Returns NULL on failure.
+ *
+ * @param   entries         # of MSHRs (1 - MAX_MSHRS)
+ * @param   latency         cycles to fetch a block from memory
+ *
+ * @return  success         new Mshr
+ * @return  failure         NULL
+ */
+
+Mshr createMshr(int entries, int latency) {
+
+    Mshr mshr;
+
+    if(entries < 1 || entries > MAX_MSHRS) {
+        fprintf(stderr, "Error: the number of MSHRs must be 1 - %d.\n", MAX_MSHRS);
+        return NULL;
+    }
+
+    mshr = (Mshr) calloc(1, sizeof(struct Mshr_));
+    assert(mshr != NULL);
+
+    mshr->entries = entries;
+    mshr->latency = latency;
+
+    mshr->blocks = (uint64_t*) malloc(entries * sizeof(uint64_t));
+    mshr->done = (long long*) malloc(entries * sizeof(long long));
+    mshr->occupancy = (long long*) calloc(entries + 1, sizeof(long long));
+    assert(mshr->blocks != NULL && mshr->done != NULL && mshr->occupancy != NULL);
+
+    return mshr;
+}
+
+/* mshrAccess
+ *
+ * Times one access, after the cache has looked it up.
+ *
+ * @param   mshr            target model
+ * @param   block           block number (address >> offset bits)
+ * @param   fetch           the access fetched the block from memory
+ *
+ * @return  void
+ */
+
+void mshrAccess(Mshr mshr, uint64_t block, int fetch) {
+
+    long long cycle;
+    int i;
+
+    /* every access takes a cycle to issue, hit or miss */
+
+    advance(mshr, mshr->clock + 1);
+
+    /* the block is on its way: merge into its MSHR. The tag store
+     * already holds it, so this is a hit there, or a refetch if it
+     * was evicted before it even arrived */
+
+    for(i = 0; i < mshr->busy; i++) {
+        if(mshr->blocks[i] == block) {
+            mshr->secondary++;
+            return;
+        }
+    }
+
+    if(!fetch) {
+        return;
+    }
+
+    mshr->primary++;
+
+    /* no MSHR left: wait for the first to free */
+
+    if(mshr->busy == mshr->entries) {
+        cycle = nextFree(mshr);
+        mshr->stalls++;
+        mshr->stall_cycles += cycle - mshr->clock;
+        advance(mshr, cycle);
+    }
+
+    mshr->blocks[mshr->busy] = block;
+    mshr->done[mshr->busy] = mshr->clock + mshr->latency;
+    mshr->busy++;
+}
+
+/* printMshr
+ *
+ * Waits for the outstanding misses, then prints the non-blocking cycle
+ * count, the primary and secondary misses, the stalls, the MLP, and the
+ * MSHR occupancy histogram.
+ *
+ * @param   mshr            model to print
+ *
+ * @return  void
+ */
+
+void printMshr(Mshr mshr) {
+
+    long long outstanding = 0, missing = 0;
+    int k;
+
+    while(mshr->busy > 0) {
+        advance(mshr, nextFree(mshr));
+    }
+
+    for(k = 1; k <= mshr->entries; k++) {
+        outstanding += k * mshr->occupancy[k];
+        missing += mshr->occupancy[k];
+    }
+
+    printf("\tCycles with cache (non-blocking, %d MSHRs): %lld\n\n", mshr->entries, mshr->clock);
+
+    printf("\tPrimary misses: %lld\n", mshr->primary);
+    printf("\tSecondary misses (merged): %lld\n", mshr->secondary);
+    printf("\tMSHR full stalls: %lld (%lld cycles)\n", mshr->stalls, mshr->stall_cycles);
+    printf("\tMemory-level parallelism: %.2f\n\n", missing ? (double) outstanding / (double) missing : 0.0);
+
+    printf("\tMSHR occupancy:\n");
+
+    for(k = 0; k <= mshr->entries; k++) {
+        printf("\t\t%3d busy: %12lld cycles %7.2f%%\n", k, mshr->occupancy[k],
+               mshr->clock ? ((double) mshr->occupancy[k] / (double) mshr->clock) * 100 : 0.0);
+    }
+
+    printf("\n");
+}
+
+/* destroyMshr
+ *
+ * Frees the model. Passing NULL does nothing.
+ *
+ * @param   mshr            model to destroy
+ *
+ * @return  void
+ */
+
+void destroyMshr(Mshr mshr) {
+
+    if(mshr != NULL) {
+        free(mshr->blocks);
+        free(mshr->done);
+        free(mshr->occupancy);
+        free(mshr);
+    }
+}
@@ -0,0 +1,86 @@
+/* File: Mshr.h
+ *
+ * Non-blocking cache timing with miss status holding registers.
+ *
+ * The cache's own cycle count is blocking: every miss stalls for the
+ * whole memory latency before the next access. This model instead lets
+ * the next accesses go on while a miss is outstanding. Each access
+ * takes one cycle to issue. A miss that has to fetch its block takes an
+ * MSHR, which is freed when the block arrives 'latency' cycles later. A
+ * miss on a block that is already being fetched (a secondary miss)
+ * merges into its MSHR. The cache only stalls when a fetch needs an
+ * MSHR and all of them are busy; then it waits for the first to free.
+ * Write-backs and write-throughs are posted and never hold an MSHR.
+ * Prefetches are timed by the cache's own prefetch queue and do not
+ * hold one either; only demand fetches are passed in as misses.
+ *
+ * Besides the cycle count, the model records how many cycles each
+ * number of MSHRs was busy, which gives the memory-level parallelism
+ * (MLP): the average number of outstanding misses over the cycles with
+ * at least one.
+ *
+ */
+
+#ifndef MSHR_H
+#define MSHR_H
+
+#include <stdint.h>
+
+/* Limits */
+#define MAX_MSHRS 64
+
+/* Typedefs */
+typedef struct Mshr_* Mshr;
+
+/* createMshr
+ *
+ * Creates the timing model for a cache. Returns NULL on failure.
+ *
+ * @param   entries         # of MSHRs (1 - MAX_MSHRS)
+ * @param   latency         cycles to fetch a block from memory
+ *
+ * @return  success         new Mshr
+ * @return  failure         NULL
+ */
+
+Mshr createMshr(int entries, int latency);
+
+/* mshrAccess
+ *
+ * Times one access, after the cache has looked it up.
+ *
+ * @param   mshr            target model
+ * @param   block           block number (address >> offset bits)
+ * @param   fetch           the access fetched the block from memory
+ *
+ * @return  void
+ */
+
+void mshrAccess(Mshr mshr, uint64_t block, int fetch);
+
+/* printMshr
+ *
+ * Waits for the outstanding misses, then prints the non-blocking cycle
+ * count, the primary and secondary misses, the stalls, the MLP, and the
+ * MSHR occupancy histogram.
+ *
+ * @param   mshr            model to print
+ *
+ * @return  void
+ */
+
+void printMshr(Mshr mshr);
+
+/* destroyMshr
+ *
+ * Frees the model. Passing NULL does nothing.
+ *
+ * @param   mshr            model to destroy
+ *
+ * @return  void
+ */
+
+void destroyMshr(Mshr mshr);
+
+#endif
+/* MSHR_H */
@@ -0,0 +1,126 @@
+/* File: Policy.c
+ *
+ * Replacement policies: names, metadata sizes, and setup. The per-access
+ * operations are inline in Policy.h so the access kernels can specialize
+ * them. See Policy.h for the metadata layouts.
+ *
+ */
+
+/********************************
+ *     1. Includes              *
+ *******************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "Policy.h"
+
+/********************************
+ *     2. Globals               *
+ ********************************/
+
+static const char *names[POLICY_COUNT] = {
+    "lru", "plru", "fifo", "random", "srrip", "brrip", "drrip"
+};
+
+static const char *stateNames[POLICY_COUNT] = {
+    "lru", "plru", "fifo", "random", "rrpv", "rrpv", "rrpv"
+};
+
+/********************************
+ *     3. Functions             *
+ ********************************/
+
+int parsePolicy(const char *name) {
+
+    int policy;
+
+    for(policy = 0; policy < POLICY_COUNT; policy++) {
+        if(strcmp(name, names[policy]) == 0) {
+            return policy;
+        }
+    }
+
+    return -1;
+}
+
+const char *policyName(int policy) {
+    return names[policy];
+}
+
+const char *policyStateName(int policy) {
+    return stateNames[policy];
+}
+
+size_t policyMetaBytes(int policy, int ways) {
+
+    switch(policy) {
+        case POLICY_LRU:    return (size_t) ((ways + 7) & ~7);
+        case POLICY_PLRU:   return sizeof(uint32_t);
+        case POLICY_FIFO:   return 1;
+        case POLICY_RANDOM: return 0;
+        default:            return sizeof(uint64_t);
+    }
+}
+
+int policyCheck(int policy, int ways) {
+
+    if(policy < 0 || policy >= POLICY_COUNT) {
+        fprintf(stderr, "Error: Unknown replacement policy!\n");
+        return -1;
+    }
+
+    if(policy == POLICY_PLRU && (ways & (ways - 1)) != 0) {
+        fprintf(stderr, "Error: Tree-PLRU needs a power of two # of ways!\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+int policyIsSetLocal(int policy) {
+    return policy != POLICY_RANDOM && policy != POLICY_BRRIP && policy != POLICY_DRRIP;
+}
+
+void initPolicyState(PolicyState *state, int policy, int number_of_sets, uint64_t seed) {
+
+    unsigned int stride;
+
+    (void) policy;
+
+    /* xorshift must not start at 0 */
+
+    state->rng = seed * 0x9E3779B97F4A7C15ULL + 1;
+    state->psel = PSEL_MAX / 2 + 1;
+
+    /* DRRIP: 32 leader sets of each kind where there are enough sets */
+
+    stride = (unsigned int) number_of_sets / 32;
+    if(stride < 2) stride = 2;
+
+    state->leader_mask = stride - 1;
+}
+
+void initPolicySet(int policy, unsigned char *meta, int ways) {
+
+    size_t j;
+
+    /* LRU ranks must start out as a permutation; padding lanes get a
+     * rank no touch can ever be above, so they never change */
+
+    if(policy == POLICY_LRU) {
+        for(j = 0; j < policyMetaBytes(policy, ways); j++) {
+            meta[j] = (unsigned char) ((int) j < ways ? j : 0x7f);
+        }
+    }
+}
+
+int policyWayState(int policy, const unsigned char *meta, int ways, int way) {
+
+    switch(policy) {
+        case POLICY_LRU:    return meta[way];
+        case POLICY_PLRU:   return plruVictim(meta, ways) == way;
+        case POLICY_FIFO:   return (way - meta[0] + ways) % ways;
+        case POLICY_RANDOM: return 0;
+        default:            return (int) ((loadMeta64(meta) >> (2 * way)) & 3);
+    }
+}
@@ -0,0 +1,437 @@
+/* File: Policy.h
+ *
+ * Replacement policies and their per-set metadata.
+ *
+ * Every policy keeps its state in a small, bit-packed block of bytes
+ * stored in each set's record after the tags (policyMetaBytes gives
+ * its size), plus a few cache-wide fields in PolicyState:
+ *
+ *      lru     one byte per way holding its recency rank (0 = most
+ *              recent); updated and searched 8 ways per 64-bit word
+ *      plru    tree-PLRU, ways - 1 direction bits in one 32-bit word
+ *      fifo    one byte: the way that will be replaced next
+ *      random  no per-set state; victims come from a seeded xorshift
+ *      srrip   2-bit re-reference prediction values (RRPV), all ways in
+ *              one 64-bit word; fills are predicted "long"
+ *      brrip   as srrip, but fills are predicted "distant" except for
+ *              1 in BRRIP_EPSILON
+ *      drrip   set dueling between srrip and brrip leader sets with a
+ *              PSEL counter choosing the policy for the other sets
+ *
+ * Invalid ways are always filled first, lowest way first, so a policy
+ * only chooses among valid blocks. The inline functions below switch
+ * on a policy that is a compile-time constant in each access kernel,
+ * so only the code for that policy is left.
+ *
+ */
+
+#ifndef POLICY_H
+#define POLICY_H
+
+#include <stdint.h>
+#include <string.h>
+
+/* Policies */
+enum {
+    POLICY_LRU,
+    POLICY_PLRU,
+    POLICY_FIFO,
+    POLICY_RANDOM,
+    POLICY_SRRIP,
+    POLICY_BRRIP,
+    POLICY_DRRIP,
+    POLICY_COUNT
+};
+
+/* RRIP parameters */
+#define RRPV_MAX 3
+#define BRRIP_EPSILON 32
+#define PSEL_MAX 1023
+
+/* PolicyState
+ *
+ * Cache-wide replacement state.
+ *
+ * @param   rng             xorshift64 state (random, brrip, drrip)
+ * @param   psel            DRRIP selector: above PSEL_MAX / 2 means brrip
+ * @param   leader_mask     DRRIP: a set leads when (index & leader_mask)
+ *                          is 0 (srrip) or leader_mask / 2 + 1 (brrip)
+ */
+
+typedef struct {
+    uint64_t rng;
+    int psel;
+    unsigned int leader_mask;
+} PolicyState;
+
+/* parsePolicy
+ *
+ * Returns the policy with the given name ("lru", "plru", "fifo",
+ * "random", "srrip", "brrip", "drrip"), or -1 if there is none.
+ *
+ * @param   name            policy name
+ *
+ * @return  success         policy
+ * @return  failure         -1
+ */
+
+int parsePolicy(const char *name);
+
+/* policyName
+ *
+ * Returns the name of a policy.
+ *
+ * @param   policy          policy
+ *
+ * @return  name
+ */
+
+const char *policyName(int policy);
+
+/* policyMetaBytes
+ *
+ * Returns the # of metadata bytes a policy needs per set.
+ *
+ * @param   policy          policy
+ * @param   ways            # of ways
+ *
+ * @return  # of bytes
+ */
+
+size_t policyMetaBytes(int policy, int ways);
+
+/* policyCheck
+ *
+ * Checks that a policy supports an associativity, printing an error
+ * if it does not.
+ *
+ * @param   policy          policy
+ * @param   ways            # of ways
+ *
+ * @return  supported       0
+ * @return  unsupported     -1
+ */
+
+int policyCheck(int policy, int ways);
+
+/* policyIsSetLocal
+ *
+ * Returns 1 if a policy's decisions depend only on the set's own
+ * history, so that sets may be simulated independently (-shards).
+ * Policies drawing on the cache-wide random stream or PSEL return 0.
+ *
+ * @param   policy          policy
+ *
+ * @return  set local       1
+ * @return  cache-wide      0
+ */
+
+int policyIsSetLocal(int policy);
+
+/* initPolicyState / initPolicySet
+ *
+ * Set up the cache-wide state and one set's metadata (which must be
+ * zeroed beforehand).
+ */
+
+void initPolicyState(PolicyState *state, int policy, int number_of_sets, uint64_t seed);
+void initPolicySet(int policy, unsigned char *meta, int ways);
+
+/* policyWayState
+ *
+ * Returns the state of one way for the [-d] dump: its LRU rank, 1 if
+ * tree-PLRU points at it, its distance from the FIFO pointer, or its
+ * RRPV.
+ *
+ * @param   policy          policy
+ * @param   meta            the set's metadata
+ * @param   ways            # of ways
+ * @param   way             way to describe
+ *
+ * @return  state value
+ */
+
+int policyWayState(int policy, const unsigned char *meta, int ways, int way);
+
+/* policyStateName
+ *
+ * Returns the label of the value printed by policyWayState.
+ */
+
+const char *policyStateName(int policy);
+
+/********************************
+ *     Inline Operations        *
+ ********************************/
+
+#define POLICY_ONES  0x0101010101010101ULL
+#define POLICY_HIGHS 0x8080808080808080ULL
+#define POLICY_RRPV_LOW 0x5555555555555555ULL
+
+static inline uint64_t loadMeta64(const unsigned char *meta) {
+
+    uint64_t word;
+
+    memcpy(&word, meta, sizeof(word));
+    return word;
+}
+
+static inline void storeMeta64(unsigned char *meta, uint64_t word) {
+    memcpy(meta, &word, sizeof(word));
+}
+
+/* policyRandom
+ *
+ * Next value of the cache's xorshift64* stream.
+ */
+
+static inline uint32_t policyRandom(PolicyState *state) {
+
+    uint64_t x = state->rng;
+
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    state->rng = x;
+
+    return (uint32_t) ((x * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+/* lruTouch
+ *
+ * Makes 'way' the most recent: every way with a smaller rank ages by
+ * one. A byte lane is below the rank r exactly when (lane | 0x80) - r
+ * clears bit 7, and no lane borrows from its neighbour.
+ */
+
+static inline void lruTouch(unsigned char *meta, int ways, int way) {
+
+    uint64_t rank = meta[way] * POLICY_ONES;
+    uint64_t word, below;
+    int k;
+
+    for(k = 0; k < ways; k += 8) {
+        word = loadMeta64(meta + k);
+        below = ~((word | POLICY_HIGHS) - rank) & POLICY_HIGHS;
+        storeMeta64(meta + k, word + (below >> 7));
+    }
+
+    meta[way] = 0;
+}
+
+/* lruVictim
+ *
+ * Returns the way whose rank is ways - 1 (the least recent), using the
+ * usual lowest-zero-byte test on rank ^ (ways - 1).
+ */
+
+static inline int lruVictim(const unsigned char *meta, int ways) {
+
+    uint64_t oldest = (uint64_t) (ways - 1) * POLICY_ONES;
+    uint64_t diff, zero;
+    int k;
+
+    for(k = 0; k < ways; k += 8) {
+
+        diff = loadMeta64(meta + k) ^ oldest;
+        zero = (diff - POLICY_ONES) & ~diff & POLICY_HIGHS;
+
+        if(zero != 0) {
+            return k + (__builtin_ctzll(zero) >> 3);
+        }
+    }
+
+    return 0;
+}
+
+/* plruTouch / plruVictim
+ *
+ * Nodes are numbered from 1 (the root) with children 2n and 2n + 1;
+ * bit n of the tree word is the direction of the next victim below
+ * node n (1 = upper half). Touching a way points every node on its
+ * path away from it.
+ */
+
+static inline void plruTouch(unsigned char *meta, int ways, int way) {
+
+    uint32_t tree;
+    int node = 1;
+    int level, bit;
+
+    memcpy(&tree, meta, sizeof(tree));
+
+    for(level = __builtin_ctz(ways) - 1; level >= 0; level--) {
+
+        bit = (way >> level) & 1;
+
+        if(bit) {
+            tree &= ~(1u << node);
+        }
+        else {
+            tree |= 1u << node;
+        }
+
+        node = 2 * node + bit;
+    }
+
+    memcpy(meta, &tree, sizeof(tree));
+}
+
+static inline int plruVictim(const unsigned char *meta, int ways) {
+
+    uint32_t tree;
+    int node = 1;
+
+    memcpy(&tree, meta, sizeof(tree));
+
+    while(node < ways) {
+        node = 2 * node + ((tree >> node) & 1);
+    }
+
+    return node - ways;
+}
+
+/* rripSet / rripVictim
+ *
+ * RRPVs are 2-bit fields, way j at bits 2j and 2j + 1. The victim is
+ * the lowest way at RRPV_MAX; if there is none, every way ages by one
+ * (no field can overflow, since none is at RRPV_MAX) until one is.
+ */
+
+static inline void rripSet(unsigned char *meta, int way, uint64_t rrpv) {
+
+    uint64_t word = loadMeta64(meta);
+
+    word &= ~(3ULL << (2 * way));
+    word |= rrpv << (2 * way);
+
+    storeMeta64(meta, word);
+}
+
+static inline int rripVictim(unsigned char *meta, int ways) {
+
+    uint64_t lanes = (ways == 32) ? POLICY_RRPV_LOW : POLICY_RRPV_LOW & ((1ULL << (2 * ways)) - 1);
+    uint64_t word = loadMeta64(meta);
+    uint64_t distant;
+
+    while((distant = word & (word >> 1) & lanes) == 0) {
+        word += lanes;
+    }
+
+    storeMeta64(meta, word);
+
+    return __builtin_ctzll(distant) >> 1;
+}
+
+/* brripInsertion
+ *
+ * RRPV for a BRRIP fill: distant, except once in BRRIP_EPSILON.
+ */
+
+static inline uint64_t brripInsertion(PolicyState *state) {
+    return (policyRandom(state) % BRRIP_EPSILON == 0) ? RRPV_MAX - 1 : RRPV_MAX;
+}
+
+/* policyHit
+ *
+ * Updates the metadata after a hit on 'way'.
+ */
+
+static inline void policyHit(const int policy, unsigned char *meta, const int ways, int way) {
+
+    switch(policy) {
+        case POLICY_LRU:    lruTouch(meta, ways, way); break;
+        case POLICY_PLRU:   plruTouch(meta, ways, way); break;
+        case POLICY_SRRIP:
+        case POLICY_BRRIP:
+        case POLICY_DRRIP:  rripSet(meta, way, 0); break;
+        default:            break;
+    }
+}
+
+/* policyVictim
+ *
+ * Chooses the way to replace in a set whose ways are all valid.
+ */
+
+static inline int policyVictim(const int policy, unsigned char *meta, const int ways, PolicyState *state) {
+
+    int way;
+
+    switch(policy) {
+
+        case POLICY_LRU:
+            return lruVictim(meta, ways);
+
+        case POLICY_PLRU:
+            return plruVictim(meta, ways);
+
+        case POLICY_FIFO:
+            way = meta[0];
+            meta[0] = (unsigned char) ((way + 1 == ways) ? 0 : way + 1);
+            return way;
+
+        case POLICY_RANDOM:
+            return (int) (policyRandom(state) % (uint32_t) ways);
+
+        default:
+            return rripVictim(meta, ways);
+    }
+}
+
+/* policyFill
+ *
+ * Updates the metadata after a miss has filled 'way' of set 'index'.
+ * For DRRIP this is also where leader set misses move PSEL.
+ */
+
+static inline void policyFill(const int policy, unsigned char *meta, const int ways, int way, PolicyState *state, unsigned int index) {
+
+    unsigned int leader;
+
+    switch(policy) {
+
+        case POLICY_LRU:
+            lruTouch(meta, ways, way);
+            break;
+
+        case POLICY_PLRU:
+            plruTouch(meta, ways, way);
+            break;
+
+        case POLICY_SRRIP:
+            rripSet(meta, way, RRPV_MAX - 1);
+            break;
+
+        case POLICY_BRRIP:
+            rripSet(meta, way, brripInsertion(state));
+            break;
+
+        case POLICY_DRRIP:
+
+            leader = index & state->leader_mask;
+
+            if(leader == 0) {
+                if(state->psel < PSEL_MAX) state->psel++;
+                rripSet(meta, way, RRPV_MAX - 1);
+            }
+            else if(leader == state->leader_mask / 2 + 1) {
+                if(state->psel > 0) state->psel--;
+                rripSet(meta, way, brripInsertion(state));
+            }
+            else if(state->psel > PSEL_MAX / 2) {
+                rripSet(meta, way, brripInsertion(state));
+            }
+            else {
+                rripSet(meta, way, RRPV_MAX - 1);
+            }
+
+            break;
+
+        default:
+            break;
+    }
+}
+
+#endif
+/* POLICY_H */
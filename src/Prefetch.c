@@ -0,0 +1,456 @@
+/* File: Prefetch.c
+ *
+ * Hardware prefetcher models. See Prefetch.h for what each one does.
+ *
+ * Block numbers are unsigned 64-bit integers and wrap, so strides are
+ * the (signed) difference of two block numbers. The stride table and the stream
+ * buffer are small enough to search linearly.
+ *
+ */
+
+/********************************
+ *     1. Includes              *
+ *******************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "Prefetch.h"
+
+/********************************
+ *     2. Structs               *
+ ********************************/
+
+/* Stream
+ *
+ * One entry of the stride table.
+ *
+ * @param   last            last block of the stream
+ * @param   stride          difference between its last two blocks
+ * @param   confidence      # of times in a row the stride repeated (0 - 3)
+ * @param   used            access count when last matched (0 = free)
+ */
+
+struct Stream_ {
+    uint64_t last;
+    long long stride;
+    int confidence;
+    unsigned long long used;
+};
+
+/* Prefetcher
+ *
+ * @param   kind            PREFETCH_NEXT_LINE, PREFETCH_STRIDE, or PREFETCH_STREAM
+ * @param   degree          blocks prefetched ahead (stream buffer size)
+ * @param   accesses        # of accesses trained on
+ * @param   streams         stride table
+ * @param   buffer          stream buffer blocks, oldest first
+ * @param   arrivals        cycle at which each buffered block arrives
+ * @param   buffered        # of blocks in the stream buffer
+ * @param   tail            last block put in the stream buffer
+ * @param   evicted         block + 1 evicted by a prefetch (0 = empty)
+ */
+
+struct Prefetcher_ {
+    int kind;
+    int degree;
+    unsigned long long accesses;
+    struct Stream_ streams[STRIDE_STREAMS];
+    uint64_t buffer[MAX_PREFETCH_DEGREE];
+    long long arrivals[MAX_PREFETCH_DEGREE];
+    int buffered;
+    uint64_t tail;
+    uint64_t evicted[POLLUTION_TABLE];
+};
+
+/********************************
+ *     3. Globals               *
+ ********************************/
+
+static const char *names[PREFETCH_COUNT] = {
+    "next-line", "stride", "stream"
+};
+
+/********************************
+ *     4. Training              *
+ ********************************/
+
+/* pollutionSlot
+ *
+ * Hashes a block number to its slot in the pollution table.
+ */
+
+static inline unsigned int pollutionSlot(uint64_t block) {
+    return ((unsigned int) (block ^ (block >> 32)) * 2654435761u) >> 22 & (POLLUTION_TABLE - 1);
+}
+
+/* trainStride
+ *
+ * Matches the access to the stream whose last block is nearest (or
+ * starts a new one in place of the least recently used), updates its
+ * stride, and predicts along the stride once it has repeated.
+ */
+
+static int trainStride(struct Prefetcher_* prefetcher, uint64_t block, uint64_t *candidates) {
+
+    struct Stream_ *stream = NULL, *oldest;
+    long long distance, nearest = STRIDE_WINDOW + 1;
+    long long delta;
+    int i;
+
+    oldest = &prefetcher->streams[0];
+
+    for(i = 0; i < STRIDE_STREAMS; i++) {
+
+        if(prefetcher->streams[i].used == 0) {
+            oldest = &prefetcher->streams[i];
+            continue;
+        }
+
+        distance = llabs((long long) (block - prefetcher->streams[i].last));
+
+        if(distance < nearest) {
+            nearest = distance;
+            stream = &prefetcher->streams[i];
+        }
+
+        if(oldest->used != 0 && prefetcher->streams[i].used < oldest->used) {
+            oldest = &prefetcher->streams[i];
+        }
+    }
+
+    prefetcher->accesses++;
+
+    if(stream == NULL) {
+        oldest->last = block;
+        oldest->stride = 0;
+        oldest->confidence = 0;
+        oldest->used = prefetcher->accesses;
+        return 0;
+    }
+
+    stream->used = prefetcher->accesses;
+    delta = (long long) (block - stream->last);
+
+    /* another access to the same block says nothing new */
+
+    if(delta == 0) {
+        return 0;
+    }
+
+    if(delta == stream->stride) {
+        if(stream->confidence < 3) {
+            stream->confidence++;
+        }
+    }
+    else {
+        stream->stride = delta;
+        stream->confidence = 0;
+    }
+
+    stream->last = block;
+
+    if(stream->confidence == 0) {
+        return 0;
+    }
+
+    for(i = 0; i < prefetcher->degree; i++) {
+        candidates[i] = block + (uint64_t) (stream->stride * (i + 1));
+    }
+
+    return prefetcher->degree;
+}
+
+/********************************
+ *     5. Interface             *
+ ********************************/
+
+/* parsePrefetcher
+ *
+ * Returns the prefetcher with the given name ("next-line", "stride",
+ * "stream"), or -1 if there is none.
+ *
+ * @param   name            prefetcher name
+ *
+ * @return  success         prefetcher
+ * @return  failure         -1
+ */
+
+int parsePrefetcher(const char *name) {
+
+    int kind;
+
+    for(kind = 0; kind < PREFETCH_COUNT; kind++) {
+        if(strcmp(name, names[kind]) == 0) {
+            return kind;
+        }
+    }
+
+    return -1;
+}
+
+const char *prefetcherName(int kind) {
+    return names[kind];
+}
+
+/* createPrefetcher
+ *
+ * Creates a prefetcher with no history. Returns NULL (after printing an
+ * error) on failure.
+ *
+ * @param   kind            PREFETCH_NEXT_LINE, PREFETCH_STRIDE, or PREFETCH_STREAM
+ * @param   degree          blocks prefetched ahead (1 - MAX_PREFETCH_DEGREE)
+ *
+ * @return  success         new Prefetcher
+ * @return  failure         NULL
+ */
+
+Prefetcher createPrefetcher(int kind, int degree) {
+
+    Prefetcher prefetcher;
+
+    if(kind < 0 || kind >= PREFETCH_COUNT) {
+        fprintf(stderr, "Error: unknown prefetcher %d.\n", kind);
+        return NULL;
+    }
+
+    if(degree < 1 || degree > MAX_PREFETCH_DEGREE) {
+        fprintf(stderr, "Error: the prefetch degree must be 1 - %d.\n", MAX_PREFETCH_DEGREE);
+        return NULL;
+    }
+
+    prefetcher = (Prefetcher) calloc(1, sizeof(struct Prefetcher_));
+    assert(prefetcher != NULL);
+
+    prefetcher->kind = kind;
+    prefetcher->degree = degree;
+
+    return prefetcher;
+}
+
+int prefetcherKind(Prefetcher prefetcher) {
+    return prefetcher->kind;
+}
+
+int prefetcherDegree(Prefetcher prefetcher) {
+    return prefetcher->degree;
+}
+
+/* prefetchTrain
+ *
+ * Trains the prefetcher on one demand access and returns the blocks to
+ * prefetch. A stream prefetcher expects its buffer to have been flushed
+ * before a PREFETCH_ON_MISS.
+ *
+ * @param   prefetcher      target prefetcher
+ * @param   block           block number of the access
+ * @param   event           PREFETCH_ON_HIT, PREFETCH_ON_MISS, or
+ *                          PREFETCH_ON_USE (first use of a prefetched block)
+ * @param   candidates      output: up to MAX_PREFETCH_DEGREE block numbers
+ *
+ * @return  # of candidates
+ */
+
+int prefetchTrain(Prefetcher prefetcher, uint64_t block, int event, uint64_t *candidates) {
+
+    int i;
+
+    switch(prefetcher->kind) {
+
+        case PREFETCH_NEXT_LINE:
+
+            if(event == PREFETCH_ON_HIT) {
+                return 0;
+            }
+
+            for(i = 0; i < prefetcher->degree; i++) {
+                candidates[i] = block + i + 1;
+            }
+
+            return prefetcher->degree;
+
+        case PREFETCH_STRIDE:
+            return trainStride(prefetcher, block, candidates);
+
+        default:
+
+            /* a new stream fills the whole buffer; a block taken from
+             * it makes room for one more at the tail */
+
+            if(event == PREFETCH_ON_MISS) {
+
+                for(i = 0; i < prefetcher->degree; i++) {
+                    candidates[i] = block + i + 1;
+                }
+
+                return prefetcher->degree;
+            }
+
+            if(event == PREFETCH_ON_USE) {
+                candidates[0] = prefetcher->tail + 1;
+                return 1;
+            }
+
+            return 0;
+    }
+}
+
+/* streamBufferTake
+ *
+ * Looks for a block in the stream buffer. If it is there, it is removed
+ * along with every older block, which the stream skipped.
+ *
+ * @param   prefetcher      target prefetcher
+ * @param   block           block number
+ * @param   arrival         output: cycle at which the block arrives
+ * @param   skipped         output: # of older blocks removed unused
+ *
+ * @return  found           1
+ * @return  not found       0
+ */
+
+int streamBufferTake(Prefetcher prefetcher, uint64_t block, long long *arrival, int *skipped) {
+
+    int i;
+
+    for(i = 0; i < prefetcher->buffered; i++) {
+
+        if(prefetcher->buffer[i] == block) {
+
+            *arrival = prefetcher->arrivals[i];
+            *skipped = i;
+
+            prefetcher->buffered -= i + 1;
+            memmove(prefetcher->buffer, prefetcher->buffer + i + 1, prefetcher->buffered * sizeof(uint64_t));
+            memmove(prefetcher->arrivals, prefetcher->arrivals + i + 1, prefetcher->buffered * sizeof(long long));
+
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* streamBufferPut
+ *
+ * Adds a prefetched block at the tail of the stream buffer. When the
+ * buffer is full its oldest block is dropped.
+ *
+ * @param   prefetcher      target prefetcher
+ * @param   block           block number
+ * @param   arrival         cycle at which the block arrives
+ *
+ * @return  dropped         1 if a block was dropped unused
+ * @return  otherwise       0
+ */
+
+int streamBufferPut(Prefetcher prefetcher, uint64_t block, long long arrival) {
+
+    int dropped = 0;
+
+    if(prefetcher->buffered == prefetcher->degree) {
+
+        prefetcher->buffered--;
+        memmove(prefetcher->buffer, prefetcher->buffer + 1, prefetcher->buffered * sizeof(uint64_t));
+        memmove(prefetcher->arrivals, prefetcher->arrivals + 1, prefetcher->buffered * sizeof(long long));
+        dropped = 1;
+    }
+
+    prefetcher->buffer[prefetcher->buffered] = block;
+    prefetcher->arrivals[prefetcher->buffered] = arrival;
+    prefetcher->buffered++;
+    prefetcher->tail = block;
+
+    return dropped;
+}
+
+/* streamBufferHas
+ *
+ * @param   prefetcher      target prefetcher
+ * @param   block           block number
+ *
+ * @return  1 if the block is in the stream buffer, else 0
+ */
+
+int streamBufferHas(Prefetcher prefetcher, uint64_t block) {
+
+    int i;
+
+    for(i = 0; i < prefetcher->buffered; i++) {
+        if(prefetcher->buffer[i] == block) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* streamBufferFlush
+ *
+ * Empties the stream buffer.
+ *
+ * @param   prefetcher      target prefetcher
+ *
+ * @return  # of blocks removed unused
+ */
+
+int streamBufferFlush(Prefetcher prefetcher) {
+
+    int flushed = prefetcher->buffered;
+
+    prefetcher->buffered = 0;
+
+    return flushed;
+}
+
+/* notePollution
+ *
+ * Remembers that a prefetch evicted a block from the cache.
+ *
+ * @param   prefetcher      target prefetcher
+ * @param   block           block number of the evicted block
+ *
+ * @return  void
+ */
+
+void notePollution(Prefetcher prefetcher, uint64_t block) {
+    prefetcher->evicted[pollutionSlot(block)] = block + 1;
+}
+
+/* checkPollution
+ *
+ * Checks whether a demand miss is on a block a prefetch evicted, and
+ * forgets the block if so.
+ *
+ * @param   prefetcher      target prefetcher
+ * @param   block           block number of the miss
+ *
+ * @return  1 if a prefetch evicted the block, else 0
+ */
+
+int checkPollution(Prefetcher prefetcher, uint64_t block) {
+
+    uint64_t *slot = &prefetcher->evicted[pollutionSlot(block)];
+
+    if(*slot != block + 1) {
+        return 0;
+    }
+
+    *slot = 0;
+
+    return 1;
+}
+
+/* destroyPrefetcher
+ *
+ * Frees the prefetcher. Passing NULL does nothing.
+ *
+ * @param   prefetcher      prefetcher to destroy
+ *
+ * @return  void
+ */
+
+void destroyPrefetcher(Prefetcher prefetcher) {
+    free(prefetcher);
+}
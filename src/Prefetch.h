@@ -0,0 +1,225 @@
+/* File: Prefetch.h
+ *
+ * Hardware prefetcher models.
+ *
+ * A prefetcher watches the demand accesses of one cache and predicts
+ * the blocks that will be needed next:
+ *
+ *      next-line   on a miss, or on the first use of a prefetched
+ *                  block, the next 'degree' blocks (tagged prefetching)
+ *      stride      a small table of streams, each matched to the access
+ *                  by the nearest previous block; once a stream has
+ *                  repeated its stride, the next 'degree' blocks along
+ *                  the stride are prefetched on every access
+ *      stream      a stream buffer of 'degree' blocks beside the cache:
+ *                  a miss that is not in the buffer restarts it at the
+ *                  next blocks, and a miss found in it moves the block
+ *                  into the cache and prefetches one more at the tail
+ *
+ * Next-line and stride prefetches are filled into the cache; stream
+ * prefetches stay in the stream buffer, kept here, until a demand miss
+ * takes them. The cache (see accessSet) does the fills and timing and
+ * keeps the statistics.
+ *
+ * The prefetcher also remembers, in a small direct-mapped table, the
+ * blocks its fills evicted from the cache, so a later demand miss on
+ * one of them can be blamed on the prefetch (pollution).
+ *
+ */
+
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+#include <stdint.h>
+
+/* Prefetchers */
+enum {
+    PREFETCH_NEXT_LINE,
+    PREFETCH_STRIDE,
+    PREFETCH_STREAM,
+    PREFETCH_COUNT
+};
+
+/* Events that train a prefetcher (prefetchTrain) */
+enum {
+    PREFETCH_ON_HIT,
+    PREFETCH_ON_MISS,
+    PREFETCH_ON_USE
+};
+
+/* Limits and defaults */
+#define MAX_PREFETCH_DEGREE 16
+#define DEFAULT_PREFETCH_DEGREE 2
+
+/* Stride streams tracked, and how far (in blocks) an access may be from
+ * a stream's last block to belong to it */
+#define STRIDE_STREAMS 16
+#define STRIDE_WINDOW 256
+
+/* Blocks remembered as evicted by a prefetch (a power of two) */
+#define POLLUTION_TABLE 1024
+
+/* Typedefs */
+typedef struct Prefetcher_* Prefetcher;
+
+/* parsePrefetcher
+ *
+ * Returns the prefetcher with the given name ("next-line", "stride",
+ * "stream"), or -1 if there is none.
+ *
+ * @param   name            prefetcher name
+ *
+ * @return  success         prefetcher
+ * @return  failure         -1
+ */
+
+int parsePrefetcher(const char *name);
+
+/* prefetcherName
+ *
+ * @param   kind            prefetcher
+ *
+ * @return  its name
+ */
+
+const char *prefetcherName(int kind);
+
+/* createPrefetcher
+ *
+ * Creates a prefetcher with no history. Returns NULL (after printing an
+ * error) on failure.
+ *
+ * @param   kind            PREFETCH_NEXT_LINE, PREFETCH_STRIDE, or PREFETCH_STREAM
+ * @param   degree          blocks prefetched ahead (1 - MAX_PREFETCH_DEGREE)
+ *
+ * @return  success         new Prefetcher
+ * @return  failure         NULL
+ */
+
+Prefetcher createPrefetcher(int kind, int degree);
+
+/* prefetcherKind
+ *
+ * @param   prefetcher      target prefetcher
+ *
+ * @return  its kind
+ */
+
+int prefetcherKind(Prefetcher prefetcher);
+
+/* prefetcherDegree
+ *
+ * @param   prefetcher      target prefetcher
+ *
+ * @return  its degree
+ */
+
+int prefetcherDegree(Prefetcher prefetcher);
+
+/* prefetchTrain
+ *
+ * Trains the prefetcher on one demand access and returns the blocks to
+ * prefetch. A stream prefetcher expects its buffer to have been flushed
+ * before a PREFETCH_ON_MISS.
+ *
+ * @param   prefetcher      target prefetcher
+ * @param   block           block number of the access
+ * @param   event           PREFETCH_ON_HIT, PREFETCH_ON_MISS, or
+ *                          PREFETCH_ON_USE (first use of a prefetched block)
+ * @param   candidates      output: up to MAX_PREFETCH_DEGREE block numbers
+ *
+ * @return  # of candidates
+ */
+
+int prefetchTrain(Prefetcher prefetcher, uint64_t block, int event, uint64_t *candidates);
+
+/* streamBufferTake
+ *
+ * Looks for a block in the stream buffer. If it is there, it is removed
+ * along with every older block, which the stream skipped.
+ *
+ * @param   prefetcher      target prefetcher
+ * @param   block           block number
+ * @param   arrival         output: cycle at which the block arrives
+ * @param   skipped         output: # of older blocks removed unused
+ *
+ * @return  found           1
+ * @return  not found       0
+ */
+
+int streamBufferTake(Prefetcher prefetcher, uint64_t block, long long *arrival, int *skipped);
+
+/* streamBufferPut
+ *
+ * Adds a prefetched block at the tail of the stream buffer. When the
+ * buffer is full its oldest block is dropped.
+ *
+ * @param   prefetcher      target prefetcher
+ * @param   block           block number
+ * @param   arrival         cycle at which the block arrives
+ *
+ * @return  dropped         1 if a block was dropped unused
+ * @return  otherwise       0
+ */
+
+int streamBufferPut(Prefetcher prefetcher, uint64_t block, long long arrival);
+
+/* streamBufferHas
+ *
+ * @param   prefetcher      target prefetcher
+ * @param   block           block number
+ *
+ * @return  1 if the block is in the stream buffer, else 0
+ */
+
+int streamBufferHas(Prefetcher prefetcher, uint64_t block);
+
+/* streamBufferFlush
+ *
+ * Empties the stream buffer.
+ *
+ * @param   prefetcher      target prefetcher
+ *
+ * @return  # of blocks removed unused
+ */
+
+int streamBufferFlush(Prefetcher prefetcher);
+
+/* notePollution
+ *
+ * Remembers that a prefetch evicted a block from the cache.
+ *
+ * @param   prefetcher      target prefetcher
+ * @param   block           block number of the evicted block
+ *
+ * @return  void
+ */
+
+void notePollution(Prefetcher prefetcher, uint64_t block);
+
+/* checkPollution
+ *
+ * Checks whether a demand miss is on a block a prefetch evicted, and
+ * forgets the block if so.
+ *
+ * @param   prefetcher      target prefetcher
+ * @param   block           block number of the miss
+ *
+ * @return  1 if a prefetch evicted the block, else 0
+ */
+
+int checkPollution(Prefetcher prefetcher, uint64_t block);
+
+/* destroyPrefetcher
+ *
+ * Frees the prefetcher. Passing NULL does nothing.
+ *
+ * @param   prefetcher      prefetcher to destroy
+ *
+ * @return  void
+ */
+
+void destroyPrefetcher(Prefetcher prefetcher);
+
+#endif
+/* PREFETCH_H */
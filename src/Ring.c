@@ -0,0 +1,253 @@
+/* File: Ring.c
+ *
+ * Batch handoff between threads. See Ring.h for the interface.
+ *
+ * 'published' counts the batches the producer has made visible, and
+ * each consumer's 'consumed' counts the batches it has released, which
+ * is also the # of its next batch. A sleeper first bumps its side's
+ * waiting count and then checks the counters again under the lock; the
+ * other side first bumps its counter and then checks the waiting count.
+ * Both are sequentially consistent, so at least one of them sees the
+ * other and no wakeup is lost.
+ *
+ */
+
+/********************************
+ *     1. Includes              *
+ *******************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "Ring.h"
+
+/********************************
+ *     2. Structs               *
+ ********************************/
+
+/* Cursor
+ *
+ * One consumer's counter, on its own line.
+ */
+
+struct Cursor_ {
+    _Alignas(64) atomic_long consumed;
+};
+
+/* Ring
+ *
+ * @param   published               # of batches made visible to the consumers
+ * @param   finished                set once the last batch has been published
+ * @param   cancelled               set once the consumers want no more batches
+ * @param   consumers_waiting       # of consumers asleep on 'ready'
+ * @param   producer_waiting        the producer is asleep on 'freed'
+ * @param   lock                    guards the sleeps
+ * @param   ready                   signalled when a batch is published or the ring finishes
+ * @param   freed                   signalled when a slot is released or the ring is cancelled
+ * @param   slots                   # of batches in flight
+ * @param   consumers               # of consumers
+ * @param   cursors                 per-consumer counters
+ */
+
+struct Ring_ {
+    _Alignas(64) atomic_long published;
+    atomic_bool finished;
+    atomic_bool cancelled;
+    _Alignas(64) atomic_int consumers_waiting;
+    atomic_int producer_waiting;
+    pthread_mutex_t lock;
+    pthread_cond_t ready;
+    pthread_cond_t freed;
+    int slots;
+    int consumers;
+    struct Cursor_* cursors;
+};
+
+/********************************
+ *     3. Utility Functions     *
+ ********************************/
+
+/* slotFree
+ *
+ * Returns whether every consumer has released the slot of batch 'next'.
+ */
+
+static bool slotFree(Ring ring, long next) {
+
+    int c;
+
+    for(c = 0; c < ring->consumers; c++) {
+        if(next - atomic_load(&ring->cursors[c].consumed) >= ring->slots) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* batchReady
+ *
+ * Returns whether batch 'next' is published or none ever will be.
+ */
+
+static bool batchReady(Ring ring, long next) {
+    return next < atomic_load(&ring->published) || atomic_load(&ring->finished);
+}
+
+/* wake
+ *
+ * Wakes whoever sleeps on 'cond', if anyone does.
+ */
+
+static void wake(Ring ring, atomic_int *waiting, pthread_cond_t *cond) {
+
+    if(atomic_load(waiting) > 0) {
+        pthread_mutex_lock(&ring->lock);
+        pthread_cond_broadcast(cond);
+        pthread_mutex_unlock(&ring->lock);
+    }
+}
+
+/********************************
+ *     4. Interface             *
+ ********************************/
+
+Ring createRing(int slots, int consumers) {
+
+    Ring ring;
+    int c;
+
+    ring = (Ring) aligned_alloc(64, (sizeof(struct Ring_) + 63) & ~((size_t) 63));
+
+    if(ring != NULL) {
+        ring->cursors = (struct Cursor_*) aligned_alloc(64, sizeof(struct Cursor_) * consumers);
+    }
+
+    if(ring == NULL || ring->cursors == NULL) {
+        fprintf(stderr, "Error: could not allocate memory for ring.\n");
+        free(ring);
+        return NULL;
+    }
+
+    atomic_init(&ring->published, 0);
+    atomic_init(&ring->finished, false);
+    atomic_init(&ring->cancelled, false);
+    atomic_init(&ring->consumers_waiting, 0);
+    atomic_init(&ring->producer_waiting, 0);
+    pthread_mutex_init(&ring->lock, NULL);
+    pthread_cond_init(&ring->ready, NULL);
+    pthread_cond_init(&ring->freed, NULL);
+    ring->slots = slots;
+    ring->consumers = consumers;
+
+    for(c = 0; c < consumers; c++) {
+        atomic_init(&ring->cursors[c].consumed, 0);
+    }
+
+    return ring;
+}
+
+int ringClaim(Ring ring) {
+
+    long next = atomic_load_explicit(&ring->published, memory_order_relaxed);
+    int spins;
+
+    for(spins = 0; spins < RING_SPINS; spins++) {
+        if(atomic_load_explicit(&ring->cancelled, memory_order_relaxed) || slotFree(ring, next)) {
+            break;
+        }
+    }
+
+    if(spins == RING_SPINS) {
+
+        pthread_mutex_lock(&ring->lock);
+        atomic_fetch_add(&ring->producer_waiting, 1);
+
+        while(!atomic_load(&ring->cancelled) && !slotFree(ring, next)) {
+            pthread_cond_wait(&ring->freed, &ring->lock);
+        }
+
+        atomic_fetch_sub(&ring->producer_waiting, 1);
+        pthread_mutex_unlock(&ring->lock);
+    }
+
+    if(atomic_load_explicit(&ring->cancelled, memory_order_relaxed)) {
+        return -1;
+    }
+
+    return (int) (next % ring->slots);
+}
+
+void ringPublish(Ring ring) {
+
+    atomic_fetch_add(&ring->published, 1);
+    wake(ring, &ring->consumers_waiting, &ring->ready);
+}
+
+void ringFinish(Ring ring) {
+
+    atomic_store(&ring->finished, true);
+    pthread_mutex_lock(&ring->lock);
+    pthread_cond_broadcast(&ring->ready);
+    pthread_mutex_unlock(&ring->lock);
+}
+
+int ringConsume(Ring ring, int consumer) {
+
+    long next = atomic_load_explicit(&ring->cursors[consumer].consumed, memory_order_relaxed);
+    int spins;
+
+    for(spins = 0; spins < RING_SPINS; spins++) {
+        if(batchReady(ring, next)) {
+            break;
+        }
+    }
+
+    if(spins == RING_SPINS) {
+
+        pthread_mutex_lock(&ring->lock);
+        atomic_fetch_add(&ring->consumers_waiting, 1);
+
+        while(!batchReady(ring, next)) {
+            pthread_cond_wait(&ring->ready, &ring->lock);
+        }
+
+        atomic_fetch_sub(&ring->consumers_waiting, 1);
+        pthread_mutex_unlock(&ring->lock);
+    }
+
+    /* finished: anything published before it still comes first */
+
+    if(next >= atomic_load_explicit(&ring->published, memory_order_acquire)) {
+        return -1;
+    }
+
+    return (int) (next % ring->slots);
+}
+
+void ringRelease(Ring ring, int consumer) {
+
+    atomic_fetch_add(&ring->cursors[consumer].consumed, 1);
+    wake(ring, &ring->producer_waiting, &ring->freed);
+}
+
+void ringCancel(Ring ring) {
+
+    atomic_store(&ring->cancelled, true);
+    pthread_mutex_lock(&ring->lock);
+    pthread_cond_broadcast(&ring->freed);
+    pthread_mutex_unlock(&ring->lock);
+}
+
+void destroyRing(Ring ring) {
+
+    if(ring != NULL) {
+        pthread_mutex_destroy(&ring->lock);
+        pthread_cond_destroy(&ring->ready);
+        pthread_cond_destroy(&ring->freed);
+        free(ring->cursors);
+        free(ring);
+    }
+}
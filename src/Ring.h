@@ -0,0 +1,133 @@
+/* File: Ring.h
+ *
+ * Batch handoff between threads: one producer, one or more consumers.
+ *
+ * A ring tracks which of its slots are in use; the batches themselves
+ * live in the caller's array, one per slot. Batch n goes in slot
+ * n % slots. The producer claims the slot of its next batch, fills it,
+ * and publishes it. Every consumer takes each published batch in order
+ * and releases it once done with it. A slot is claimed again only after
+ * every consumer has released it.
+ *
+ * Handing over a batch costs one atomic counter on each side; the
+ * counters sit on their own cache lines so the threads do not
+ * false-share them. A thread that finds nothing to do spins for
+ * RING_SPINS checks and then sleeps on a condition variable, so an idle
+ * consumer (a worker with no work, or a writer behind a slow trace)
+ * does not burn a core. The other side only takes the lock when it sees
+ * a sleeper.
+ *
+ */
+
+#ifndef RING_H
+#define RING_H
+
+/* Checks of the counters before a thread goes to sleep */
+#define RING_SPINS 1024
+
+/* Typedefs */
+typedef struct Ring_* Ring;
+
+/* createRing
+ *
+ * Returns NULL on failure.
+ *
+ * @param   slots           # of batches in flight
+ * @param   consumers       # of consumers that take every batch
+ *
+ * @return  success         new Ring
+ * @return  failure         NULL
+ */
+
+Ring createRing(int slots, int consumers);
+
+/* ringClaim
+ *
+ * Producer side: waits until every consumer has released the slot of
+ * the next batch. Returns the slot, or -1 once the ring is cancelled.
+ *
+ * @param   ring            target ring
+ *
+ * @return  success         slot to fill (0 - slots - 1)
+ * @return  cancelled       -1
+ */
+
+int ringClaim(Ring ring);
+
+/* ringPublish
+ *
+ * Producer side: makes the claimed batch visible to the consumers.
+ *
+ * @param   ring            target ring
+ *
+ * @return  void
+ */
+
+void ringPublish(Ring ring);
+
+/* ringFinish
+ *
+ * Producer side: marks the last batch as published, so consumers that
+ * have taken every batch stop waiting.
+ *
+ * @param   ring            target ring
+ *
+ * @return  void
+ */
+
+void ringFinish(Ring ring);
+
+/* ringConsume
+ *
+ * Consumer side: waits for the consumer's next batch. Returns its slot,
+ * or -1 once the producer has finished and every batch has been taken.
+ * The slot stays the consumer's until ringRelease.
+ *
+ * @param   ring            target ring
+ * @param   consumer        consumer index (0 - consumers - 1)
+ *
+ * @return  success         slot to read (0 - slots - 1)
+ * @return  finished        -1
+ */
+
+int ringConsume(Ring ring, int consumer);
+
+/* ringRelease
+ *
+ * Consumer side: hands the slot of the batch taken last back to the
+ * producer.
+ *
+ * @param   ring            target ring
+ * @param   consumer        consumer index (0 - consumers - 1)
+ *
+ * @return  void
+ */
+
+void ringRelease(Ring ring, int consumer);
+
+/* ringCancel
+ *
+ * Consumer side: tells the producer no more batches are wanted. Its
+ * next or current ringClaim returns -1.
+ *
+ * @param   ring            target ring
+ *
+ * @return  void
+ */
+
+void ringCancel(Ring ring);
+
+/* destroyRing
+ *
+ * Frees the ring. Every thread must be done with it. Passing NULL does
+ * nothing.
+ *
+ * @param   ring            ring to destroy
+ *
+ * @return  void
+ */
+
+void destroyRing(Ring ring);
+
+#endif
+/* RING_H */
@@ -0,0 +1,87 @@
+/* File: Sample.c
+ *
+ * Statistical set sampling. See Sample.h for the estimator.
+ *
+ * The estimate is computed once, at the end of the run, from the
+ * per-set counters (Heatmap.h) of the sampled sets.
+ *
+ */
+
+/********************************
+ *     1. Includes              *
+ *******************************/
+
+#include <stdio.h>
+#include <math.h>
+#include "Sample.h"
+
+/********************************
+ *     2. Interface             *
+ ********************************/
+
+int initSetSample(SetSample *sample, int number_of_sets, int ratio) {
+
+    if(ratio < 2 || ratio > number_of_sets / 2) {
+        fprintf(stderr, "Error: set sampling needs 1 in 2 - %d of the %d sets.\n", number_of_sets / 2, number_of_sets);
+        return -1;
+    }
+
+    sample->ratio = ratio;
+    sample->sets = (unsigned int) (number_of_sets / ratio);
+    sample->mask = (unsigned int) number_of_sets - 1;
+    sample->shift = (__builtin_ctz((unsigned int) number_of_sets) + 1) / 2;
+
+    return 0;
+}
+
+void printSetSample(const SetSample *sample, const SetCounters *counters, long long accesses, long long stream_ins, long long stream_outs, long long cycles) {
+
+    unsigned int number_of_sets = sample->mask + 1;
+    double ratio, residual, variance, error, scale;
+    uint64_t total = 0, misses = 0;
+    unsigned int i;
+
+    for(i = 0; i < number_of_sets; i++) {
+        if(setSampled(sample, i)) {
+            total += counters[i].accesses;
+            misses += counters[i].misses;
+        }
+    }
+
+    printf("\tSampled sets: %u of %u (1 in %d)\n", sample->sets, number_of_sets, sample->ratio);
+    printf("\tSimulated accesses: %llu of %lld (%2.2f%%)\n", (unsigned long long) total, accesses,
+           accesses ? ((double) total / (double) accesses) * 100 : 0.0);
+
+    if(total == 0) {
+        printf("\tNo access reached a sampled set.\n\n");
+        return;
+    }
+
+    /* ratio estimator over the sampled sets, each one a cluster */
+
+    ratio = (double) misses / (double) total;
+    variance = 0;
+
+    for(i = 0; i < number_of_sets; i++) {
+        if(setSampled(sample, i)) {
+            residual = (double) counters[i].misses - ratio * (double) counters[i].accesses;
+            variance += residual * residual;
+        }
+    }
+
+    variance /= (double) (sample->sets - 1);
+    error = sqrt((1.0 - (double) sample->sets / (double) number_of_sets) * variance / (double) sample->sets)
+            / ((double) total / (double) sample->sets);
+    error *= SAMPLE_Z;
+
+    /* the rest scales with the share of the accesses simulated */
+
+    scale = (double) accesses / (double) total;
+
+    printf("\tEstimated miss ratio: %2.2f%% +/- %2.2f%% (95%% confidence)\n", ratio * 100, error * 100);
+    printf("\tEstimated hit ratio: %2.2f%% +/- %2.2f%%\n", (1 - ratio) * 100, error * 100);
+    printf("\tEstimated misses: %.0f +/- %.0f\n", ratio * (double) accesses, error * (double) accesses);
+    printf("\tEstimated stream-in operations: %.0f\n", (double) stream_ins * scale);
+    printf("\tEstimated stream-out operations: %.0f\n", (double) stream_outs * scale);
+    printf("\tEstimated cycles with cache: %.0f\n\n", (double) cycles * scale);
+}
@@ -0,0 +1,106 @@
+/* File: Sample.h
+ *
+ * Statistical set sampling.
+ *
+ * A sampled cache only simulates 1 in 'ratio' of its sets. Which sets
+ * is fixed by a hash of the set index: the index is put through a
+ * bijective mix of its own bits (multiplies by odd constants and
+ * xor-shifts, all modulo the # of sets), and a set is sampled when the
+ * result falls below number_of_sets / ratio. The sampled sets are thus
+ * spread over the whole index range, strided traces do not line up with
+ * them, and their count is exact. An access to any other set is dropped
+ * right after its index is decoded, before the tag store is touched.
+ *
+ * Each sampled set is one cluster of accesses, so the miss ratio of
+ * the full run is estimated with the ratio estimator over the clusters,
+ * R = (sum of misses) / (sum of accesses), and its standard error
+ *
+ *      SE(R) = sqrt((1 - n / N) * s^2 / n) / (mean accesses per set)
+ *
+ *      s^2   = sum over the sampled sets of (misses - R * accesses)^2
+ *              / (n - 1)
+ *
+ * for n of N sets sampled. The interval R +/- SAMPLE_Z * SE(R) covers
+ * the full run's miss ratio with about 95% confidence as long as the
+ * sets behave alike, which holds for most traces but not for one that
+ * hammers a handful of sets (see -heatmap).
+ *
+ */
+
+#ifndef SAMPLE_H
+#define SAMPLE_H
+
+#include <stdint.h>
+#include "Heatmap.h"
+
+/* Normal quantile of the reported confidence interval (95%) */
+#define SAMPLE_Z 1.96
+
+/* SetSample
+ *
+ * @param   ratio           1 in 'ratio' sets is simulated
+ * @param   sets            # of sets simulated
+ * @param   mask            # of sets in the cache - 1
+ * @param   shift           xor-shift of the hash: half the index bits
+ */
+
+typedef struct {
+    int ratio;
+    unsigned int sets;
+    unsigned int mask;
+    int shift;
+} SetSample;
+
+/* initSetSample
+ *
+ * Picks 1 in 'ratio' of 'number_of_sets' sets. At least two sets must
+ * be sampled for the confidence interval. Returns 0 on success and -1
+ * on a bad ratio.
+ *
+ * @param   sample          output: the sample
+ * @param   number_of_sets  # of sets (power of two)
+ * @param   ratio           sample 1 in 'ratio' sets (2 - number_of_sets / 2)
+ *
+ * @return  success         0
+ * @return  failure         -1
+ */
+
+int initSetSample(SetSample *sample, int number_of_sets, int ratio);
+
+/* setSampled
+ *
+ * Returns whether the set with the given index is simulated.
+ */
+
+static inline int setSampled(const SetSample *sample, unsigned int index) {
+
+    uint64_t x = index;
+
+    x = (x * 0x9e3779b97f4a7c15ull) & sample->mask;
+    x ^= x >> sample->shift;
+    x = (x * 0xbf58476d1ce4e5b9ull) & sample->mask;
+    x ^= x >> sample->shift;
+
+    return x < sample->sets;
+}
+
+/* printSetSample
+ *
+ * Prints the sampled share of the sets and the accesses, and the miss
+ * ratio, misses, stream-ins, stream-outs, and cycles estimated for the
+ * full run.
+ *
+ * @param   sample          the sample
+ * @param   counters        counters of every set (only sampled ones count)
+ * @param   accesses        # of accesses in the trace, skipped ones included
+ * @param   stream_ins      # of stream-ins of the sampled sets
+ * @param   stream_outs     # of stream-outs of the sampled sets
+ * @param   cycles          # of cycles of the sampled sets
+ *
+ * @return  void
+ */
+
+void printSetSample(const SetSample *sample, const SetCounters *counters, long long accesses, long long stream_ins, long long stream_outs, long long cycles);
+
+#endif
+/* SAMPLE_H */
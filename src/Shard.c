@@ -0,0 +1,267 @@
+/* File: Shard.c
+ *
+ * Set-sharded parallel simulation of a single cache. See Shard.h for
+ * the interface.
+ *
+ * Worker w owns sets [w * sets / threads, (w + 1) * sets / threads).
+ * Each worker has its own ring (Ring.h) with the main thread as its
+ * producer and the worker as its one consumer.
+ *
+ */
+
+/********************************
+ *     1. Includes              *
+ *******************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "Shard.h"
+#include "Ring.h"
+
+/********************************
+ *     2. Structs               *
+ ********************************/
+
+/* Batch
+ *
+ * A run of decoded accesses to one worker's sets, with their positions
+ * in the trace.
+ */
+
+struct Batch_ {
+    int count;
+    uint64_t addresses[SHARD_BATCH];
+    long long clocks[SHARD_BATCH];
+    unsigned char writes[SHARD_BATCH];
+};
+
+/* Worker
+ *
+ * One simulation thread, its ring, and the cache shard it counts into.
+ *
+ * @param   batches         batches in flight, one per ring slot
+ * @param   ring            hands the batches to the worker
+ * @param   filling         batch currently being filled by the producer
+ * @param   view            shard of the cache with private counters
+ */
+
+struct Worker_ {
+    struct Batch_ batches[SHARD_RING];
+    Ring ring;
+    struct Batch_* filling;
+    pthread_t thread;
+    Cache view;
+};
+
+/* Shard
+ *
+ * @param   cache           cache being simulated
+ * @param   workers         worker threads
+ * @param   threads         # of worker threads
+ * @param   shift           log2(# of sets), to map a set to its worker
+ * @param   running         workers have been started and not yet joined
+ */
+
+struct Shard_ {
+    Cache cache;
+    struct Worker_* workers;
+    int threads;
+    int shift;
+    bool running;
+};
+
+/********************************
+ *     3. Worker Thread         *
+ ********************************/
+
+/* runWorker
+ *
+ * Replays every batch published on this worker's ring into its shard.
+ */
+
+static void *runWorker(void *arg) {
+
+    struct Worker_* worker = (struct Worker_*) arg;
+    struct Batch_* batch;
+    int slot, k;
+
+    while((slot = ringConsume(worker->ring, 0)) >= 0) {
+
+        batch = &worker->batches[slot];
+
+        for(k = 0; k < batch->count; k++) {
+            accessCacheAt(worker->view, batch->addresses[k], batch->writes[k], batch->clocks[k]);
+        }
+
+        ringRelease(worker->ring, 0);
+    }
+
+    return NULL;
+}
+
+/********************************
+ *     4. Producer Side         *
+ ********************************/
+
+/* publishBatch
+ *
+ * Makes the batch being filled visible to its worker.
+ */
+
+static void publishBatch(struct Worker_* worker) {
+
+    ringPublish(worker->ring);
+    worker->filling = NULL;
+}
+
+Shard createShard(Cache cache, int threads) {
+
+    Shard shard;
+    int sets, w, c;
+
+    if(cache == NULL) {
+        fprintf(stderr, "Error: Must supply a valid cache to shard!\n");
+        return NULL;
+    }
+
+    sets = getNumberOfSets(cache);
+
+    if(threads > sets) threads = sets;
+    if(threads < 1) threads = 1;
+
+    shard = (Shard) malloc(sizeof(struct Shard_));
+
+    if(shard == NULL) {
+        fprintf(stderr, "Error: could not allocate memory for shard.\n");
+        return NULL;
+    }
+
+    shard->workers = (struct Worker_*) malloc(sizeof(struct Worker_) * threads);
+
+    if(shard->workers == NULL) {
+        fprintf(stderr, "Error: could not allocate memory for shard.\n");
+        free(shard);
+        return NULL;
+    }
+
+    shard->cache = cache;
+    shard->threads = threads;
+    shard->shift = __builtin_ctz(sets);
+    shard->running = true;
+
+    for(w = 0; w < threads; w++) {
+
+        struct Worker_* worker = &shard->workers[w];
+
+        worker->filling = NULL;
+        worker->ring = createRing(SHARD_RING, 1);
+        worker->view = (worker->ring != NULL) ? createCacheShard(cache) : NULL;
+
+        if(worker->view == NULL) {
+            destroyRing(worker->ring);
+            for(c = 0; c < w; c++) {
+                mergeCacheShard(cache, shard->workers[c].view);
+                destroyRing(shard->workers[c].ring);
+            }
+            free(shard->workers);
+            free(shard);
+            return NULL;
+        }
+    }
+
+    for(w = 0; w < threads; w++) {
+        if(pthread_create(&shard->workers[w].thread, NULL, runWorker, &shard->workers[w]) != 0) {
+
+            /* stop the workers that did start, then give up */
+
+            fprintf(stderr, "Error: could not start shard worker thread.\n");
+
+            for(c = w; c < threads; c++) {
+                mergeCacheShard(cache, shard->workers[c].view);
+                destroyRing(shard->workers[c].ring);
+            }
+
+            shard->threads = w;
+            destroyShard(shard);
+            return NULL;
+        }
+    }
+
+    return shard;
+}
+
+void shardAccess(Shard shard, uint64_t address, int write, long long clock) {
+
+    struct Worker_* worker;
+    struct Batch_* batch;
+    unsigned long long index = getSetIndex(shard->cache, address);
+
+    worker = &shard->workers[(index * shard->threads) >> shard->shift];
+
+    /* wait until the worker has replayed the slot's last batch */
+
+    if(worker->filling == NULL) {
+        worker->filling = &worker->batches[ringClaim(worker->ring)];
+        worker->filling->count = 0;
+    }
+
+    batch = worker->filling;
+    batch->addresses[batch->count] = address;
+    batch->clocks[batch->count] = clock;
+    batch->writes[batch->count] = (unsigned char) write;
+    batch->count++;
+
+    if(batch->count == SHARD_BATCH) {
+        publishBatch(worker);
+    }
+}
+
+void finishShard(Shard shard) {
+
+    int w;
+
+    if(shard == NULL || !shard->running) {
+        return;
+    }
+
+    for(w = 0; w < shard->threads; w++) {
+
+        if(shard->workers[w].filling != NULL && shard->workers[w].filling->count > 0) {
+            publishBatch(&shard->workers[w]);
+        }
+
+        ringFinish(shard->workers[w].ring);
+    }
+
+    for(w = 0; w < shard->threads; w++) {
+        pthread_join(shard->workers[w].thread, NULL);
+    }
+
+    /* the workers are gone: fold their counters into the cache */
+
+    for(w = 0; w < shard->threads; w++) {
+        mergeCacheShard(shard->cache, shard->workers[w].view);
+        shard->workers[w].view = NULL;
+    }
+
+    shard->running = false;
+}
+
+void destroyShard(Shard shard) {
+
+    int w;
+
+    if(shard != NULL) {
+
+        finishShard(shard);
+
+        for(w = 0; w < shard->threads; w++) {
+            destroyRing(shard->workers[w].ring);
+        }
+
+        free(shard->workers);
+        free(shard);
+    }
+}
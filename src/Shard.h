@@ -0,0 +1,87 @@
+/* File: Shard.h
+ *
+ * Set-sharded parallel simulation of a single cache.
+ *
+ * Sets never interact: lookup, LRU replacement, and dirty state are all
+ * local to one set. The sets are therefore split into contiguous ranges,
+ * one per worker thread. The main thread decodes the trace and routes
+ * each access to the worker that owns its set through that worker's own
+ * ring of batches (Ring.h). Each worker counts into a private shard of
+ * the cache (see createCacheShard), and the counters are merged into
+ * the cache once the trace is done.
+ *
+ * Every access carries its position in the trace, which the worker uses
+ * as the access clock. Only policies whose state is local to a set are
+ * accepted (see policyIsSetLocal), so both the statistics and the final
+ * tag store are identical to a sequential run.
+ *
+ */
+
+#ifndef SHARD_H
+#define SHARD_H
+
+#include "CacheSim.h"
+
+/* Accesses per batch and batches in flight per worker */
+#define SHARD_BATCH 1024
+#define SHARD_RING 8
+
+/* Typedefs */
+typedef struct Shard_* Shard;
+
+/* createShard
+ *
+ * Starts 'threads' workers, each owning an equal range of the cache's
+ * sets. The cache remains owned by the caller and must not be used
+ * until finishShard returns. Returns NULL on failure.
+ *
+ * @param   cache           cache to simulate
+ * @param   threads         # of worker threads (clamped to 1 - # of sets)
+ *
+ * @return  success         new Shard
+ * @return  failure         NULL
+ */
+
+Shard createShard(Cache cache, int threads);
+
+/* shardAccess
+ *
+ * Queues one decoded access for the worker that owns its set. Blocks
+ * only when that worker still has SHARD_RING batches to consume.
+ *
+ * @param   shard           target shard
+ * @param   address         decoded memory address
+ * @param   write           0 = read, 1 = write
+ * @param   clock           1-based position of this access in the trace
+ *
+ * @return  void
+ */
+
+void shardAccess(Shard shard, uint64_t address, int write, long long clock);
+
+/* finishShard
+ *
+ * Publishes every partial batch, waits for the workers to drain their
+ * rings, joins the threads, and merges their counters into the cache.
+ *
+ * @param   shard           target shard
+ *
+ * @return  void
+ */
+
+void finishShard(Shard shard);
+
+/* destroyShard
+ *
+ * Frees the shard (finishing it first if needed). Does not destroy the
+ * cache. Passing NULL does nothing.
+ *
+ * @param   shard           shard to destroy
+ *
+ * @return  void
+ */
+
+void destroyShard(Shard shard);
+
+#endif
+/* SHARD_H */
@@ -0,0 +1,465 @@
+/* File: StackDist.c
+ *
+ * Stack-distance (Mattson) miss ratio curves for LRU caches. See
+ * StackDist.h for the interface.
+ *
+ * A single hash map gives every distinct block a dense id, and a table
+ * indexed by id holds, for each set count, the position of that block's
+ * most recent access in its set's timeline. Each set has one Fenwick
+ * tree holding a 1 at every such position. The stack distance of an
+ * access is the number of markers after the block's previous position.
+ * When a set's timeline fills up it is compacted (and doubled if more
+ * than half full), so memory stays proportional to the number of
+ * distinct blocks rather than accesses.
+ *
+ */
+
+/********************************
+ *     1. Includes              *
+ *******************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "StackDist.h"
+
+/********************************
+ *     2. Structs               *
+ ********************************/
+
+/* SetStack
+ *
+ * LRU stack of one set. tree is a Fenwick tree over positions
+ * 1 .. capacity, and ids[p] is the block whose most recent access
+ * is at position p (only meaningful where the tree has a marker).
+ *
+ * @param   tree            Fenwick tree of markers
+ * @param   ids             block id at each marked position
+ * @param   marked          1 where a position holds a marker
+ * @param   capacity        # of positions
+ * @param   now             last position used
+ * @param   live            # of markers (distinct blocks seen)
+ */
+
+struct SetStack_ {
+    int* tree;
+    int* ids;
+    unsigned char* marked;
+    int capacity;
+    int now;
+    int live;
+};
+
+/* Level
+ *
+ * Analysis for one set count.
+ *
+ * @param   index_mask      number of sets - 1
+ * @param   stacks          one LRU stack per set
+ * @param   histogram       # of accesses at each stack distance < max_ways
+ * @param   far             # of accesses at stack distance >= max_ways
+ * @param   cold            # of first accesses to a block
+ */
+
+struct Level_ {
+    unsigned int index_mask;
+    struct SetStack_* stacks;
+    long long* histogram;
+    long long far;
+    long long cold;
+};
+
+/* StackDist
+ *
+ * @param   levels          one Level per set count 1, 2, 4, ...
+ * @param   level_count     # of levels
+ * @param   max_ways        largest associativity reported
+ * @param   block_size      block size in bytes
+ * @param   bitsOffset      # of byte select bits
+ * @param   address_mask    mask of the address_size low bits
+ * @param   accesses        # of accesses recorded
+ * @param   map_keys        hash map: block number
+ * @param   map_ids         hash map: block id + 1 (0 = empty slot)
+ * @param   map_bits        log2 of the hash map capacity
+ * @param   blocks          # of distinct blocks (ids handed out)
+ * @param   positions       last position of block id in level l at [id * level_count + l]
+ * @param   positions_size  # of ids the positions table can hold
+ */
+
+struct StackDist_ {
+    struct Level_* levels;
+    int level_count;
+    int max_ways;
+    int block_size;
+    int bitsOffset;
+    uint64_t address_mask;
+    long long accesses;
+    uint64_t* map_keys;
+    int* map_ids;
+    int map_bits;
+    int blocks;
+    int* positions;
+    int positions_size;
+};
+
+#define INITIAL_CAPACITY 16
+#define INITIAL_MAP_BITS 10
+
+/********************************
+ *     3. Fenwick Tree          *
+ ********************************/
+
+static inline void fenwickAdd(int *tree, int capacity, int i, int delta) {
+
+    for(; i <= capacity; i += i & -i) {
+        tree[i] += delta;
+    }
+}
+
+static inline int fenwickPrefix(const int *tree, int i) {
+
+    int sum = 0;
+
+    for(; i > 0; i -= i & -i) {
+        sum += tree[i];
+    }
+
+    return sum;
+}
+
+/********************************
+ *     4. Block Hash Map        *
+ ********************************/
+
+/* mapSlot
+ *
+ * Returns the slot holding 'key', or the empty slot where it belongs.
+ */
+
+static inline unsigned int mapSlot(const struct StackDist_* sd, uint64_t key) {
+
+    unsigned int mask = (1u << sd->map_bits) - 1;
+    unsigned int slot = ((unsigned int) (key ^ (key >> 32)) * 2654435761u) >> (32 - sd->map_bits);
+
+    while(sd->map_ids[slot] != 0 && sd->map_keys[slot] != key) {
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+/* growMap
+ *
+ * Doubles the hash map and reinserts every block.
+ */
+
+static void growMap(struct StackDist_* sd) {
+
+    uint64_t *old_keys = sd->map_keys;
+    int *old_ids = sd->map_ids;
+    unsigned int old_size = 1u << sd->map_bits;
+    unsigned int i, slot;
+
+    sd->map_bits++;
+    sd->map_keys = (uint64_t*) malloc(sizeof(uint64_t) << sd->map_bits);
+    sd->map_ids = (int*) calloc((size_t) 1 << sd->map_bits, sizeof(int));
+    assert(sd->map_keys != NULL && sd->map_ids != NULL);
+
+    for(i = 0; i < old_size; i++) {
+        if(old_ids[i] != 0) {
+            slot = mapSlot(sd, old_keys[i]);
+            sd->map_keys[slot] = old_keys[i];
+            sd->map_ids[slot] = old_ids[i];
+        }
+    }
+
+    free(old_keys);
+    free(old_ids);
+}
+
+/* lookupBlock
+ *
+ * Returns the dense id of a block, handing out a new one (with no
+ * previous position at any level) on first touch.
+ */
+
+static inline int lookupBlock(struct StackDist_* sd, uint64_t block) {
+
+    unsigned int slot = mapSlot(sd, block);
+
+    if(sd->map_ids[slot] != 0) {
+        return sd->map_ids[slot] - 1;
+    }
+
+    if(sd->blocks == sd->positions_size) {
+        sd->positions_size *= 2;
+        sd->positions = (int*) realloc(sd->positions, sizeof(int) * sd->positions_size * sd->level_count);
+        assert(sd->positions != NULL);
+    }
+
+    memset(&sd->positions[(size_t) sd->blocks * sd->level_count], 0, sizeof(int) * sd->level_count);
+
+    sd->map_keys[slot] = block;
+    sd->map_ids[slot] = ++sd->blocks;
+
+    if(sd->blocks * 2 > (1 << sd->map_bits)) {
+        growMap(sd);
+    }
+
+    return sd->blocks - 1;
+}
+
+/********************************
+ *     5. Set Stacks            *
+ ********************************/
+
+/* initStack
+ *
+ * Allocates an empty stack with 'capacity' positions.
+ */
+
+static void initStack(struct SetStack_* stack, int capacity) {
+
+    stack->tree = (int*) calloc(capacity + 1, sizeof(int));
+    stack->ids = (int*) malloc(sizeof(int) * (capacity + 1));
+    stack->marked = (unsigned char*) calloc(capacity + 1, 1);
+    assert(stack->tree != NULL && stack->ids != NULL && stack->marked != NULL);
+
+    stack->capacity = capacity;
+    stack->now = 0;
+}
+
+/* compactStack
+ *
+ * Renumbers the live markers of a full stack to positions 1 .. live,
+ * keeping their order, and doubles the capacity if it is more than
+ * half used. The Fenwick tree is rebuilt in linear time.
+ */
+
+static void compactStack(struct StackDist_* sd, int l, struct SetStack_* stack) {
+
+    struct SetStack_ fresh;
+    int capacity = stack->capacity;
+    int p, q, parent;
+
+    if(stack->live * 2 > capacity) {
+        capacity *= 2;
+    }
+
+    initStack(&fresh, capacity);
+
+    for(p = 1, q = 0; p <= stack->now; p++) {
+        if(stack->marked[p]) {
+            q++;
+            fresh.ids[q] = stack->ids[p];
+            fresh.marked[q] = 1;
+            fresh.tree[q] = 1;
+            sd->positions[(size_t) stack->ids[p] * sd->level_count + l] = q;
+        }
+    }
+
+    /* linear-time Fenwick build */
+
+    for(p = 1; p <= capacity; p++) {
+        parent = p + (p & -p);
+        if(parent <= capacity) {
+            fresh.tree[parent] += fresh.tree[p];
+        }
+    }
+
+    fresh.now = q;
+    fresh.live = stack->live;
+
+    free(stack->tree);
+    free(stack->ids);
+    free(stack->marked);
+    *stack = fresh;
+}
+
+/********************************
+ *     6. Interface             *
+ ********************************/
+
+StackDist createStackDist(int max_sets, int max_ways, int block_size, int address_size) {
+
+    StackDist sd;
+    struct Level_* level;
+    int l, s;
+
+    if(max_sets <= 0 || (max_sets & (max_sets - 1)) != 0) {
+        fprintf(stderr, "Error: Number of sets must be a power of two!\n");
+        return NULL;
+    }
+
+    if(block_size <= 0 || (block_size & (block_size - 1)) != 0) {
+        fprintf(stderr, "Error: Block size must be a power of two bytes!\n");
+        return NULL;
+    }
+
+    if(max_ways <= 0) {
+        fprintf(stderr, "Error: Associativity must be greater than 0 ways!\n");
+        return NULL;
+    }
+
+    sd = (StackDist) malloc(sizeof(struct StackDist_));
+
+    if(sd == NULL) {
+        fprintf(stderr, "Error: could not allocate memory for stack distance analysis.\n");
+        return NULL;
+    }
+
+    sd->level_count = __builtin_ctz(max_sets) + 1;
+    sd->max_ways = max_ways;
+    sd->block_size = block_size;
+    sd->bitsOffset = __builtin_ctz(block_size);
+    sd->address_mask = (address_size >= 64) ? ~0ull : (1ull << address_size) - 1;
+    sd->accesses = 0;
+
+    sd->levels = (struct Level_*) calloc(sd->level_count, sizeof(struct Level_));
+    assert(sd->levels != NULL);
+
+    for(l = 0; l < sd->level_count; l++) {
+
+        level = &sd->levels[l];
+        level->index_mask = (1u << l) - 1;
+
+        level->stacks = (struct SetStack_*) malloc(sizeof(struct SetStack_) << l);
+        assert(level->stacks != NULL);
+
+        for(s = 0; s < (1 << l); s++) {
+            initStack(&level->stacks[s], INITIAL_CAPACITY);
+            level->stacks[s].live = 0;
+        }
+
+        level->histogram = (long long*) calloc(max_ways, sizeof(long long));
+        assert(level->histogram != NULL);
+    }
+
+    sd->map_bits = INITIAL_MAP_BITS;
+    sd->map_keys = (uint64_t*) malloc(sizeof(uint64_t) << INITIAL_MAP_BITS);
+    sd->map_ids = (int*) calloc((size_t) 1 << INITIAL_MAP_BITS, sizeof(int));
+    sd->blocks = 0;
+    sd->positions_size = 1 << (INITIAL_MAP_BITS - 1);
+    sd->positions = (int*) malloc(sizeof(int) * sd->positions_size * sd->level_count);
+    assert(sd->map_keys != NULL && sd->map_ids != NULL && sd->positions != NULL);
+
+    return sd;
+}
+
+void stackDistAccess(StackDist sd, uint64_t address) {
+
+    uint64_t block = (address & sd->address_mask) >> sd->bitsOffset;
+    struct Level_* level;
+    struct SetStack_* stack;
+    int *position;
+    int l, id, p, distance;
+
+    sd->accesses++;
+    id = lookupBlock(sd, block);
+
+    for(l = 0; l < sd->level_count; l++) {
+
+        level = &sd->levels[l];
+        stack = &level->stacks[block & level->index_mask];
+
+        if(stack->now == stack->capacity) {
+            compactStack(sd, l, stack);
+        }
+
+        /* look the position up after compaction, which may move it */
+
+        position = &sd->positions[(size_t) id * sd->level_count + l];
+        p = *position;
+
+        /* Reuse: distance = # of distinct blocks touched since position p */
+
+        if(p != 0) {
+
+            distance = stack->live - fenwickPrefix(stack->tree, p);
+
+            if(distance < sd->max_ways) {
+                level->histogram[distance]++;
+            }
+            else {
+                level->far++;
+            }
+
+            fenwickAdd(stack->tree, stack->capacity, p, -1);
+            stack->marked[p] = 0;
+        }
+
+        /* First touch: compulsory miss at every associativity */
+
+        else {
+            level->cold++;
+            stack->live++;
+        }
+
+        /* Mark the block's new most recent access */
+
+        p = ++stack->now;
+        fenwickAdd(stack->tree, stack->capacity, p, 1);
+        stack->ids[p] = id;
+        stack->marked[p] = 1;
+        *position = p;
+    }
+}
+
+void printStackDist(StackDist sd) {
+
+    struct Level_* level;
+    long long hits;
+    int l, a;
+
+    printf("\nLRU miss ratio curves (%d byte blocks, %lld accesses):\n", sd->block_size, sd->accesses);
+
+    for(l = sd->level_count - 1; l >= 0; l--) {
+
+        level = &sd->levels[l];
+        hits = 0;
+
+        printf("\n\tSets: %d (%lld compulsory misses)\n\n", 1 << l, level->cold);
+        printf("\t\t%6s %12s %14s %14s %11s\n", "Ways", "Size", "Hits", "Misses", "Miss ratio");
+
+        for(a = 1; a <= sd->max_ways; a++) {
+
+            hits += level->histogram[a - 1];
+
+            printf("\t\t%6d %12lld %14lld %14lld %10.2f%%\n", a,
+                   (long long) (1 << l) * a * sd->block_size, hits, sd->accesses - hits,
+                   sd->accesses ? ((double) (sd->accesses - hits) / (double) sd->accesses) * 100 : 0.0);
+        }
+    }
+
+    printf("\n");
+}
+
+void destroyStackDist(StackDist sd) {
+
+    struct Level_* level;
+    int l, s;
+
+    if(sd != NULL) {
+
+        for(l = 0; l < sd->level_count; l++) {
+
+            level = &sd->levels[l];
+
+            for(s = 0; s < (1 << l); s++) {
+                free(level->stacks[s].tree);
+                free(level->stacks[s].ids);
+                free(level->stacks[s].marked);
+            }
+
+            free(level->stacks);
+            free(level->histogram);
+        }
+
+        free(sd->map_keys);
+        free(sd->map_ids);
+        free(sd->positions);
+        free(sd->levels);
+        free(sd);
+    }
+}
@@ -0,0 +1,79 @@
+/* File: StackDist.h
+ *
+ * Stack-distance (Mattson) miss ratio curves for LRU caches.
+ *
+ * One pass over the trace computes, for every access, how many distinct
+ * blocks mapping to the same set were touched since the last access to
+ * its block. An LRU cache with A ways hits exactly when that distance is
+ * less than A, so a single histogram gives the hits and misses of every
+ * associativity 1..K at once. The analysis is repeated for every power of
+ * two set count from 1 up to the configured number of sets.
+ *
+ * Each set keeps its LRU stack as a Fenwick tree over that set's access
+ * times with a marker at the most recent access of each block, so a
+ * distance is one prefix-sum query: O(log n) per access and set count.
+ *
+ */
+
+#ifndef STACKDIST_H
+#define STACKDIST_H
+
+#include <stdint.h>
+
+/* Typedefs */
+typedef struct StackDist_* StackDist;
+
+/* createStackDist
+ *
+ * Creates an analysis for set counts 1, 2, 4, ... max_sets and
+ * associativities 1 ... max_ways. Returns NULL on failure.
+ *
+ * @param   max_sets        largest set count (power of two)
+ * @param   max_ways        largest associativity reported
+ * @param   block_size      block size in bytes (power of two)
+ * @param   address_size    width of a memory address in bits
+ *
+ * @return  success         new StackDist
+ * @return  failure         NULL
+ */
+
+StackDist createStackDist(int max_sets, int max_ways, int block_size, int address_size);
+
+/* stackDistAccess
+ *
+ * Records one access. Reads and writes are treated alike, as they are
+ * by the LRU update in the cache.
+ *
+ * @param   sd              target analysis
+ * @param   address         decoded memory address
+ *
+ * @return  void
+ */
+
+void stackDistAccess(StackDist sd, uint64_t address);
+
+/* printStackDist
+ *
+ * Prints hits, misses, and the miss ratio for every set count and
+ * associativity.
+ *
+ * @param   sd              analysis to print
+ *
+ * @return  void
+ */
+
+void printStackDist(StackDist sd);
+
+/* destroyStackDist
+ *
+ * Frees all memory held by the analysis. Passing NULL does nothing.
+ *
+ * @param   sd              analysis to destroy
+ *
+ * @return  void
+ */
+
+void destroyStackDist(StackDist sd);
+
+#endif
+/* STACKDIST_H */
@@ -0,0 +1,255 @@
+/* File: Sweep.c
+ *
+ * Single-pass multi-configuration simulation. See Sweep.h for the
+ * interface.
+ *
+ * The main thread is the only producer on the ring (Ring.h) and every
+ * worker is one of its consumers, so a slot is refilled only after
+ * every worker has replayed the batch that was there before.
+ *
+ */
+
+/********************************
+ *     1. Includes              *
+ *******************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <pthread.h>
+#include "Sweep.h"
+#include "Ring.h"
+
+/********************************
+ *     2. Structs               *
+ ********************************/
+
+/* Batch
+ *
+ * A run of decoded accesses handed to the workers in one go.
+ */
+
+struct Batch_ {
+    int count;
+    uint64_t addresses[SWEEP_BATCH];
+    unsigned char writes[SWEEP_BATCH];
+};
+
+/* Worker
+ *
+ * One simulation thread, the caches it owns, and its consumer index
+ * on the ring.
+ */
+
+struct Worker_ {
+    pthread_t thread;
+    struct Sweep_* sweep;
+    Cache* caches;
+    int count;
+    int index;
+};
+
+/* Sweep
+ *
+ * @param   batches         batches in flight, one per ring slot
+ * @param   ring            hands the batches to the workers
+ * @param   workers         worker threads
+ * @param   threads         # of worker threads
+ * @param   filling         batch currently being filled by the producer
+ * @param   running         workers have been started and not yet joined
+ */
+
+struct Sweep_ {
+    struct Batch_ batches[SWEEP_RING];
+    Ring ring;
+    struct Worker_* workers;
+    int threads;
+    struct Batch_* filling;
+    bool running;
+};
+
+/********************************
+ *     3. Worker Thread         *
+ ********************************/
+
+/* runWorker
+ *
+ * Replays every published batch into each cache this worker owns.
+ * Iterating cache-major over a batch keeps one tag store hot at a time.
+ */
+
+static void *runWorker(void *arg) {
+
+    struct Worker_* worker = (struct Worker_*) arg;
+    struct Sweep_* sweep = worker->sweep;
+    struct Batch_* batch;
+    int slot, c, k;
+
+    while((slot = ringConsume(sweep->ring, worker->index)) >= 0) {
+
+        batch = &sweep->batches[slot];
+
+        for(c = 0; c < worker->count; c++) {
+            for(k = 0; k < batch->count; k++) {
+                accessCache(worker->caches[c], batch->addresses[k], batch->writes[k]);
+            }
+        }
+
+        ringRelease(sweep->ring, worker->index);
+    }
+
+    return NULL;
+}
+
+/********************************
+ *     4. Producer Side         *
+ ********************************/
+
+/* publishBatch
+ *
+ * Makes the batch being filled visible to the workers.
+ */
+
+static void publishBatch(Sweep sweep) {
+
+    ringPublish(sweep->ring);
+    sweep->filling = NULL;
+}
+
+Sweep createSweep(Cache *caches, int count, int threads) {
+
+    Sweep sweep;
+    int w, c;
+
+    if(caches == NULL || count <= 0) {
+        fprintf(stderr, "Error: Must supply at least one cache to sweep!\n");
+        return NULL;
+    }
+
+    if(threads > count) threads = count;
+    if(threads < 1) threads = 1;
+
+    sweep = (Sweep) malloc(sizeof(struct Sweep_));
+
+    if(sweep == NULL) {
+        fprintf(stderr, "Error: could not allocate memory for sweep.\n");
+        return NULL;
+    }
+
+    sweep->workers = (struct Worker_*) malloc(sizeof(struct Worker_) * threads);
+
+    if(sweep->workers == NULL) {
+        fprintf(stderr, "Error: could not allocate memory for sweep.\n");
+        free(sweep);
+        return NULL;
+    }
+
+    sweep->ring = createRing(SWEEP_RING, threads);
+
+    if(sweep->ring == NULL) {
+        free(sweep->workers);
+        free(sweep);
+        return NULL;
+    }
+
+    sweep->threads = threads;
+    sweep->filling = NULL;
+    sweep->running = true;
+
+    /* Deal the caches out round-robin */
+
+    for(w = 0; w < threads; w++) {
+
+        struct Worker_* worker = &sweep->workers[w];
+
+        worker->index = w;
+        worker->sweep = sweep;
+        worker->count = 0;
+        worker->caches = (Cache*) malloc(sizeof(Cache) * ((count + threads - 1) / threads));
+        assert(worker->caches != NULL);
+
+        for(c = w; c < count; c += threads) {
+            worker->caches[worker->count++] = caches[c];
+        }
+    }
+
+    for(w = 0; w < threads; w++) {
+        if(pthread_create(&sweep->workers[w].thread, NULL, runWorker, &sweep->workers[w]) != 0) {
+
+            /* stop the workers that did start, then give up */
+
+            fprintf(stderr, "Error: could not start sweep worker thread.\n");
+
+            for(c = w; c < threads; c++) {
+                free(sweep->workers[c].caches);
+            }
+
+            sweep->threads = w;
+            destroySweep(sweep);
+            return NULL;
+        }
+    }
+
+    return sweep;
+}
+
+void sweepAccess(Sweep sweep, uint64_t address, int write) {
+
+    struct Batch_* batch;
+
+    /* wait until every worker has replayed the slot's last batch */
+
+    if(sweep->filling == NULL) {
+        sweep->filling = &sweep->batches[ringClaim(sweep->ring)];
+        sweep->filling->count = 0;
+    }
+
+    batch = sweep->filling;
+    batch->addresses[batch->count] = address;
+    batch->writes[batch->count] = (unsigned char) write;
+    batch->count++;
+
+    if(batch->count == SWEEP_BATCH) {
+        publishBatch(sweep);
+    }
+}
+
+void finishSweep(Sweep sweep) {
+
+    int w;
+
+    if(sweep == NULL || !sweep->running) {
+        return;
+    }
+
+    if(sweep->filling != NULL && sweep->filling->count > 0) {
+        publishBatch(sweep);
+    }
+
+    ringFinish(sweep->ring);
+
+    for(w = 0; w < sweep->threads; w++) {
+        pthread_join(sweep->workers[w].thread, NULL);
+    }
+
+    sweep->running = false;
+}
+
+void destroySweep(Sweep sweep) {
+
+    int w;
+
+    if(sweep != NULL) {
+
+        finishSweep(sweep);
+
+        for(w = 0; w < sweep->threads; w++) {
+            free(sweep->workers[w].caches);
+        }
+
+        destroyRing(sweep->ring);
+        free(sweep->workers);
+        free(sweep);
+    }
+}
@@ -0,0 +1,81 @@
+/* File: Sweep.h
+ *
+ * Single-pass multi-configuration simulation.
+ *
+ * The trace is parsed once by the main thread, which packs decoded
+ * accesses into fixed-size batches and publishes them on a ring that
+ * every worker thread reads. Each worker owns a subset of the Cache
+ * objects and replays every batch into each of them. Every worker is a
+ * consumer of the ring (Ring.h), and a worker with nothing to replay
+ * sleeps until the next batch is published.
+ *
+ */
+
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include "CacheSim.h"
+
+/* Accesses per batch and batches in flight */
+#define SWEEP_BATCH 4096
+#define SWEEP_RING 8
+
+/* Typedefs */
+typedef struct Sweep_* Sweep;
+
+/* createSweep
+ *
+ * Starts 'threads' workers and spreads the caches across them
+ * round-robin. The caches remain owned by the caller. Returns NULL
+ * on failure.
+ *
+ * @param   caches          array of caches to simulate
+ * @param   count           # of caches
+ * @param   threads         # of worker threads (clamped to 1 - count)
+ *
+ * @return  success         new Sweep
+ * @return  failure         NULL
+ */
+
+Sweep createSweep(Cache *caches, int count, int threads);
+
+/* sweepAccess
+ *
+ * Queues one decoded access for every cache. Blocks only when all
+ * SWEEP_RING batches are still being consumed.
+ *
+ * @param   sweep           target sweep
+ * @param   address         decoded memory address
+ * @param   write           0 = read, 1 = write
+ *
+ * @return  void
+ */
+
+void sweepAccess(Sweep sweep, uint64_t address, int write);
+
+/* finishSweep
+ *
+ * Publishes the last partial batch, waits for every worker to drain
+ * the ring, and joins the threads. The caches may be read afterwards.
+ *
+ * @param   sweep           target sweep
+ *
+ * @return  void
+ */
+
+void finishSweep(Sweep sweep);
+
+/* destroySweep
+ *
+ * Frees the sweep (finishing it first if needed). Does not destroy the
+ * caches. Passing NULL does nothing.
+ *
+ * @param   sweep           sweep to destroy
+ *
+ * @return  void
+ */
+
+void destroySweep(Sweep sweep);
+
+#endif
+/* SWEEP_H */
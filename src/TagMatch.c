@@ -0,0 +1,176 @@
+/* File: TagMatch.c
+ *
+ * Way-parallel tag comparison for one cache set.
+ * See TagMatch.h for the interface.
+ *
+ */
+
+/********************************
+ *     1. Includes              *
+ *******************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "TagMatch.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define TAGMATCH_X86 1
+#include <immintrin.h>
+#endif
+
+/********************************
+ *     2. Scalar Kernels        *
+ ********************************/
+
+static unsigned int matchTagsScalar(const unsigned int *tags, int ways, unsigned int tag) {
+    return matchTagsInline(tags, ways, tag);
+}
+
+static unsigned int matchTagsWideScalar(const uint64_t *tags, int ways, uint64_t tag) {
+    return matchTagsWideInline(tags, ways, tag);
+}
+
+#ifdef TAGMATCH_X86
+
+/********************************
+ *     3. SSE2 Kernels          *
+ ********************************/
+
+static unsigned int matchTagsSSE2(const unsigned int *tags, int ways, unsigned int tag) {
+
+    __m128i probe = _mm_set1_epi32((int) tag);
+    __m128i eq;
+    unsigned int mask = 0;
+    int j;
+
+    for(j = 0; j + 4 <= ways; j += 4) {
+        eq = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *) (tags + j)), probe);
+        mask |= (unsigned int) _mm_movemask_ps(_mm_castsi128_ps(eq)) << j;
+    }
+
+    for(; j < ways; j++) {
+        mask |= (unsigned int) (tags[j] == tag) << j;
+    }
+
+    return mask;
+}
+
+/* SSE2 has no 64-bit compare: a way matches when both of its 32-bit
+ * halves do, so the two half masks of each pair are ANDed */
+
+static unsigned int matchTagsWideSSE2(const uint64_t *tags, int ways, uint64_t tag) {
+
+    __m128i probe = _mm_set1_epi64x((long long) tag);
+    __m128i eq;
+    unsigned int mask = 0, halves;
+    int j;
+
+    for(j = 0; j + 2 <= ways; j += 2) {
+        eq = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *) (tags + j)), probe);
+        halves = (unsigned int) _mm_movemask_ps(_mm_castsi128_ps(eq));
+        halves &= halves >> 1;
+        mask |= ((halves & 1) | ((halves >> 1) & 2)) << j;
+    }
+
+    for(; j < ways; j++) {
+        mask |= (unsigned int) (tags[j] == tag) << j;
+    }
+
+    return mask;
+}
+
+/********************************
+ *     4. AVX2 Kernels          *
+ ********************************/
+
+__attribute__((target("avx2")))
+static unsigned int matchTagsAVX2(const unsigned int *tags, int ways, unsigned int tag) {
+
+    __m256i probe = _mm256_set1_epi32((int) tag);
+    __m256i eq;
+    __m128i eq4;
+    unsigned int mask = 0;
+    int j;
+
+    for(j = 0; j + 8 <= ways; j += 8) {
+        eq = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *) (tags + j)), probe);
+        mask |= (unsigned int) _mm256_movemask_ps(_mm256_castsi256_ps(eq)) << j;
+    }
+
+    if(j + 4 <= ways) {
+        eq4 = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *) (tags + j)), _mm256_castsi256_si128(probe));
+        mask |= (unsigned int) _mm_movemask_ps(_mm_castsi128_ps(eq4)) << j;
+        j += 4;
+    }
+
+    for(; j < ways; j++) {
+        mask |= (unsigned int) (tags[j] == tag) << j;
+    }
+
+    return mask;
+}
+
+__attribute__((target("avx2")))
+static unsigned int matchTagsWideAVX2(const uint64_t *tags, int ways, uint64_t tag) {
+
+    __m256i probe = _mm256_set1_epi64x((long long) tag);
+    __m256i eq;
+    unsigned int mask = 0;
+    int j;
+
+    for(j = 0; j + 4 <= ways; j += 4) {
+        eq = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *) (tags + j)), probe);
+        mask |= (unsigned int) _mm256_movemask_pd(_mm256_castsi256_pd(eq)) << j;
+    }
+
+    for(; j < ways; j++) {
+        mask |= (unsigned int) (tags[j] == tag) << j;
+    }
+
+    return mask;
+}
+
+#endif
+/* TAGMATCH_X86 */
+
+/********************************
+ *     5. Dispatch              *
+ ********************************/
+
+unsigned int (*matchTags)(const unsigned int *tags, int ways, unsigned int tag) = matchTagsScalar;
+unsigned int (*matchTagsWide)(const uint64_t *tags, int ways, uint64_t tag) = matchTagsWideScalar;
+
+static const char *selected = "scalar";
+
+void initTagMatch(void) {
+
+    const char *force = getenv("CACHESIM_SIMD");
+
+    matchTags = matchTagsScalar;
+    matchTagsWide = matchTagsWideScalar;
+    selected = "scalar";
+
+    if(force != NULL && strcmp(force, "scalar") == 0) {
+        return;
+    }
+
+#ifdef TAGMATCH_X86
+    __builtin_cpu_init();
+
+    if(__builtin_cpu_supports("sse2")) {
+        matchTags = matchTagsSSE2;
+        matchTagsWide = matchTagsWideSSE2;
+        selected = "sse2";
+    }
+
+    if(__builtin_cpu_supports("avx2") && (force == NULL || strcmp(force, "sse2") != 0)) {
+        matchTags = matchTagsAVX2;
+        matchTagsWide = matchTagsWideAVX2;
+        selected = "avx2";
+    }
+#endif
+}
+
+const char *tagMatchName(void) {
+    return selected;
+}
@@ -0,0 +1,108 @@
+/* File: TagMatch.h
+ *
+ * Way-parallel tag comparison for one cache set.
+ *
+ * The kernels compare a probe tag against every way of a set at once and
+ * return a bitmask of matching ways. SSE2 and AVX2 versions are chosen
+ * at runtime by initTagMatch based on the host CPU, with a scalar
+ * fallback. Every version returns exactly the same result as the scalar
+ * loop. Victim selection belongs to the replacement policy (Policy.h).
+ *
+ * Tags are 32 bits wide unless the address leaves a cache more tag bits
+ * than that; those caches store 64-bit tags and use matchTagsWide.
+ *
+ * The CACHESIM_SIMD environment variable (scalar, sse2, avx2) can force a
+ * particular version, which is useful to check that results match.
+ *
+ */
+
+#ifndef TAGMATCH_H
+#define TAGMATCH_H
+
+#include <stdint.h>
+
+/* initTagMatch
+ *
+ * Selects the fastest kernels the host CPU supports. Must be called
+ * once before matchTags. Safe to call more than once.
+ *
+ * @return      void
+ */
+
+void initTagMatch(void);
+
+/* tagMatchName
+ *
+ * Returns the name of the selected kernel set ("scalar", "sse2", "avx2").
+ *
+ * @return      name of the selected kernels
+ */
+
+const char *tagMatchName(void);
+
+/* matchTags
+ *
+ * Compares 'tag' against tags[0 .. ways-1]. Bit j of the result is set
+ * when tags[j] == tag. The caller masks the result with the set's valid
+ * bits. 'ways' must be between 1 and 32.
+ *
+ * @param       tags        tags of every way in the set
+ * @param       ways        # of ways
+ * @param       tag         probe tag
+ *
+ * @return      bitmask of matching ways
+ */
+
+extern unsigned int (*matchTags)(const unsigned int *tags, int ways, unsigned int tag);
+
+/* matchTagsInline
+ *
+ * Scalar version of matchTags for callers where 'ways' is a
+ * compile-time constant. The compiler fully unrolls it, which beats an
+ * indirect call for narrow sets.
+ */
+
+static inline unsigned int matchTagsInline(const unsigned int *tags, int ways, unsigned int tag) {
+
+    unsigned int mask = 0;
+    int j;
+
+    for(j = 0; j < ways; j++) {
+        mask |= (unsigned int) (tags[j] == tag) << j;
+    }
+
+    return mask;
+}
+
+/* matchTagsWide
+ *
+ * matchTags for 64-bit tags.
+ *
+ * @param       tags        tags of every way in the set
+ * @param       ways        # of ways
+ * @param       tag         probe tag
+ *
+ * @return      bitmask of matching ways
+ */
+
+extern unsigned int (*matchTagsWide)(const uint64_t *tags, int ways, uint64_t tag);
+
+/* matchTagsWideInline
+ *
+ * Scalar version of matchTagsWide for a compile-time constant 'ways'.
+ */
+
+static inline unsigned int matchTagsWideInline(const uint64_t *tags, int ways, uint64_t tag) {
+
+    unsigned int mask = 0;
+    int j;
+
+    for(j = 0; j < ways; j++) {
+        mask |= (unsigned int) (tags[j] == tag) << j;
+    }
+
+    return mask;
+}
+
+#endif
+/* TAGMATCH_H */
@@ -0,0 +1,503 @@
+/* File: TextTrace.c
+ *
+ * Streaming reader for text traces. See TextTrace.h for the format.
+ *
+ * The buffer holds bytes [base, base + end) of the file and 'pos' is
+ * the next byte to parse. A record is only ever split by the end of the
+ * buffer on the slow path: it then moves the unparsed tail to the front
+ * and reads more. An address is at most TEXTTRACE_ADDRESS characters,
+ * so the tail always fits and the buffer never grows.
+ *
+ */
+
+/********************************
+ *     1. Includes              *
+ *******************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "TextTrace.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/********************************
+ *     2. Structs               *
+ ********************************/
+
+/* TextTrace
+ *
+ * @param   fd              file being read
+ * @param   eof             the last read returned end of file
+ * @param   buffer          bytes read but not yet discarded (TEXTTRACE_BUFFER)
+ * @param   pos             next byte to parse
+ * @param   end             # of valid bytes in 'buffer'
+ * @param   base            file offset of buffer[0]
+ * @param   count           # of records decoded so far
+ * @param   token_start     buffer index of the last address text
+ * @param   token_length    length of the last address text
+ * @param   token           copy of the last address text for [-t]
+ */
+
+struct TextTrace_ {
+    int fd;
+    int eof;
+    char* buffer;
+    size_t pos;
+    size_t end;
+    unsigned long long base;
+    long count;
+    size_t token_start;
+    size_t token_length;
+    char token[TEXTTRACE_TOKEN];
+};
+
+/********************************
+ *     3. Utility Functions     *
+ ********************************/
+
+/* isSpace
+ *
+ * Same set as isspace in the C locale, without the table lookup.
+ */
+
+static inline int isSpace(int c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+/* hexValue
+ *
+ * Returns the value of a hex digit, or -1 if 'c' is not one.
+ */
+
+static inline int hexValue(int c) {
+
+    if(c >= '0' && c <= '9') {
+        return c - '0';
+    }
+
+    c |= 0x20;
+
+    if(c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+
+    return -1;
+}
+
+#if defined(__SSE2__)
+
+/* hexDigits16
+ *
+ * Returns how many of the 16 bytes at 's' are hex digits before the
+ * first one that is not (16 if all of them are).
+ */
+
+static inline int hexDigits16(const char *s) {
+
+    __m128i c = _mm_loadu_si128((const __m128i *) s);
+    __m128i lower = _mm_or_si128(c, _mm_set1_epi8(0x20));
+    __m128i digit, alpha;
+
+    digit = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('9' + 1)));
+    alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+
+    return __builtin_ctz(~(unsigned int) _mm_movemask_epi8(_mm_or_si128(digit, alpha)));
+}
+
+/* decodeHex8
+ *
+ * Folds n (1 - 8) hex digits at 's' into an integer. The 8 bytes are
+ * loaded at once and shifted so the digits are right-aligned, every
+ * byte becomes its nibble value, and adjacent nibbles are merged in
+ * three steps (2, 4, then 8 digits per lane).
+ */
+
+static inline unsigned int decodeHex8(const char *s, int n) {
+
+    uint64_t v, x;
+
+    memcpy(&v, s, sizeof(v));
+    v <<= 8 * (8 - n);
+
+    /* '0'-'9' keep their low nibble; letters have bit 6 set and need + 9 */
+
+    x = (v & 0x0F0F0F0F0F0F0F0FULL) + ((v >> 6) & 0x0101010101010101ULL) * 9;
+
+    x = ((x & 0x000F000F000F000FULL) << 4) | ((x >> 8) & 0x000F000F000F000FULL);
+    x = ((x & 0x000000FF000000FFULL) << 8) | ((x >> 16) & 0x000000FF000000FFULL);
+
+    return (unsigned int) (((x & 0xFFFF) << 16) | ((x >> 32) & 0xFFFF));
+}
+
+#endif
+
+/* reportError
+ *
+ * Prints a malformed record message with its access # and offset.
+ */
+
+static void reportError(TextTrace trace, unsigned long long offset, const char *reason) {
+    fprintf(stderr, "Error on memory access %ld at byte offset %llu: %s. Check trace file input.\n", trace->count + 1, offset, reason);
+}
+
+/* refill
+ *
+ * Discards buffer[0 .. keep), moves the rest to the front, and reads
+ * more of the file after it. Returns the # of bytes read, 0 at the end
+ * of the file, and -1 on a read error.
+ */
+
+static long refill(TextTrace trace, size_t keep) {
+
+    ssize_t n;
+
+    if(trace->eof) {
+        return 0;
+    }
+
+    if(keep > 0) {
+        memmove(trace->buffer, trace->buffer + keep, trace->end - keep);
+        trace->end -= keep;
+        trace->pos -= keep;
+        trace->base += keep;
+    }
+
+    do {
+        n = read(trace->fd, trace->buffer + trace->end, TEXTTRACE_BUFFER - trace->end);
+    } while(n < 0 && errno == EINTR);
+
+    if(n < 0) {
+        fprintf(stderr, "Error: could not read trace file at byte offset %llu.\n", trace->base + trace->end);
+        return -1;
+    }
+
+    if(n == 0) {
+        trace->eof = 1;
+    }
+
+    trace->end += (size_t) n;
+
+    return (long) n;
+}
+
+/* readAddress
+ *
+ * Decodes the address that starts at 'pos' and moves past it.
+ * Returns 1 on success and -1 on a malformed address.
+ */
+
+static inline int readAddress(TextTrace trace, uint64_t *address) {
+
+    const char *b, *digits;
+    uint64_t value;
+    size_t length, k;
+    long r;
+    int v;
+
+#if defined(__SSE2__)
+
+    /* Fast path: the common "0x" + up to 16 digits, with enough bytes
+     * buffered that the 16-byte load stays inside the data */
+
+    if(trace->end - trace->pos >= 32) {
+
+        b = trace->buffer + trace->pos;
+        digits = b + ((b[0] == '0' && (b[1] | 0x20) == 'x') ? 2 : 0);
+        v = hexDigits16(digits);
+
+        if(v >= 1 && v <= 16 && isSpace((unsigned char) digits[v])) {
+
+            if(v <= 8) {
+                *address = decodeHex8(digits, v);
+            }
+            else {
+                *address = (uint64_t) decodeHex8(digits, v - 8) << 32 | decodeHex8(digits + v - 8, 8);
+            }
+
+            trace->token_start = trace->pos;
+            trace->token_length = (size_t) (digits + v - b);
+            trace->pos += trace->token_length;
+
+            return 1;
+        }
+    }
+
+#endif
+
+    /* Slow path: get the whole address into the buffer first */
+
+    length = 0;
+
+    while(1) {
+
+        if(trace->pos + length == trace->end) {
+
+            if(trace->eof) {
+                break;
+            }
+
+            if((r = refill(trace, trace->pos)) < 0) {
+                return -1;
+            }
+
+            continue;
+        }
+
+        if(isSpace((unsigned char) trace->buffer[trace->pos + length])) {
+            break;
+        }
+
+        if(++length > TEXTTRACE_ADDRESS) {
+            reportError(trace, trace->base + trace->pos, "address is too long");
+            return -1;
+        }
+    }
+
+    b = trace->buffer + trace->pos;
+    k = (length >= 2 && b[0] == '0' && (b[1] | 0x20) == 'x') ? 2 : 0;
+
+    if(k == length) {
+        reportError(trace, trace->base + trace->pos, "address has no hex digits");
+        return -1;
+    }
+
+    /* like htoi, only the low 64 bits of a long address are kept */
+
+    value = 0;
+
+    for(; k < length; k++) {
+
+        if((v = hexValue((unsigned char) b[k])) < 0) {
+            reportError(trace, trace->base + trace->pos + k, "invalid hex digit in address");
+            return -1;
+        }
+
+        value = (value << 4) | (uint64_t) v;
+    }
+
+    *address = value;
+    trace->token_start = trace->pos;
+    trace->token_length = length;
+    trace->pos += length;
+
+    return 1;
+}
+
+/* nextRecord
+ *
+ * Skips whitespace and comments and decodes one record. Returns 1 on
+ * success, 0 at the end of the file, and -1 on error.
+ */
+
+static inline int nextRecord(TextTrace trace, uint64_t *address, unsigned char *write) {
+
+    const char *newline;
+    long r;
+    int c;
+
+    /* find the start of the next record */
+
+    while(1) {
+
+        if(trace->pos == trace->end) {
+
+            if((r = refill(trace, trace->pos)) <= 0) {
+                return (int) r;
+            }
+
+            continue;
+        }
+
+        c = (unsigned char) trace->buffer[trace->pos];
+
+        if(isSpace(c)) {
+            trace->pos++;
+        }
+
+        /* comment such as "#eof": skip to the end of the line */
+
+        else if(c == '#') {
+
+            newline = memchr(trace->buffer + trace->pos, '\n', trace->end - trace->pos);
+
+            if(newline != NULL) {
+                trace->pos = (size_t) (newline - trace->buffer);
+            }
+            else {
+                trace->pos = trace->end;
+            }
+
+            /* the line may go on past the buffered bytes */
+
+            while(newline == NULL) {
+
+                if((r = refill(trace, trace->pos)) <= 0) {
+                    return (int) r;
+                }
+
+                newline = memchr(trace->buffer + trace->pos, '\n', trace->end - trace->pos);
+                trace->pos = (newline != NULL) ? (size_t) (newline - trace->buffer) : trace->end;
+            }
+        }
+
+        else {
+            break;
+        }
+    }
+
+    if(c != 'r' && c != 'w') {
+        reportError(trace, trace->base + trace->pos, "expected 'r' or 'w'");
+        return -1;
+    }
+
+    *write = (unsigned char) (c == 'w');
+    trace->pos++;
+
+    /* whitespace between the mode and the address */
+
+    while(1) {
+
+        if(trace->pos == trace->end) {
+
+            if((r = refill(trace, trace->pos)) < 0) {
+                return -1;
+            }
+
+            if(r == 0) {
+                reportError(trace, trace->base + trace->pos, "missing address");
+                return -1;
+            }
+
+            continue;
+        }
+
+        if(!isSpace((unsigned char) trace->buffer[trace->pos])) {
+            break;
+        }
+
+        trace->pos++;
+    }
+
+    return readAddress(trace, address);
+}
+
+/********************************
+ *     4. Reader                *
+ ********************************/
+
+TextTrace openTextTrace(const char *path) {
+
+    TextTrace trace;
+    int fd;
+
+    /* a duplicate of standard input closes like any other file */
+
+    fd = (strcmp(path, "-") == 0) ? dup(STDIN_FILENO) : open(path, O_RDONLY);
+
+    if(fd < 0) {
+        fprintf(stderr, "ERROR: Could not open file. Check <file location> argument.\n");
+        return NULL;
+    }
+
+    trace = (TextTrace) malloc(sizeof(struct TextTrace_));
+
+    if(trace != NULL) {
+        trace->buffer = (char*) malloc(TEXTTRACE_BUFFER);
+    }
+
+    if(trace == NULL || trace->buffer == NULL) {
+        fprintf(stderr, "Error: could not allocate memory for trace buffer.\n");
+        free(trace);
+        close(fd);
+        return NULL;
+    }
+
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    trace->fd = fd;
+    trace->eof = 0;
+    trace->pos = 0;
+    trace->end = 0;
+    trace->base = 0;
+    trace->count = 0;
+    trace->token_start = 0;
+    trace->token_length = 0;
+    trace->token[0] = '\0';
+
+    return trace;
+}
+
+int readTextTrace(TextTrace trace, uint64_t *addresses, unsigned char *writes, int max) {
+
+    size_t length;
+    int count = 0;
+    int r;
+
+    while(count < max) {
+
+        r = nextRecord(trace, &addresses[count], &writes[count]);
+
+        if(r < 0) {
+            return -1;
+        }
+
+        if(r == 0) {
+            break;
+        }
+
+        count++;
+        trace->count++;
+    }
+
+    /* keep the text of the last address for [-t]; of a very long one
+     * keep the end, which holds the digits that survive decoding */
+
+    if(count > 0) {
+        length = trace->token_length < TEXTTRACE_TOKEN - 1 ? trace->token_length : TEXTTRACE_TOKEN - 1;
+        memcpy(trace->token, trace->buffer + trace->token_start + trace->token_length - length, length);
+        trace->token[length] = '\0';
+    }
+
+    return count;
+}
+
+const char *textTraceToken(TextTrace trace) {
+    return trace->token;
+}
+
+unsigned long long textTraceOffset(TextTrace trace) {
+    return trace->base + trace->pos;
+}
+
+int seekTextTrace(TextTrace trace, unsigned long long offset, long count) {
+
+    if(lseek(trace->fd, (off_t) offset, SEEK_SET) == (off_t) -1) {
+        return -1;
+    }
+
+    trace->eof = 0;
+    trace->pos = 0;
+    trace->end = 0;
+    trace->base = offset;
+    trace->count = count;
+
+    return 0;
+}
+
+void closeTextTrace(TextTrace trace) {
+
+    if(trace != NULL) {
+        close(trace->fd);
+        free(trace->buffer);
+        free(trace);
+    }
+}
@@ -0,0 +1,121 @@
+/* File: TextTrace.h
+ *
+ * Streaming reader for text traces.
+ *
+ * A text trace is a sequence of records "r ADDRESS" or "w ADDRESS",
+ * where ADDRESS is hexadecimal with an optional 0x prefix. Records and
+ * their two fields may be separated by any whitespace, and lines may be
+ * of any length. A '#' where a record would start (as in "#eof") skips
+ * the rest of that line. An address of more than TEXTTRACE_ADDRESS
+ * characters is a malformed record, which keeps the buffer at its
+ * fixed size whatever the input.
+ *
+ * The file is read through a large buffer and decoded in batches. An
+ * address of up to 16 digits is decoded without a per-character loop:
+ * SSE2 finds where the digits end and a SWAR sequence folds each group
+ * of 8 into an integer. Longer addresses fall back to a scalar loop
+ * which, like htoi, keeps the low 64 bits. Malformed records are reported with
+ * their byte offset in the file.
+ *
+ */
+
+#ifndef TEXTTRACE_H
+#define TEXTTRACE_H
+
+#include <stdint.h>
+
+/* Bytes read from the file at a time */
+#define TEXTTRACE_BUFFER (1 << 20)
+
+/* Longest address accepted, in characters (0x included) */
+#define TEXTTRACE_ADDRESS 1024
+
+/* Longest address text kept for [-t] output */
+#define TEXTTRACE_TOKEN 100
+
+/* Typedefs */
+typedef struct TextTrace_* TextTrace;
+
+/* openTextTrace
+ *
+ * Opens a text trace for reading. Returns NULL on failure. The file
+ * may be a pipe; "-" reads standard input.
+ *
+ * @param   path            trace file location, or "-"
+ *
+ * @return  success         new TextTrace
+ * @return  failure         NULL
+ */
+
+TextTrace openTextTrace(const char *path);
+
+/* readTextTrace
+ *
+ * Decodes up to 'max' records into the caller's arrays. A malformed
+ * record is reported on stderr with its access # and byte offset.
+ *
+ * @param   trace           trace opened with openTextTrace
+ * @param   addresses       output: decoded addresses
+ * @param   writes          output: 0 = read, 1 = write
+ * @param   max             capacity of both arrays
+ *
+ * @return  success         # of records decoded (0 at the end)
+ * @return  failure         -1
+ */
+
+int readTextTrace(TextTrace trace, uint64_t *addresses, unsigned char *writes, int max);
+
+/* textTraceToken
+ *
+ * Returns the address of the last record decoded, as it appears in
+ * the file. Of a longer address only the last TEXTTRACE_TOKEN - 1
+ * characters are kept, which still decode to the same value.
+ *
+ * @param   trace           trace opened with openTextTrace
+ *
+ * @return  address text
+ */
+
+const char *textTraceToken(TextTrace trace);
+
+/* textTraceOffset
+ *
+ * Returns the byte offset in the file just past the last record
+ * decoded, where decoding would pick up again.
+ *
+ * @param   trace           trace opened with openTextTrace
+ *
+ * @return  byte offset
+ */
+
+unsigned long long textTraceOffset(TextTrace trace);
+
+/* seekTextTrace
+ *
+ * Moves to byte 'offset' of the file, which must be a record boundary
+ * such as one returned by textTraceOffset, and counts the records
+ * before it as 'count' for error messages. Fails on a pipe.
+ *
+ * @param   trace           trace opened with openTextTrace
+ * @param   offset          byte offset to continue from
+ * @param   count           # of records before 'offset'
+ *
+ * @return  success         0
+ * @return  failure         -1
+ */
+
+int seekTextTrace(TextTrace trace, unsigned long long offset, long count);
+
+/* closeTextTrace
+ *
+ * Closes the file and frees the trace. Passing NULL does nothing.
+ *
+ * @param   trace           trace to close
+ *
+ * @return  void
+ */
+
+void closeTextTrace(TextTrace trace);
+
+#endif
+/* TEXTTRACE_H */
@@ -0,0 +1,275 @@
+/* File: TraceReader.c
+ *
+ * Trace input decoded ahead on its own thread. See TraceReader.h.
+ *
+ * The reader thread is the producer on the ring (Ring.h) and the
+ * caller is the one consumer. The caller holds on to the batch it was
+ * handed until its next call, then releases it so the thread may refill
+ * the slot. Without a thread, batch 0 is refilled on every call.
+ *
+ */
+
+/********************************
+ *     1. Includes              *
+ *******************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "TraceReader.h"
+#include "Ring.h"
+#include "BinTrace.h"
+#include "TextTrace.h"
+
+/********************************
+ *     2. Structs               *
+ ********************************/
+
+/* Batch
+ *
+ * A run of decoded accesses handed to the caller in one go, and the
+ * text byte offset just past it.
+ */
+
+struct Batch_ {
+    int count;
+    unsigned long long offset;
+    uint64_t addresses[TRACEREADER_BATCH];
+    unsigned char writes[TRACEREADER_BATCH];
+};
+
+/* TraceReader
+ *
+ * @param   batches         batches in flight, one per ring slot
+ * @param   ring            hands the batches to the caller (threaded only)
+ * @param   failed          the thread hit a malformed or unreadable trace
+ * @param   thread          reader thread
+ * @param   threaded        decode on 'thread'
+ * @param   started         'thread' is running
+ * @param   holding         caller side: the batch handed out last is still in use
+ * @param   offset          caller side: byte offset after the last batch
+ * @param   text            text trace, or NULL
+ * @param   trace           binary trace, or NULL
+ */
+
+struct TraceReader_ {
+    struct Batch_ batches[TRACEREADER_RING];
+    Ring ring;
+    atomic_bool failed;
+    pthread_t thread;
+    int threaded;
+    int started;
+    int holding;
+    unsigned long long offset;
+    TextTrace text;
+    BinaryTrace trace;
+};
+
+/********************************
+ *     3. Reader Thread         *
+ ********************************/
+
+/* decodeBatch
+ *
+ * Decodes up to 'max' accesses into 'batch'.
+ */
+
+static int decodeBatch(TraceReader reader, struct Batch_ *batch, int max) {
+
+    int n;
+
+    if(reader->trace != NULL) {
+        batch->offset = 0;
+        return readBinaryTrace(reader->trace, batch->addresses, batch->writes, max);
+    }
+
+    n = readTextTrace(reader->text, batch->addresses, batch->writes, max);
+    batch->offset = textTraceOffset(reader->text);
+
+    return n;
+}
+
+/* runReader
+ *
+ * Decodes the trace into the ring until it ends.
+ */
+
+static void *runReader(void *arg) {
+
+    TraceReader reader = (TraceReader) arg;
+    struct Batch_ *batch;
+    int slot, n;
+
+    /* a slot comes back once the caller is done with its batch, or
+     * never if the reader is closing */
+
+    while((slot = ringClaim(reader->ring)) >= 0) {
+
+        batch = &reader->batches[slot];
+        n = decodeBatch(reader, batch, TRACEREADER_BATCH);
+
+        if(n < 0) {
+            atomic_store_explicit(&reader->failed, true, memory_order_relaxed);
+        }
+
+        if(n <= 0) {
+            break;
+        }
+
+        batch->count = n;
+        ringPublish(reader->ring);
+    }
+
+    ringFinish(reader->ring);
+
+    return NULL;
+}
+
+/********************************
+ *     4. Interface             *
+ ********************************/
+
+TraceReader openTraceReader(const char *path, int threaded) {
+
+    TraceReader reader;
+
+    reader = (TraceReader) calloc(1, sizeof(struct TraceReader_));
+    assert(reader != NULL);
+
+    /* only a regular file can be mapped; streams are always text */
+
+    if(strcmp(path, TRACEREADER_STDIN) != 0 && isBinaryTrace(path)) {
+        reader->trace = openBinaryTrace(path);
+    }
+    else {
+        reader->text = openTextTrace(path);
+    }
+
+    if(reader->text == NULL && reader->trace == NULL) {
+        free(reader);
+        return NULL;
+    }
+
+    atomic_init(&reader->failed, false);
+    reader->threaded = threaded;
+
+    /* without a thread the caller decodes into batch 0 itself */
+
+    if(threaded && (reader->ring = createRing(TRACEREADER_RING, 1)) == NULL) {
+        closeTraceReader(reader);
+        return NULL;
+    }
+
+    return reader;
+}
+
+int traceReaderNext(TraceReader reader, uint64_t **addresses, unsigned char **writes) {
+
+    struct Batch_ *batch;
+    int slot, n;
+
+    /* no thread: one text record at a time, a binary batch at a time */
+
+    if(!reader->threaded) {
+
+        batch = &reader->batches[0];
+        n = decodeBatch(reader, batch, (reader->text != NULL) ? 1 : TRACEREADER_BATCH);
+        reader->offset = batch->offset;
+
+        *addresses = batch->addresses;
+        *writes = batch->writes;
+
+        return n;
+    }
+
+    if(!reader->started) {
+
+        if(pthread_create(&reader->thread, NULL, runReader, reader) != 0) {
+            fprintf(stderr, "Error: could not start the trace reader thread.\n");
+            return -1;
+        }
+
+        reader->started = 1;
+    }
+
+    /* hand the previous batch's slot back to the thread */
+
+    if(reader->holding) {
+        ringRelease(reader->ring, 0);
+        reader->holding = 0;
+    }
+
+    if((slot = ringConsume(reader->ring, 0)) < 0) {
+        return atomic_load_explicit(&reader->failed, memory_order_relaxed) ? -1 : 0;
+    }
+
+    batch = &reader->batches[slot];
+    reader->holding = 1;
+    reader->offset = batch->offset;
+
+    *addresses = batch->addresses;
+    *writes = batch->writes;
+
+    return batch->count;
+}
+
+unsigned long long traceReaderOffset(TraceReader reader) {
+    return reader->offset;
+}
+
+int traceReaderResume(TraceReader reader, unsigned long long offset, long long accesses) {
+
+    long long left = accesses;
+    int n;
+
+    if(reader->text != NULL && seekTextTrace(reader->text, offset, (long) accesses) == 0) {
+        reader->offset = offset;
+        return 0;
+    }
+
+    /* a stream or a binary trace: decode up to the same access */
+
+    while(left > 0) {
+
+        n = decodeBatch(reader, &reader->batches[0], (left < TRACEREADER_BATCH) ? (int) left : TRACEREADER_BATCH);
+
+        if(n < 0) {
+            return -1;
+        }
+
+        if(n == 0) {
+            fprintf(stderr, "Error: the trace ends after %lld of the %lld accesses to skip.\n", accesses - left, accesses);
+            return -1;
+        }
+
+        left -= n;
+    }
+
+    reader->offset = reader->batches[0].offset;
+
+    return 0;
+}
+
+const char *traceReaderToken(TraceReader reader) {
+    return (reader->text != NULL && !reader->threaded) ? textTraceToken(reader->text) : NULL;
+}
+
+void closeTraceReader(TraceReader reader) {
+
+    if(reader != NULL) {
+
+        if(reader->started) {
+            ringCancel(reader->ring);
+            pthread_join(reader->thread, NULL);
+        }
+
+        destroyRing(reader->ring);
+        closeTextTrace(reader->text);
+        closeBinaryTrace(reader->trace);
+        free(reader);
+    }
+}
@@ -0,0 +1,127 @@
+/* File: TraceReader.h
+ *
+ * Trace input for the simulation loop, decoded ahead on its own thread.
+ *
+ * A TraceReader opens a text or binary trace (see TextTrace.h and
+ * BinTrace.h), or standard input when the path is "-". Named pipes and
+ * other streams are read like standard input. Binary traces are mapped
+ * into memory, so they must be regular files; anything else is read as
+ * text.
+ *
+ * With a reader thread, decoding runs while the caller simulates: the
+ * thread fills a ring of TRACEREADER_RING batches (Ring.h) and the
+ * caller drains them in order. Memory use is bounded by the ring and the
+ * text reader's fixed buffer (TextTrace.h caps the length of an
+ * address), not by the length of the trace, so a tracer can pipe
+ * straight in.
+ *
+ * Without a thread the caller decodes each batch itself, one text
+ * record at a time, so textTraceToken-style output ([-t]) stays in
+ * step with the accesses.
+ *
+ * A reader can also start partway into a trace, to resume a run from
+ * a checkpoint (Checkpoint.h): a text file seeks straight to the byte
+ * offset, anything else decodes and drops the accesses before it.
+ *
+ */
+
+#ifndef TRACEREADER_H
+#define TRACEREADER_H
+
+#include <stdint.h>
+
+/* Accesses per batch and batches in flight */
+#define TRACEREADER_BATCH 4096
+#define TRACEREADER_RING 8
+
+/* Path that selects standard input */
+#define TRACEREADER_STDIN "-"
+
+/* Typedefs */
+typedef struct TraceReader_* TraceReader;
+
+/* openTraceReader
+ *
+ * Opens a trace. The reader thread, if any, starts with the first
+ * call to traceReaderNext. Returns NULL on failure.
+ *
+ * @param   path            trace file location, or "-" for standard input
+ * @param   threaded        decode on a reader thread
+ *
+ * @return  success         new TraceReader
+ * @return  failure         NULL
+ */
+
+TraceReader openTraceReader(const char *path, int threaded);
+
+/* traceReaderNext
+ *
+ * Hands out the next batch of decoded accesses. The arrays stay valid
+ * until the next call. A malformed record has already been reported on
+ * stderr when -1 is returned.
+ *
+ * @param   reader          trace to read
+ * @param   addresses       output: decoded addresses of the batch
+ * @param   writes          output: 0 = read, 1 = write, per access
+ *
+ * @return  success         # of accesses in the batch (0 at the end)
+ * @return  failure         -1
+ */
+
+int traceReaderNext(TraceReader reader, uint64_t **addresses, unsigned char **writes);
+
+/* traceReaderOffset
+ *
+ * Returns the byte offset in a text trace just past the last batch
+ * handed out, or 0 for a binary trace.
+ *
+ * @param   reader          trace being read
+ *
+ * @return  byte offset
+ */
+
+unsigned long long traceReaderOffset(TraceReader reader);
+
+/* traceReaderResume
+ *
+ * Skips the first 'accesses' accesses of the trace. A text file seeks
+ * to 'offset', which traceReaderOffset returned after those accesses;
+ * binary traces and streams decode their way there. Must be called
+ * before the first traceReaderNext.
+ *
+ * @param   reader          trace to read
+ * @param   offset          text byte offset after the skipped accesses
+ * @param   accesses        # of accesses to skip
+ *
+ * @return  success         0
+ * @return  failure         -1
+ */
+
+int traceReaderResume(TraceReader reader, unsigned long long offset, long long accesses);
+
+/* traceReaderToken
+ *
+ * Returns the text of the last address handed out, as it appeared in a
+ * text trace read without a thread, or NULL.
+ *
+ * @param   reader          trace being read
+ *
+ * @return  address text, or NULL
+ */
+
+const char *traceReaderToken(TraceReader reader);
+
+/* closeTraceReader
+ *
+ * Stops the reader thread, closes the trace, and frees the reader.
+ * Passing NULL does nothing.
+ *
+ * @param   reader          reader to close
+ *
+ * @return  void
+ */
+
+void closeTraceReader(TraceReader reader);
+
+#endif
+/* TRACEREADER_H */
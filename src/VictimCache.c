@@ -0,0 +1,215 @@
+/* File: VictimCache.c
+ *
+ * Victim and miss caches. See VictimCache.h for how they work.
+ *
+ * The entries are searched linearly; there are at most
+ * MAX_VICTIM_ENTRIES of them. Recency is an access stamp per entry.
+ *
+ */
+
+/********************************
+ *     1. Includes              *
+ *******************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "VictimCache.h"
+
+/********************************
+ *     2. Structs               *
+ ********************************/
+
+/* VictimCache
+ *
+ * @param   kind            VICTIM_CACHE or MISS_CACHE
+ * @param   entries         # of blocks it can hold
+ * @param   count           # of blocks it holds (in slots 0 .. count - 1)
+ * @param   blocks          block number of each slot
+ * @param   dirty           dirty flag of each slot
+ * @param   used            stamp of each slot's last use
+ * @param   clock           last stamp handed out
+ */
+
+struct VictimCache_ {
+    int kind;
+    int entries;
+    int count;
+    uint64_t* blocks;
+    unsigned char* dirty;
+    unsigned long long* used;
+    unsigned long long clock;
+};
+
+/********************************
+ *     3. Functions             *
+ ********************************/
+
+/* findBlock
+ *
+ * Returns the slot holding 'block', or -1.
+ */
+
+static int findBlock(struct VictimCache_* victim, uint64_t block) {
+
+    int i;
+
+    for(i = 0; i < victim->count; i++) {
+        if(victim->blocks[i] == block) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/* createVictimCache
+ *
+ * Creates an empty victim or miss cache. Returns NULL (after printing
+ * an error) on failure.
+ *
+ * @param   kind            VICTIM_CACHE or MISS_CACHE
+ * @param   entries         # of blocks (1 - MAX_VICTIM_ENTRIES)
+ *
+ * @return  success         new VictimCache
+ * @return  failure         NULL
+ */
+
+VictimCache createVictimCache(int kind, int entries) {
+
+    VictimCache victim;
+
+    if(entries < 1 || entries > MAX_VICTIM_ENTRIES) {
+        fprintf(stderr, "Error: a victim or miss cache must have 1 - %d entries.\n", MAX_VICTIM_ENTRIES);
+        return NULL;
+    }
+
+    victim = (VictimCache) calloc(1, sizeof(struct VictimCache_));
+    assert(victim != NULL);
+
+    victim->kind = kind;
+    victim->entries = entries;
+
+    victim->blocks = (uint64_t*) malloc(entries * sizeof(uint64_t));
+    victim->dirty = (unsigned char*) malloc(entries);
+    victim->used = (unsigned long long*) malloc(entries * sizeof(unsigned long long));
+    assert(victim->blocks != NULL && victim->dirty != NULL && victim->used != NULL);
+
+    return victim;
+}
+
+int victimCacheKind(VictimCache victim) {
+    return victim->kind;
+}
+
+int victimCacheEntries(VictimCache victim) {
+    return victim->entries;
+}
+
+/* victimCacheTake
+ *
+ * Looks up a block for a main cache miss. A victim cache gives the
+ * block up; a miss cache keeps its copy and marks it recently used.
+ *
+ * @param   victim          target cache
+ * @param   block           block number
+ * @param   dirty           output: the block is dirty (always 0 for a miss cache)
+ *
+ * @return  hit             1
+ * @return  miss            0
+ */
+
+int victimCacheTake(VictimCache victim, uint64_t block, int *dirty) {
+
+    int i = findBlock(victim, block);
+
+    if(i < 0) {
+        return 0;
+    }
+
+    *dirty = victim->dirty[i];
+
+    if(victim->kind == MISS_CACHE) {
+        victim->used[i] = ++victim->clock;
+        return 1;
+    }
+
+    /* move the last block into the freed slot */
+
+    victim->count--;
+    victim->blocks[i] = victim->blocks[victim->count];
+    victim->dirty[i] = victim->dirty[victim->count];
+    victim->used[i] = victim->used[victim->count];
+
+    return 1;
+}
+
+/* victimCacheInsert
+ *
+ * Adds a block (or, if it is already there, refreshes it), replacing
+ * the least recently used one when full.
+ *
+ * @param   victim          target cache
+ * @param   block           block number
+ * @param   dirty           the block is dirty
+ * @param   evicted         output: block number of the replaced block
+ * @param   evicted_dirty   output: the replaced block was dirty
+ *
+ * @return  1 if a block was replaced, else 0
+ */
+
+int victimCacheInsert(VictimCache victim, uint64_t block, int dirty, uint64_t *evicted, int *evicted_dirty) {
+
+    int i, j, replaced = 0;
+
+    i = findBlock(victim, block);
+
+    if(i >= 0) {
+        victim->dirty[i] |= dirty;
+    }
+    else if(victim->count < victim->entries) {
+        i = victim->count++;
+        victim->blocks[i] = block;
+        victim->dirty[i] = dirty;
+    }
+    else {
+
+        i = 0;
+
+        for(j = 1; j < victim->count; j++) {
+            if(victim->used[j] < victim->used[i]) {
+                i = j;
+            }
+        }
+
+        *evicted = victim->blocks[i];
+        *evicted_dirty = victim->dirty[i];
+        replaced = 1;
+
+        victim->blocks[i] = block;
+        victim->dirty[i] = dirty;
+    }
+
+    victim->used[i] = ++victim->clock;
+
+    return replaced;
+}
+
+/* destroyVictimCache
+ *
+ * Frees the cache. Passing NULL does nothing.
+ *
+ * @param   victim          cache to destroy
+ *
+ * @return  void
+ */
+
+void destroyVictimCache(VictimCache victim) {
+
+    if(victim != NULL) {
+        free(victim->blocks);
+        free(victim->dirty);
+        free(victim->used);
+        free(victim);
+    }
+}
@@ -0,0 +1,113 @@
+/* File: VictimCache.h
+ *
+ * Small fully-associative caches beside the main cache (Jouppi):
+ *
+ *      victim cache    holds the blocks the main cache evicts, dirty or
+ *                      clean. A main cache miss that hits here swaps
+ *                      the block back in (with its dirty state) and
+ *                      the main cache's victim takes its place. A dirty
+ *                      block is written back only when it leaves the
+ *                      victim cache.
+ *      miss cache      holds a clean copy of every block fetched from
+ *                      memory. A main cache miss that hits here refills
+ *                      the main cache from it and the copy stays.
+ *
+ * Both are probed in parallel with the main cache, so a hit in one
+ * costs a cycle more than a main cache hit instead of a memory fetch.
+ * Both replace their least recently used entry.
+ *
+ */
+
+#ifndef VICTIMCACHE_H
+#define VICTIMCACHE_H
+
+#include <stdint.h>
+
+/* Kinds */
+enum {
+    VICTIM_CACHE,
+    MISS_CACHE
+};
+
+/* Limits */
+#define MAX_VICTIM_ENTRIES 64
+
+/* Typedefs */
+typedef struct VictimCache_* VictimCache;
+
+/* createVictimCache
+ *
+ * Creates an empty victim or miss cache. Returns NULL (after printing
+ * an error) on failure.
+ *
+ * @param   kind            VICTIM_CACHE or MISS_CACHE
+ * @param   entries         # of blocks (1 - MAX_VICTIM_ENTRIES)
+ *
+ * @return  success         new VictimCache
+ * @return  failure         NULL
+ */
+
+VictimCache createVictimCache(int kind, int entries);
+
+/* victimCacheKind
+ *
+ * @param   victim          target cache
+ *
+ * @return  VICTIM_CACHE or MISS_CACHE
+ */
+
+int victimCacheKind(VictimCache victim);
+
+/* victimCacheEntries
+ *
+ * @param   victim          target cache
+ *
+ * @return  # of blocks it holds
+ */
+
+int victimCacheEntries(VictimCache victim);
+
+/* victimCacheTake
+ *
+ * Looks up a block for a main cache miss. A victim cache gives the
+ * block up; a miss cache keeps its copy and marks it recently used.
+ *
+ * @param   victim          target cache
+ * @param   block           block number
+ * @param   dirty           output: the block is dirty (always 0 for a miss cache)
+ *
+ * @return  hit             1
+ * @return  miss            0
+ */
+
+int victimCacheTake(VictimCache victim, uint64_t block, int *dirty);
+
+/* victimCacheInsert
+ *
+ * Adds a block (or, if it is already there, refreshes it), replacing
+ * the least recently used one when full.
+ *
+ * @param   victim          target cache
+ * @param   block           block number
+ * @param   dirty           the block is dirty
+ * @param   evicted         output: block number of the replaced block
+ * @param   evicted_dirty   output: the replaced block was dirty
+ *
+ * @return  1 if a block was replaced, else 0
+ */
+
+int victimCacheInsert(VictimCache victim, uint64_t block, int dirty, uint64_t *evicted, int *evicted_dirty);
+
+/* destroyVictimCache
+ *
+ * Frees the cache. Passing NULL does nothing.
+ *
+ * @param   victim          cache to destroy
+ *
+ * @return  void
+ */
+
+void destroyVictimCache(VictimCache victim);
+
+#endif
+/* VICTIMCACHE_H */